@@ -10,6 +10,7 @@
 #include "../StateObject/DrawingState/drawingstate.hh"
 #include "../StateObject/GameState/gamestate.hh"
 #include "../StateObject/HardwareState/hardwarestate.hh"
+#include "../StateObject/ImagePassScheduleState/imagepassschedulestate.hh"
 #include "../StateObject/LabelCountState/labelcountstate.hh"
 #include "../StateObject/LabelTeacherState/labelteacherstate.hh"
 #include "../StateObject/LEDState/ledstate.hh"
@@ -41,6 +42,7 @@ void Agent::registerStateTypes()
   State::registerStateType<DrawingState>("Drawing");
   State::registerStateType<GameState>("Game");
   State::registerStateType<HardwareState>("Hardware");
+  State::registerStateType<ImagePassScheduleState>("ImagePassSchedule");
   State::registerStateType<LabelCountState>("LabelCount");
   State::registerStateType<LabelTeacherState>("LabelTeacher");
   State::registerStateType<LEDState>("LED");
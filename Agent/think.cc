@@ -36,27 +36,31 @@ void Agent::onStep(ulong cycleNumber)
   SequentialTimer t;
 
   //
-  // Capture the image (YCbCr format)
+  // Capture the image
   // This should be the very first thing done in the think loop, to
-  // ensure a BodyState snapshot is available
+  // ensure a BodyState snapshot is available.
+  // The frame may hold one of the camera's buffers, so keep it in scope only
+  // for as long as vision needs it.
   //
-  t.enter("Image Capture");
-  cv::Mat image = d_camera->capture(t);
-  t.exit();
+  {
+    t.enter("Image Capture");
+    Camera::Frame frame = d_camera->capture(t);
+    t.exit();
 
-  //
-  // Update Spatialiser internals
-  //
-  d_spatialiser->updateZeroGroundPixelTransform();
+    //
+    // Update Spatialiser internals
+    //
+    d_spatialiser->updateZeroGroundPixelTransform();
 
-  //
-  // Process the image
-  //
-  t.enter("Vision");
-  d_visualCortex->integrateImage(image, t, cycleNumber);
-  t.exit();
+    //
+    // Process the image
+    //
+    t.enter("Vision");
+    d_visualCortex->integrateImage(frame, t, cycleNumber);
+    t.exit();
 
-  d_visualCortex->streamDebugImage(image, t);
+    d_visualCortex->streamDebugImage(frame, t);
+  }
 
   //
   // Listen for any game control data
@@ -149,7 +153,10 @@ void Agent::onStep(ulong cycleNumber)
   // Set timing data for the think cycle
   //
   static FPS<30> fps;
-  State::make<ThinkTimingState>(t.flush(), cycleNumber, fps.next());
+  static ulong lastFramePoolAllocationCount = 0;
+  ulong framePoolAllocationCount = d_camera->getFramePool().getAllocationCount();
+  State::make<ThinkTimingState>(t.flush(), cycleNumber, fps.next(), framePoolAllocationCount - lastFramePoolAllocationCount);
+  lastFramePoolAllocationCount = framePoolAllocationCount;
 
   log::trace("Agent::think") << "Ending think cycle " << cycleNumber;
 }
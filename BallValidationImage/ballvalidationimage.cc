@@ -0,0 +1,54 @@
+#include "ballvalidationimage.hh"
+
+using namespace bold;
+using namespace Eigen;
+using namespace std;
+
+BallValidationImage::BallValidationImage(cv::Mat const& ballMask, cv::Mat const& surroundingsMask, Bounds2i region)
+  : d_ball(IntegralImage::create(ballMask)),
+    d_surroundings(IntegralImage::create(surroundingsMask)),
+    d_region(region)
+{
+  ASSERT(ballMask.rows == region.height() + 1 && ballMask.cols == region.width() + 1);
+  ASSERT(surroundingsMask.rows == ballMask.rows && surroundingsMask.cols == ballMask.cols);
+}
+
+bool BallValidationImage::contains(Bounds2i const& box) const
+{
+  return d_region.contains(box.min()) && d_region.contains(box.max());
+}
+
+bool BallValidationImage::isBallShaped(Bounds2i const& box, double minFillRatio, int ringWidth, double minRingSurroundRatio) const
+{
+  // Sums outside the region would read beyond the integral images
+  if (!contains(box))
+    return false;
+
+  Vector2i min = box.min();
+  Vector2i max = box.max();
+
+  // A ball fills much of its bounding box, unlike a line of noise or an orange edge
+  int boxArea = (max - min + Vector2i::Ones()).prod();
+  if (sum(d_ball, d_region, min, max) < minFillRatio * boxArea)
+    return false;
+
+  // A ball on the field is mostly surrounded by field and lines
+  Vector2i ring = Vector2i::Constant(ringWidth);
+  Vector2i outerMin = (min - ring).cwiseMax(d_region.min());
+  Vector2i outerMax = (max + ring).cwiseMin(d_region.max());
+  int ringArea = (outerMax - outerMin + Vector2i::Ones()).prod() - boxArea;
+  if (ringArea > 0)
+  {
+    int ringSurroundings = sum(d_surroundings, d_region, outerMin, outerMax) - sum(d_surroundings, d_region, min, max);
+    if (ringSurroundings < minRingSurroundRatio * ringArea)
+      return false;
+  }
+
+  return true;
+}
+
+int BallValidationImage::sum(IntegralImage const& image, Bounds2i const& region, Vector2i const& min, Vector2i const& max)
+{
+  // Box sums are in the labelled region's coordinates
+  return image.getSummedArea(min - region.min(), max - region.min());
+}
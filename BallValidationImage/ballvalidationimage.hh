@@ -0,0 +1,48 @@
+#pragma once
+
+#include <opencv2/core/core.hpp>
+
+#include "../geometry/Bounds.hh"
+#include "../IntegralImage/integralimage.hh"
+
+namespace bold
+{
+  /** Integral images of full resolution labels around a single ball candidate, for checking its shape.
+   *
+   * The region covers the candidate's bounding box and the ring around it,
+   * so that box sums stay within the labelled pixels.
+   */
+  class BallValidationImage
+  {
+  public:
+    /** Builds from masks of the region's size, holding one where a pixel is labelled ball, or field or line, respectively, and zero elsewhere.
+     *
+     * @param region the labelled image region, in image coordinates, with inclusive bounds
+     */
+    BallValidationImage(cv::Mat const& ballMask, cv::Mat const& surroundingsMask, Bounds2i region);
+
+    Bounds2i const& getRegion() const { return d_region; }
+
+    /** Whether box, in image coordinates, lies entirely within the labelled region. */
+    bool contains(Bounds2i const& box) const;
+
+    /** Whether box, in image coordinates, is filled by ball labels and surrounded by field and lines.
+     *
+     * At least minFillRatio of the box must be labelled ball. At least
+     * minRingSurroundRatio of the ring ringWidth pixels wide around it,
+     * clipped to the region, must be labelled field or line. Returns false if
+     * box is not contained by the region.
+     */
+    bool isBallShaped(Bounds2i const& box, double minFillRatio, int ringWidth, double minRingSurroundRatio) const;
+
+  private:
+    /** Sums a box, in image coordinates, within the region. */
+    static int sum(IntegralImage const& image, Bounds2i const& region, Eigen::Vector2i const& min, Eigen::Vector2i const& max);
+
+    /// Counts of ball labelled pixels
+    IntegralImage d_ball;
+    /// Counts of the field and line labelled pixels expected around a ball
+    IntegralImage d_surroundings;
+    Bounds2i d_region;
+  };
+}
@@ -3,5 +3,7 @@
 Camera::Camera(string const& device)
   : d_device(device),
     d_fd(0),
-    d_squash(false)
+    d_squash(false),
+    // One frame being processed, plus up to three held by image streaming
+    d_framePool(4)
 {}
@@ -0,0 +1,59 @@
+#include "camera.ih"
+
+Camera::Frame::Frame(FramePool::Handle buffers)
+  : d_buffers(move(buffers)),
+    d_camera(nullptr),
+    d_bufferIndex(0),
+    d_yuyv(nullptr),
+    d_width((ushort)d_buffers->image.cols),
+    d_height((ushort)d_buffers->image.rows),
+    d_hasImage(true)
+{
+  ASSERT(d_buffers);
+}
+
+Camera::Frame::Frame(FramePool::Handle buffers, Camera* camera, unsigned bufferIndex, uchar const* yuyv, ushort width, ushort height)
+  : d_buffers(move(buffers)),
+    d_camera(camera),
+    d_bufferIndex(bufferIndex),
+    d_yuyv(yuyv),
+    d_width(width),
+    d_height(height),
+    d_hasImage(false)
+{
+  ASSERT(d_buffers);
+  ASSERT(camera);
+  ASSERT(yuyv);
+}
+
+Camera::Frame::Frame(Frame&& other)
+  : d_buffers(move(other.d_buffers)),
+    d_camera(other.d_camera),
+    d_bufferIndex(other.d_bufferIndex),
+    d_yuyv(other.d_yuyv),
+    d_width(other.d_width),
+    d_height(other.d_height),
+    d_hasImage(other.d_hasImage)
+{
+  // The moved-from frame no longer owns the camera buffer
+  other.d_camera = nullptr;
+  other.d_yuyv = nullptr;
+}
+
+Camera::Frame::~Frame()
+{
+  if (d_camera)
+    d_camera->requeueBuffer(d_bufferIndex);
+}
+
+Mat& Camera::Frame::getImage()
+{
+  if (!d_hasImage)
+  {
+    ASSERT(d_yuyv);
+    convertYUYV(d_yuyv, d_buffers.getImage(d_width, d_height), false);
+    d_hasImage = true;
+  }
+
+  return d_buffers->image;
+}
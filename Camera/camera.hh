@@ -8,10 +8,12 @@
 
 #include "../util/Maybe.hh"
 #include "../Config/config.hh"
+#include "../FramePool/framepool.hh"
 
 namespace bold
 {
   typedef unsigned char uchar;
+  typedef unsigned short ushort;
   typedef unsigned int uint;
 
   class SettingBase;
@@ -113,6 +115,49 @@ namespace bold
       std::map<int,std::string> pairs;
     };
 
+    /** An image captured from the camera.
+     *
+     * A frame either holds a YCbCr image, or holds on to the camera's YUYV
+     * buffer so that pixels may be labelled straight from it. In the latter
+     * case the YCbCr image is only converted if requested, and the buffer is
+     * returned to the driver when the frame is destroyed.
+     */
+    class Frame
+    {
+    public:
+      /** A frame whose image has already been written to the pooled buffers. */
+      explicit Frame(FramePool::Handle buffers);
+      Frame(FramePool::Handle buffers, Camera* camera, unsigned bufferIndex, uchar const* yuyv, ushort width, ushort height);
+      Frame(Frame&& other);
+      Frame(Frame const&) = delete;
+      Frame& operator=(Frame const&) = delete;
+      ~Frame();
+
+      ushort getWidth() const { return d_width; }
+      ushort getHeight() const { return d_height; }
+
+      /** Whether raw YUYV data is available via getYUYV. */
+      bool hasYUYV() const { return d_yuyv != nullptr; }
+
+      /** The raw YUYV data, or nullptr if the frame only holds a YCbCr image. */
+      uchar const* getYUYV() const { return d_yuyv; }
+
+      /** The YCbCr image, converted from the camera buffer on first access. */
+      cv::Mat& getImage();
+
+      /** The pooled buffers holding this frame's image and label storage. */
+      FramePool::Handle const& getBuffers() const { return d_buffers; }
+
+    private:
+      FramePool::Handle d_buffers;
+      Camera* d_camera;
+      unsigned d_bufferIndex;
+      uchar const* d_yuyv;
+      ushort d_width;
+      ushort d_height;
+      bool d_hasImage;
+    };
+
     Camera(std::string const& device);
 
     void open();
@@ -138,7 +183,7 @@ namespace bold
     void startCapture();
     void stopCapture();
 
-    cv::Mat capture(SequentialTimer& timer);
+    Frame capture(SequentialTimer& timer);
 
     void setSquashWidth(bool squash) { d_squash = squash; }
 
@@ -154,12 +199,18 @@ namespace bold
 
     void setImageFeed(cv::Mat image) { d_imageFeed = image; }
 
+    /** The pool from which captured frames obtain their image and label buffers. */
+    FramePool const& getFramePool() const { return d_framePool; }
+
     friend struct PixelFormat;
 
   private:
     void createControls();
     void createFormats();
     void initMemoryMapping();
+    void requeueBuffer(unsigned index);
+
+    static void convertYUYV(uchar const* yuyv, cv::Mat& image, bool squash);
 
     std::string d_device;
     int d_fd;
@@ -176,5 +227,7 @@ namespace bold
     bool d_squash;
 
     cv::Mat d_imageFeed;
+
+    FramePool d_framePool;
   };
 }
@@ -1,7 +1,9 @@
 #include "camera.ih"
 
-Mat Camera::capture(SequentialTimer& t)
+Camera::Frame Camera::capture(SequentialTimer& t)
 {
+  static auto directLabel = Config::getSetting<bool>("camera.direct-label");
+
   v4l2_buffer buf;
   memset(&buf, 0, sizeof(buf));
   t.timeEvent("Zero Memory");
@@ -22,30 +24,63 @@ Mat Camera::capture(SequentialTimer& t)
   State::snapshot(StateTime::CameraImage);
   t.timeEvent("Snapshot State");
 
-  if (-1 == ioctl(d_fd, VIDIOC_QBUF, &buf))
+  auto buffers = d_framePool.acquire();
+  t.timeEvent("Acquire Frame Buffers");
+
+  // When labelling directly from the buffer, the frame keeps hold of it
+  // and re-queues it once the think cycle is finished with the image.
+  if (d_imageFeed.empty() && !d_squash && directLabel->getValue())
   {
-    log::error("Camera::capture") << "Error re-queueing buffer: " << strerror(errno) << " (" << errno << ")";
-    exit(EXIT_FAILURE);
+    log::trace("Camera::capture") << "Image captured (direct)";
+    return Frame(move(buffers), this, buf.index, d_buffers[buf.index].start, d_pixelFormat.width, d_pixelFormat.height);
   }
+
+  requeueBuffer(buf.index);
   t.timeEvent("Requeue");
 
   if (!d_imageFeed.empty())
   {
     log::trace("Camera::capture") << "Using image feed. " << d_imageFeed.cols << "x" << d_imageFeed.rows;
-    return d_imageFeed.clone();
+    d_imageFeed.copyTo(buffers.getImage(d_imageFeed.cols, d_imageFeed.rows));
+    return Frame(move(buffers));
   }
 
   log::trace("Camera::capture") << "Image captured";
 
-  // TODO VISION measure perf difference of reusing this image memory
-  Mat img(d_pixelFormat.height, d_squash ? d_pixelFormat.width / 2 : d_pixelFormat.width, CV_8UC3);
+  // Convert into the pooled image, which is only allocated when its size changes
+  Mat& img = buffers.getImage(d_squash ? d_pixelFormat.width / 2 : d_pixelFormat.width, d_pixelFormat.height);
+
+  convertYUYV(d_buffers[buf.index].start, img, d_squash);
+
+  t.timeEvent("Copy From Buffer");
+
+  return Frame(move(buffers));
+}
+
+void Camera::requeueBuffer(unsigned index)
+{
+  v4l2_buffer buf;
+  memset(&buf, 0, sizeof(buf));
 
-  uchar* datCursor = d_buffers[buf.index].start;
-  uchar* datEnd = datCursor + 4 * d_pixelFormat.height * d_pixelFormat.width / 2;
+  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  buf.memory = V4L2_MEMORY_MMAP;
+  buf.index = index;
+
+  if (-1 == ioctl(d_fd, VIDIOC_QBUF, &buf))
+  {
+    log::error("Camera::requeueBuffer") << "Error re-queueing buffer: " << strerror(errno) << " (" << errno << ")";
+    exit(EXIT_FAILURE);
+  }
+}
+
+void Camera::convertYUYV(uchar const* yuyv, Mat& img, bool squash)
+{
+  uchar const* datCursor = yuyv;
+  uchar const* datEnd = datCursor + 4 * img.rows * (squash ? img.cols : img.cols / 2);
   uchar* imgCursor = img.data;
 
   // Convert each set of four input values into either one or two pixels
-  if (d_squash)
+  if (squash)
   {
     while (datCursor != datEnd)
     {
@@ -83,8 +118,4 @@ Mat Camera::capture(SequentialTimer& t)
       datCursor += 4;
     }
   }
-
-  t.timeEvent("Copy From Buffer");
-
-  return img;
 }
@@ -140,6 +140,27 @@ namespace bold
       uint8_t v;
     };
 
+    /** Returns the table behind yCbCr2hsv18, indexed as (y>>2)<<12 | (cb>>2)<<6 | (cr>>2).
+     *
+     * The 768 KiB table is computed once, on first use, and shared by all callers.
+     */
+    hsv const* yCbCr2hsv18Table();
+
+    /** Converts YCbCr to HSV at 6 bits per YCbCr channel, via a precomputed table.
+     *
+     * Equivalent to bgr2hsv(YCbCr(y & 0xFC, cb & 0xFC, cr & 0xFC).toBgrInt()),
+     * which is the colour each cell of an 18-bit pixel label LUT represents.
+     */
+    hsv yCbCr2hsv18(YCbCr const& in);
+
+    /** Converts YCbCr to HSV at full precision, via a precomputed table.
+     *
+     * Equivalent to bgr2hsv(in.toBgrInt()). The 48 MiB table is an anonymous
+     * memory mapping, and each Y plane is only computed, and only occupies
+     * memory, once a colour within it is first converted.
+     */
+    hsv yCbCr2hsv24(YCbCr const& in);
+
     struct hsvRange
     {
       uint8_t hMin;
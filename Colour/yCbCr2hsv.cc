@@ -0,0 +1,95 @@
+#include "colour.hh"
+
+#include "../util/assert.hh"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sys/mman.h>
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  /// Full resolution YCbCr->HSV table. Address space for all 2^24 entries is
+  /// reserved up front, but each Y plane is only computed (and so only occupies
+  /// memory) once a colour within it is first looked up.
+  class HsvTable24
+  {
+  public:
+    HsvTable24()
+    {
+      d_table = static_cast<Colour::hsv*>(mmap(nullptr, TableBytes, PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+      ASSERT(d_table != MAP_FAILED);
+
+      for (auto& ready : d_planeReady)
+        ready.store(false);
+    }
+
+    ~HsvTable24()
+    {
+      munmap(d_table, TableBytes);
+    }
+
+    Colour::hsv const* getPlane(uint8_t y)
+    {
+      if (!d_planeReady[y].load(memory_order_acquire))
+        computePlane(y);
+      return d_table + (y << 16);
+    }
+
+  private:
+    static constexpr size_t TableBytes = (1 << 24) * sizeof(Colour::hsv);
+
+    void computePlane(uint8_t y)
+    {
+      // Each plane has its own lock, so that distinct planes, such as those
+      // handed to separate workers while building a LUT, fill concurrently
+      lock_guard<mutex> lock(d_planeMutexes[y]);
+
+      if (d_planeReady[y].load(memory_order_relaxed))
+        return;
+
+      Colour::hsv* p = d_table + (y << 16);
+      for (int cb = 0; cb < 256; ++cb)
+        for (int cr = 0; cr < 256; ++cr)
+          *(p++) = Colour::bgr2hsv(Colour::YCbCr(y, cb, cr).toBgrInt());
+
+      d_planeReady[y].store(true, memory_order_release);
+    }
+
+    Colour::hsv* d_table;
+    atomic<bool> d_planeReady[256];
+    mutex d_planeMutexes[256];
+  };
+}
+
+Colour::hsv const* Colour::yCbCr2hsv18Table()
+{
+  static unique_ptr<hsv[]> table = []
+  {
+    unique_ptr<hsv[]> t(new hsv[1 << 18]);
+    hsv* p = t.get();
+    for (int y = 0; y < 64; ++y)
+      for (int cb = 0; cb < 64; ++cb)
+        for (int cr = 0; cr < 64; ++cr)
+          *(p++) = bgr2hsv(YCbCr(y<<2, cb<<2, cr<<2).toBgrInt());
+    return t;
+  }();
+
+  return table.get();
+}
+
+Colour::hsv Colour::yCbCr2hsv18(YCbCr const& in)
+{
+  return yCbCr2hsv18Table()[((in.y >> 2) << 12) | ((in.cb >> 2) << 6) | (in.cr >> 2)];
+}
+
+Colour::hsv Colour::yCbCr2hsv24(YCbCr const& in)
+{
+  static HsvTable24 table;
+
+  return table.getPlane(in.y)[(in.cb << 8) | in.cr];
+}
@@ -15,13 +15,17 @@ void WebSocketLogAppender::append(LogLevel level, string const& scope, string co
 
   lock_guard<mutex> guard(d_sessionsMutex);
 
+  if (d_sessions.empty())
+    return;
+
+  // Encode once, and share the message between sessions
+  WebSocketBuffer buffer;
+  Writer<WebSocketBuffer> writer(buffer);
+  writeJson(writer, level, scope, message);
+  auto shared = JsonSession::share(move(buffer));
+
   for (JsonSession* session : d_sessions)
-  {
-    WebSocketBuffer buffer;
-    Writer<WebSocketBuffer> writer(buffer);
-    writeJson(writer, level, scope, message);
-    session->enqueue(move(buffer), /*suppressLwsNotify*/ true);
-  }
+    session->enqueue(shared, /*suppressLwsNotify*/ true);
 
   libwebsocket_callback_on_writable_all_protocol(d_protocol);
 }
@@ -122,6 +126,7 @@ DataStreamer::DataStreamer(shared_ptr<Camera> camera)
   {
     d_protocols[protocolIndex] = { stateTracker->name().c_str(), DataStreamer::_callback_state, sizeof(JsonSession), 0, 0 };
     stateTracker->websocketProtocol = &d_protocols[protocolIndex];
+    d_publishedStates.push_back({stateTracker, stateTracker->updateCount()});
     protocolIndex++;
   }
 
@@ -150,38 +155,6 @@ DataStreamer::DataStreamer(shared_ptr<Camera> camera)
   {
     ASSERT(libwebsocket_context_user(d_context) == this);
 
-    // Listen for StateObject changes and publish them via websockets
-    State::updated.connect(
-      [this](shared_ptr<StateTracker const> tracker)
-      {
-        // NOTE we may be writing from one thread, while another is dealing with
-        // a client connection (which modifies d_stateSessions), or sending data
-        // (which modifies the JsonSession queue.)
-
-        std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
-        auto range = d_stateSessions.equal_range(tracker->name());
-        if (range.first != range.second)
-        {
-          shared_ptr<StateObject const> obj = tracker->stateBase();
-
-          if (obj)
-          {
-            for (auto it = range.first; it != range.second; ++it)
-            {
-              JsonSession* session = it->second;
-
-              WebSocketBuffer buffer;
-              Writer<WebSocketBuffer> writer(buffer);
-              obj->writeJson(writer);
-              session->enqueue(move(buffer), /*suppressLwsNotify*/ true);
-            }
-
-            libwebsocket_callback_on_writable_all_protocol(tracker->websocketProtocol);
-          }
-        }
-      }
-    );
-
     // Listen for Setting<T> changes and publish them via websockets
     Config::updated.connect(
       [this](SettingBase const* setting)
@@ -193,13 +166,16 @@ DataStreamer::DataStreamer(shared_ptr<Camera> camera)
           return;
 
         lock_guard<mutex> guard(d_controlSessionsMutex);
+        if (d_controlSessions.empty())
+          return;
+
+        WebSocketBuffer buffer;
+        Writer<WebSocketBuffer> writer(buffer);
+        writeSettingUpdateJson(setting, writer);
+        auto shared = JsonSession::share(move(buffer));
+
         for (JsonSession* session : d_controlSessions)
-        {
-          WebSocketBuffer buffer;
-          Writer<WebSocketBuffer> writer(buffer);
-          writeSettingUpdateJson(setting, writer);
-          session->enqueue(move(buffer), /*suppressLwsNotify*/ true);
-        }
+          session->enqueue(shared, /*suppressLwsNotify*/ true);
 
         libwebsocket_callback_on_writable_all_protocol(d_controlProtocol);
       }
@@ -215,6 +191,24 @@ DataStreamer::DataStreamer(shared_ptr<Camera> camera)
   Config::getSetting<bool>("round-table.image-encoding.png.filters.paeth")->track([](bool enabled) { CameraSession::pngCodec.setFilterPaeth(enabled); });
   Config::getSetting<bool>("round-table.image-encoding.png.filters.avg")->track([](bool enabled) { CameraSession::pngCodec.setFilterAvg(enabled); });
 
+  d_stateMaxSendRate = Config::getSetting<double>("round-table.state-streaming.max-send-rate-hz");
+  d_coalesceStates = Config::getSetting<bool>("round-table.state-streaming.coalesce");
+  d_deltaKeyframeInterval = Config::getSetting<int>("round-table.state-streaming.delta-keyframe-interval");
+  d_keyframeAckTimeout = Config::getSetting<double>("round-table.state-streaming.keyframe-ack-timeout-seconds");
+
+  d_stateMaxSendRate->changed.connect([this](double hz)
+  {
+    lock_guard<mutex> guard(d_stateSessionsMutex);
+    for (auto const& pair : d_stateSessions)
+      pair.second->setMaxSendRate(hz);
+  });
+  d_coalesceStates->changed.connect([this](bool coalesce)
+  {
+    lock_guard<mutex> guard(d_stateSessionsMutex);
+    for (auto const& pair : d_stateSessions)
+      pair.second->setCoalesce(coalesce);
+  });
+
   log::info("DataStreamer::DataStreamer") << "Starting DataStreamer thread";
   d_thread = std::thread(&DataStreamer::run, this);
 }
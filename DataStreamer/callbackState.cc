@@ -5,8 +5,8 @@ int DataStreamer::callback_state(
   libwebsocket* wsi,
   libwebsocket_callback_reasons reason,
   void* session,
-  void* /*in*/,
-  size_t /*len*/)
+  void* in,
+  size_t len)
 {
   JsonSession* jsonSession = reinterpret_cast<JsonSession*>(session);
 
@@ -22,6 +22,8 @@ int DataStreamer::callback_state(
 
     // New client connected; initialize session
     new (jsonSession) JsonSession(protocol->name, wsi, context);
+    jsonSession->setCoalesce(d_coalesceStates->getValue());
+    jsonSession->setMaxSendRate(d_stateMaxSendRate->getValue());
 
     std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
     d_stateSessions.insert(make_pair(protocol->name, jsonSession));
@@ -82,6 +84,103 @@ int DataStreamer::callback_state(
     std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
     return jsonSession->write();
   }
+  case LWS_CALLBACK_RECEIVE:
+  {
+    ASSERT(ThreadUtil::isDataStreamerThread());
+
+    // Clients may choose how often they receive this state type, and whether
+    // types which have a binary encoding are sent with it rather than as JSON:
+    //
+    // { "max-send-rate-hz": 10 }
+    // { "encoding": "binary" }
+    // { "encoding": "json" }
+    //
+    // Clients may also ask for deltas against keyframes they acknowledge, and
+    // ask again whenever they need to resynchronise:
+    //
+    // { "delta": true }
+    // { "ack": 1234 }
+
+    if (len == 0)
+      return 0;
+
+    static string message;
+    message.append((char const*)in, len);
+
+    if (libwebsockets_remaining_packet_payload(wsi) != 0)
+      return 0;
+
+    Document doc;
+    doc.Parse<0>(message.c_str());
+    message.clear();
+
+    if (doc.HasParseError() || !doc.IsObject())
+    {
+      log::error("DataStreamer::callbackState") << "Error parsing JSON received from client";
+      return 0;
+    }
+
+    auto rateMember = doc.FindMember("max-send-rate-hz");
+    if (rateMember != doc.MemberEnd())
+    {
+      if (!rateMember->value.IsNumber() || rateMember->value.GetDouble() < 0)
+      {
+        log::error("DataStreamer::callbackState") << "Invalid 'max-send-rate-hz' received from client";
+        return 0;
+      }
+
+      std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
+      jsonSession->setMaxSendRate(rateMember->value.GetDouble());
+    }
+
+    auto encodingMember = doc.FindMember("encoding");
+    if (encodingMember != doc.MemberEnd())
+    {
+      if (!encodingMember->value.IsString())
+      {
+        log::error("DataStreamer::callbackState") << "Invalid 'encoding' received from client";
+        return 0;
+      }
+
+      char const* encoding = encodingMember->value.GetString();
+      if (strcmp(encoding, "binary") != 0 && strcmp(encoding, "json") != 0)
+      {
+        log::error("DataStreamer::callbackState") << "Unknown encoding requested by client: " << encoding;
+        return 0;
+      }
+
+      std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
+      jsonSession->setBinaryEncoding(strcmp(encoding, "binary") == 0);
+    }
+
+    auto deltaMember = doc.FindMember("delta");
+    if (deltaMember != doc.MemberEnd())
+    {
+      if (!deltaMember->value.IsBool())
+      {
+        log::error("DataStreamer::callbackState") << "Invalid 'delta' received from client";
+        return 0;
+      }
+
+      std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
+      jsonSession->setDeltaEncoding(deltaMember->value.GetBool());
+    }
+
+    auto ackMember = doc.FindMember("ack");
+    if (ackMember != doc.MemberEnd())
+    {
+      if (!ackMember->value.IsUint64())
+      {
+        log::error("DataStreamer::callbackState") << "Invalid 'ack' received from client";
+        return 0;
+      }
+
+      std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
+      jsonSession->acknowledgeKeyframe(ackMember->value.GetUint64());
+    }
+
+    return 0;
+  }
   default:
   {
     return 0;
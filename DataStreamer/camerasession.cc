@@ -15,13 +15,14 @@ CameraSession::CameraSession(libwebsocket_context* context, libwebsocket* wsi)
     d_wsi(wsi)
 {}
 
-void CameraSession::notifyImageAvailable(cv::Mat const& image, ImageEncoding encoding, std::map<uchar, Colour::bgr> const& palette)
+void CameraSession::notifyImageAvailable(cv::Mat const& image, ImageEncoding encoding, std::map<uchar, Colour::bgr> const& palette, FramePool::Handle const& frameBuffers)
 {
   ASSERT(ThreadUtil::isThinkLoopThread());
 
   {
     lock_guard<mutex> imageGuard(d_imageMutex);
     d_image = image;
+    d_frameBuffers = frameBuffers;
     d_imageEncoding = encoding;
     d_palette = palette;
     d_imgWaiting = true;
@@ -42,11 +43,14 @@ int CameraSession::write()
 
     // Take a thread-safe copy of the image to encode
     cv::Mat image;
+    FramePool::Handle frameBuffers;
     ImageEncoding encoding;
     std::map<uchar, Colour::bgr> palette;
     {
       lock_guard<mutex> imageGuard(d_imageMutex);
       image = d_image;
+      frameBuffers = move(d_frameBuffers);
+      d_image = cv::Mat();
       encoding = d_imageEncoding;
       palette = d_palette;
       d_imgWaiting = false;
@@ -13,8 +13,11 @@
 #include <opencv2/opencv.hpp>
 #include <sigc++/signal.h>
 
+#include "../Clock/clock.hh"
+#include "../FramePool/framepool.hh"
 #include "../ImageCodec/JpegCodec/jpegcodec.hh"
 #include "../ImageCodec/PngCodec/pngcodec.hh"
+#include "../KeyframeTracker/keyframetracker.hh"
 #include "../Setting/setting.hh"
 #include "../StateObject/stateobject.hh"
 #include "../util/assert.hh"
@@ -29,6 +32,7 @@ namespace bold
 {
   class Camera;
   class OptionTree;
+  class StateTracker;
 
   enum class ImageEncoding
   {
@@ -42,7 +46,7 @@ namespace bold
 
     ~CameraSession() = default;
 
-    void notifyImageAvailable(cv::Mat const& image, ImageEncoding encoding, std::map<uchar, Colour::bgr> const& palette);
+    void notifyImageAvailable(cv::Mat const& image, ImageEncoding encoding, std::map<uchar, Colour::bgr> const& palette, FramePool::Handle const& frameBuffers);
 
     int write();
 
@@ -61,6 +65,8 @@ namespace bold
 
     std::mutex d_imageMutex;
     cv::Mat d_image;
+    /** Keeps pooled frame buffers alive while d_image refers to them. */
+    FramePool::Handle d_frameBuffers;
     ImageEncoding d_imageEncoding;
     std::map<uchar, Colour::bgr> d_palette;
 
@@ -75,20 +81,102 @@ namespace bold
 
     ~JsonSession() = default;
 
+    /** Seals an encoded message so that it may be enqueued on any number of sessions, which share it rather than each holding a copy. */
+    static std::shared_ptr<WebSocketBuffer> share(WebSocketBuffer&& buffer);
+
     void enqueue(WebSocketBuffer&& buffer, bool suppressLwsNotify = false);
 
+    /** Enqueues a message sealed by share.
+     *
+     * Sending leaves the message's bytes as they were, so the same buffer may
+     * be queued on several sessions at once.
+     */
+    void enqueue(std::shared_ptr<WebSocketBuffer> const& buffer, bool suppressLwsNotify = false);
+
+    /** Enqueues a message sealed by share, to be sent as binary rather than text. */
+    void enqueueBinary(std::shared_ptr<WebSocketBuffer> const& buffer, bool suppressLwsNotify = false);
+
+    /** Enqueues a keyframe sealed by share. Coalescing replaces it only with the same keyframe sent again, as later deltas depend upon it. */
+    void enqueueKeyframe(std::shared_ptr<WebSocketBuffer> const& buffer, bool suppressLwsNotify = false);
+
     int write();
 
+    /** Sets whether the client asked for state objects in their binary encoding, where available, rather than JSON. */
+    void setBinaryEncoding(bool useBinaryEncoding) { _useBinaryEncoding = useBinaryEncoding; _hasBinarySchema = false; }
+    bool useBinaryEncoding() const { return _useBinaryEncoding; }
+
+    /** Whether the client has been sent the schema needed to decode binary messages, since asking for them. */
+    bool hasBinarySchema() const { return _hasBinarySchema; }
+    void setHasBinarySchema() { _hasBinarySchema = true; }
+
+    /** Sets whether the client asked for deltas against keyframes it has acknowledged, rather than complete state objects.
+     *
+     * Any acknowledged keyframe is forgotten, so the client is sent a keyframe
+     * next. Clients may ask again to resynchronise.
+     */
+    void setDeltaEncoding(bool useDeltaEncoding);
+    bool useDeltaEncoding() const { return _useDeltaEncoding; }
+
+    /** The keyframes sent to this client, for deciding whether to send it a keyframe or a delta. */
+    KeyframeTracker& getKeyframeTracker() { return _keyframeTracker; }
+
+    /** Records that the client holds the given keyframe, so that later deltas may be computed against it. */
+    void acknowledgeKeyframe(long long unsigned id);
+
+    /** Sets whether a message waiting to be sent is replaced by one enqueued after it.
+     *
+     * Suits protocols whose every message holds the complete latest value, so
+     * that a slow client receives current data rather than a growing backlog.
+     */
+    void setCoalesce(bool coalesce);
+
+    /** Limits how often this session begins sending a message. Zero removes the limit. */
+    void setMaxSendRate(double hz);
+
+    /** Requests a write callback if a message is waiting and the send rate allows it to begin.
+     *
+     * Rate limited sessions do not request callbacks while they must wait, so
+     * this should be called periodically on the DataStreamer thread.
+     */
+    void notifyIfSendDue();
+
+    struct Message
+    {
+      std::shared_ptr<WebSocketBuffer> buffer;
+      bool isBinary;
+      bool isKeyframe;
+    };
+
+    /** Whether coalescing may replace the queued message, which may have begun sending, with message.
+     *
+     * Text is not replaced by binary, as it may be the schema needed to decode
+     * it. Keyframes are only replaced by the same keyframe sent again, as the
+     * deltas that follow need them.
+     */
+    static bool canReplace(Message const& queued, bool queuedHasBegunSending, Message const& message);
+
   private:
+    void enqueue(Message message, bool suppressLwsNotify);
+
+    bool isSendDue() const;
+
     std::string _protocolName;
     libwebsocket* _wsi;
     libwebsocket_context* _context;
-    /** A queue of websocket buffers containing messages to send for this session. */
-    std::queue<WebSocketBuffer> _queue;
+    /** A queue of messages to send for this session, possibly shared with other sessions. */
+    std::queue<Message> _queue;
     std::mutex _queueMutex;
     /** The number of bytes already sent of the front message in the queue. */
     int _bytesSent;
     unsigned _maxQueueSeen;
+    bool _coalesce;
+    /** The minimum time between starting to send successive messages, or zero for no limit. */
+    double _minSendIntervalSeconds;
+    Clock::Timestamp _lastSendStart;
+    bool _useBinaryEncoding;
+    bool _hasBinarySchema;
+    bool _useDeltaEncoding;
+    KeyframeTracker _keyframeTracker;
     std::string _hostName;
     std::string _ipAddress;
   };
@@ -134,7 +222,12 @@ namespace bold
     bool hasCameraClients() const { return d_cameraSessions.size() != 0; }
 
     /** Enqueues an image to be sent to connected clients. */
-    void streamImage(cv::Mat const& img, ImageEncoding imageEncoding, std::map<uchar, Colour::bgr> const& palette);
+    /** Provides an image to connected camera clients.
+     *
+     * If img shares memory with pooled frame buffers, pass their handle as
+     * frameBuffers so that they are not reused until encoding has finished.
+     */
+    void streamImage(cv::Mat const& img, ImageEncoding imageEncoding, std::map<uchar, Colour::bgr> const& palette, FramePool::Handle const& frameBuffers = FramePool::Handle());
 
     void setOptionTree(std::shared_ptr<OptionTree> optionTree) { d_optionTree = optionTree; }
 
@@ -143,6 +236,9 @@ namespace bold
 
     void run();
 
+    /** Serialises the latest version of each state object updated since last published, for its connected clients. */
+    void publishStateUpdates();
+
     void processCommand(std::string json, JsonSession* jsonSession);
 
     void writeControlSyncJson(rapidjson::Writer<WebSocketBuffer>& writer);
@@ -165,6 +261,22 @@ namespace bold
     std::multimap<std::string, JsonSession*> d_stateSessions;
     std::mutex d_stateSessionsMutex;
 
+    /// Defaults applied to each state session, which a client may override for its own session
+    Setting<double>* d_stateMaxSendRate;
+    Setting<bool>* d_coalesceStates;
+    Setting<int>* d_deltaKeyframeInterval;
+    Setting<double>* d_keyframeAckTimeout;
+
+    struct PublishedState
+    {
+      std::shared_ptr<StateTracker> tracker;
+      /// The tracker's update count when it was last published
+      long long unsigned updateCount;
+    };
+
+    /// Only accessed on the DataStreamer thread
+    std::vector<PublishedState> d_publishedStates;
+
     bool d_isStopRequested;
     std::thread d_thread;
     std::shared_ptr<OptionTree> d_optionTree;
@@ -10,7 +10,14 @@ JsonSession::JsonSession(std::string protocolName, libwebsocket* wsi, libwebsock
     _context(context),
     _queue(),
     _bytesSent(0),
-    _maxQueueSeen(0)
+    _maxQueueSeen(0),
+    _coalesce(false),
+    _minSendIntervalSeconds(0),
+    _lastSendStart(0),
+    _useBinaryEncoding(false),
+    _hasBinarySchema(false),
+    _useDeltaEncoding(false),
+    _keyframeTracker()
 {
   // add client host name and IP address
   int fd = libwebsocket_get_socket_fd(wsi);
@@ -28,7 +35,12 @@ int JsonSession::write()
   // Fill the outbound pipe with frames of data
   while (!lws_send_pipe_choked(_wsi) && !_queue.empty())
   {
-    WebSocketBuffer& buffer = _queue.front();
+    // Hold back the next message until the send rate allows it
+    if (_bytesSent == 0 && !isSendDue())
+      break;
+
+    Message const& message = _queue.front();
+    WebSocketBuffer& buffer = *message.buffer;
 
     const int totalSize = static_cast<int>(buffer.GetSize()) - LWS_SEND_BUFFER_PRE_PADDING - LWS_SEND_BUFFER_POST_PADDING;
 
@@ -39,26 +51,38 @@ int JsonSession::write()
     const int remainingSize = totalSize - _bytesSent;
     const int frameSize = min(2048, remainingSize);
 
-    int writeMode = _bytesSent == 0
-      ? LWS_WRITE_TEXT
-      : LWS_WRITE_CONTINUATION;
+    int writeMode = _bytesSent != 0
+      ? LWS_WRITE_CONTINUATION
+      : message.isBinary
+        ? LWS_WRITE_BINARY
+        : LWS_WRITE_TEXT;
 
     if (frameSize != remainingSize)
       writeMode |= LWS_WRITE_NO_FIN;
 
-    bool storePostPadding = _bytesSent + frameSize < totalSize;
-    std::array<uchar,LWS_SEND_BUFFER_POST_PADDING> postPadding{};
-    if (storePostPadding)
-      std::copy(start + frameSize, start + frameSize + LWS_SEND_BUFFER_POST_PADDING, postPadding.data());
+    // libwebsockets writes the frame header into the padding before start,
+    // and may use the padding after the frame. Except around a whole message,
+    // that padding holds payload which other frames, or other sessions sharing
+    // this buffer, have still to send, so restore it afterwards.
+    std::array<uchar,LWS_SEND_BUFFER_PRE_PADDING> prePadding;
+    std::array<uchar,LWS_SEND_BUFFER_POST_PADDING> postPadding;
+    std::copy(start - LWS_SEND_BUFFER_PRE_PADDING, start, prePadding.data());
+    std::copy(start + frameSize, start + frameSize + LWS_SEND_BUFFER_POST_PADDING, postPadding.data());
 
     int res = libwebsocket_write(_wsi, start, frameSize, (libwebsocket_write_protocol)writeMode);
 
+    std::copy(prePadding.data(), prePadding.data() + LWS_SEND_BUFFER_PRE_PADDING, start - LWS_SEND_BUFFER_PRE_PADDING);
+    std::copy(postPadding.data(), postPadding.data() + LWS_SEND_BUFFER_POST_PADDING, start + frameSize);
+
     if (res < 0)
     {
       log::error("JsonSession::write") << "Error writing JSON to socket (" << res << ")";
       return 1;
     }
 
+    if (_bytesSent == 0)
+      _lastSendStart = Clock::getTimestamp();
+
     _bytesSent += frameSize;
 
     if (_bytesSent == totalSize)
@@ -67,24 +91,68 @@ int JsonSession::write()
       _queue.pop();
       _bytesSent = 0;
     }
-    else if (storePostPadding)
-    {
-      std::copy(postPadding.data(), postPadding.data() + LWS_SEND_BUFFER_POST_PADDING, start + frameSize);
-    }
   }
 
-  // Queue for more writing later on if we still have data remaining
-  if (!_queue.empty())
+  // Queue for more writing later on if we still have data remaining. A message
+  // held back by the send rate is picked up by notifyIfSendDue instead.
+  if (!_queue.empty() && (_bytesSent != 0 || isSendDue()))
     libwebsocket_callback_on_writable(_context, _wsi);
 
   return 0;
 }
 
+shared_ptr<WebSocketBuffer> JsonSession::share(WebSocketBuffer&& buffer)
+{
+  ASSERT(buffer.GetSize() > LWS_SEND_BUFFER_PRE_PADDING);
+
+  buffer.Push(LWS_SEND_BUFFER_POST_PADDING);
+  return make_shared<WebSocketBuffer>(move(buffer));
+}
+
 void JsonSession::enqueue(WebSocketBuffer&& buffer, bool suppressLwsNotify)
+{
+  enqueue(share(move(buffer)), suppressLwsNotify);
+}
+
+void JsonSession::enqueue(shared_ptr<WebSocketBuffer> const& buffer, bool suppressLwsNotify)
+{
+  enqueue(Message{buffer, false, false}, suppressLwsNotify);
+}
+
+void JsonSession::enqueueBinary(shared_ptr<WebSocketBuffer> const& buffer, bool suppressLwsNotify)
+{
+  enqueue(Message{buffer, true, false}, suppressLwsNotify);
+}
+
+void JsonSession::enqueueKeyframe(shared_ptr<WebSocketBuffer> const& buffer, bool suppressLwsNotify)
+{
+  enqueue(Message{buffer, false, true}, suppressLwsNotify);
+}
+
+bool JsonSession::canReplace(Message const& queued, bool queuedHasBegunSending, Message const& message)
+{
+  if (queuedHasBegunSending)
+    return false;
+
+  // A keyframe sent again takes the place of its earlier copy
+  if (queued.isKeyframe)
+    return queued.buffer == message.buffer;
+
+  return queued.isBinary == message.isBinary;
+}
+
+void JsonSession::enqueue(Message message, bool suppressLwsNotify)
 {
   lock_guard<mutex> guard(_queueMutex);
 
-  ASSERT(buffer.GetSize() != 0);
+  ASSERT(message.buffer);
+
+  // Replace a message that has not begun sending, rather than queueing behind it
+  if (_coalesce && !_queue.empty() && canReplace(_queue.back(), _queue.size() == 1 && _bytesSent != 0, message))
+  {
+    _queue.back() = move(message);
+    return;
+  }
 
   auto queueSize = static_cast<unsigned>(_queue.size());
 
@@ -99,15 +167,54 @@ void JsonSession::enqueue(WebSocketBuffer&& buffer, bool suppressLwsNotify)
   if (queueSize > MaxQueueSize)
   {
     log::error("StateUpdated") << "JsonSession queue to " << _hostName << '@' << _ipAddress << " for protocol '" << _protocolName << "' too long (" << queueSize << " > " << MaxQueueSize << ") — purging";
-    queue<WebSocketBuffer> empty;
+    queue<Message> empty;
     swap(_queue, empty);
   }
   else
   {
-    buffer.Push(LWS_SEND_BUFFER_POST_PADDING);
-    _queue.emplace(move(buffer));
+    _queue.push(move(message));
 
     if (!suppressLwsNotify)
       libwebsocket_callback_on_writable(_context, _wsi);
   }
 }
+
+void JsonSession::setCoalesce(bool coalesce)
+{
+  lock_guard<mutex> guard(_queueMutex);
+  _coalesce = coalesce;
+}
+
+void JsonSession::setMaxSendRate(double hz)
+{
+  ASSERT(hz >= 0);
+
+  lock_guard<mutex> guard(_queueMutex);
+  _minSendIntervalSeconds = hz > 0 ? 1.0 / hz : 0.0;
+}
+
+void JsonSession::notifyIfSendDue()
+{
+  lock_guard<mutex> guard(_queueMutex);
+
+  if (!_queue.empty() && _bytesSent == 0 && isSendDue())
+    libwebsocket_callback_on_writable(_context, _wsi);
+}
+
+bool JsonSession::isSendDue() const
+{
+  return _minSendIntervalSeconds == 0 || Clock::getSecondsSince(_lastSendStart) >= _minSendIntervalSeconds;
+}
+
+void JsonSession::setDeltaEncoding(bool useDeltaEncoding)
+{
+  _useDeltaEncoding = useDeltaEncoding;
+  _keyframeTracker.reset();
+}
+
+void JsonSession::acknowledgeKeyframe(long long unsigned id)
+{
+  // Either unknown, or older than a keyframe already acknowledged
+  if (!_keyframeTracker.acknowledge(id))
+    log::verbose("JsonSession::acknowledgeKeyframe") << _protocolName << " ignoring acknowledgement of keyframe " << id;
+}
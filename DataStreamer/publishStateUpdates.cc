@@ -0,0 +1,191 @@
+#include "datastreamer.ih"
+
+#include "../JsonDelta/jsondelta.hh"
+
+namespace
+{
+  void append(WebSocketBuffer& buffer, string const& text)
+  {
+    memcpy(buffer.Push(text.size()), text.data(), text.size());
+  }
+
+  // { ... }, as sent to clients not using deltas
+  shared_ptr<WebSocketBuffer> encodeState(string const& json)
+  {
+    WebSocketBuffer buffer;
+    append(buffer, json);
+    return JsonSession::share(move(buffer));
+  }
+
+  // { "keyframe": id, "state": { ... } }
+  shared_ptr<WebSocketBuffer> encodeKeyframe(long long unsigned id, string const& json)
+  {
+    WebSocketBuffer buffer;
+    append(buffer, "{\"keyframe\":" + to_string(id) + ",\"state\":");
+    append(buffer, json);
+    append(buffer, "}");
+    return JsonSession::share(move(buffer));
+  }
+
+  // { "base": id, "delta": { ... } }
+  //
+  // Returns nullptr when a keyframe should be sent instead, as the change
+  // cannot be expressed as a delta, or the delta would be no smaller.
+  shared_ptr<WebSocketBuffer> encodeDelta(KeyframeTracker::Keyframe const& base, string const& json)
+  {
+    string delta;
+    if (!JsonDelta::compute(*base.json, json, delta) || delta.size() >= json.size())
+      return nullptr;
+
+    WebSocketBuffer buffer;
+    append(buffer, "{\"base\":" + to_string(base.id) + ",\"delta\":");
+    append(buffer, delta);
+    append(buffer, "}");
+    return JsonSession::share(move(buffer));
+  }
+}
+
+void DataStreamer::publishStateUpdates()
+{
+  ASSERT(ThreadUtil::isDataStreamerThread());
+
+  // State::set only records a new version in its tracker, so serialisation
+  // happens here at the DataStreamer's own pace, rather than on the thread that
+  // set the state. Versions set between passes are coalesced into the latest.
+
+  std::lock_guard<std::mutex> guard(d_stateSessionsMutex);
+
+  for (PublishedState& published : d_publishedStates)
+  {
+    StateTracker const& tracker = *published.tracker;
+
+    auto range = d_stateSessions.equal_range(tracker.name());
+    if (range.first == range.second)
+    {
+      // Nobody is listening. Clients are sent the latest state when they connect.
+      published.updateCount = tracker.updateCount();
+      continue;
+    }
+
+    shared_ptr<StateObject const> obj = tracker.stateIfUpdatedSince(published.updateCount);
+
+    if (!obj)
+      continue;
+
+    // Encode once per encoding in use, however many clients are listening,
+    // and share the message between their sessions
+    shared_ptr<WebSocketBuffer> json;
+    shared_ptr<WebSocketBuffer> binary;
+    shared_ptr<string const> snapshot;
+    map<long long unsigned, shared_ptr<WebSocketBuffer>> keyframeById;
+    map<long long unsigned, shared_ptr<WebSocketBuffer>> deltaByBaseId;
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      JsonSession* session = it->second;
+
+      if (session->useBinaryEncoding() && obj->hasBinaryEncoding())
+      {
+        if (!session->hasBinarySchema())
+        {
+          WebSocketBuffer buffer;
+          Writer<WebSocketBuffer> writer(buffer);
+          writer.StartObject();
+          writer.String("schema");
+          obj->writeBinarySchemaJson(writer);
+          writer.EndObject();
+          session->enqueue(move(buffer), /*suppressLwsNotify*/ true);
+          session->setHasBinarySchema();
+        }
+
+        if (!binary)
+        {
+          WebSocketBuffer buffer;
+          obj->writeBinary(buffer);
+          binary = JsonSession::share(move(buffer));
+        }
+
+        session->enqueueBinary(binary, /*suppressLwsNotify*/ true);
+      }
+      else if (session->useDeltaEncoding())
+      {
+        if (!snapshot)
+        {
+          StringBuffer buffer;
+          Writer<StringBuffer> writer(buffer);
+          obj->writeJson(writer);
+          snapshot = make_shared<string const>(buffer.GetString(), buffer.GetSize());
+        }
+
+        KeyframeTracker& keyframes = session->getKeyframeTracker();
+        Clock::Timestamp now = Clock::getTimestamp();
+        double ackTimeout = d_keyframeAckTimeout->getValue();
+
+        // Deltas are against the client's acknowledged keyframe, so they remain
+        // valid if coalescing replaces a message before the client receives it
+        shared_ptr<WebSocketBuffer> delta;
+        if (!keyframes.isKeyframeDue(static_cast<unsigned>(d_deltaKeyframeInterval->getValue()), now, ackTimeout))
+        {
+          KeyframeTracker::Keyframe const& base = *keyframes.getAcknowledgedKeyframe();
+          auto found = deltaByBaseId.find(base.id);
+          if (found == deltaByBaseId.end())
+            found = deltaByBaseId.emplace(base.id, encodeDelta(base, *snapshot)).first;
+          delta = found->second;
+        }
+
+        if (delta)
+        {
+          session->enqueue(delta, /*suppressLwsNotify*/ true);
+          keyframes.deltaSent();
+        }
+        else if (KeyframeTracker::Keyframe const* awaited = keyframes.getAwaitedKeyframe(now, ackTimeout))
+        {
+          if (keyframes.getAcknowledgedKeyframe())
+          {
+            // The delta is not worth sending, but the client can take the
+            // complete state without waiting for the awaited keyframe
+            if (!json)
+              json = encodeState(*snapshot);
+            session->enqueue(json, /*suppressLwsNotify*/ true);
+          }
+          else
+          {
+            // Send the awaited keyframe again rather than a new one, which the
+            // client could not acknowledge before yet another replaced it
+            auto found = keyframeById.find(awaited->id);
+            if (found == keyframeById.end())
+              found = keyframeById.emplace(awaited->id, encodeKeyframe(awaited->id, *awaited->json)).first;
+            session->enqueueKeyframe(found->second, /*suppressLwsNotify*/ true);
+          }
+        }
+        else
+        {
+          // Keyframes are identified by the update count, which is unique to this version of the state
+          auto found = keyframeById.find(published.updateCount);
+          if (found == keyframeById.end())
+            found = keyframeById.emplace(published.updateCount, encodeKeyframe(published.updateCount, *snapshot)).first;
+          session->enqueueKeyframe(found->second, /*suppressLwsNotify*/ true);
+          keyframes.keyframeSent({published.updateCount, snapshot}, now);
+        }
+      }
+      else
+      {
+        if (!json)
+        {
+          WebSocketBuffer buffer;
+          Writer<WebSocketBuffer> writer(buffer);
+          obj->writeJson(writer);
+          json = JsonSession::share(move(buffer));
+        }
+
+        session->enqueue(json, /*suppressLwsNotify*/ true);
+      }
+    }
+
+    libwebsocket_callback_on_writable_all_protocol(tracker.websocketProtocol);
+  }
+
+  // Resume sessions whose send rate held back a message
+  for (auto const& pair : d_stateSessions)
+    pair.second->notifyIfSendDue();
+}
@@ -16,6 +16,11 @@ void DataStreamer::run()
     // Process whatever needs doing on the web socket (new clients, writing, receiving, etc)
     //
     libwebsocket_service(d_context, 10);
+
+    //
+    // Send state objects that have changed since the last pass
+    //
+    publishStateUpdates();
   }
 
   if (d_context)
@@ -1,11 +1,11 @@
 #include "datastreamer.ih"
 
-void DataStreamer::streamImage(cv::Mat const& img, ImageEncoding imageEncoding, std::map<uchar, Colour::bgr> const& palette)
+void DataStreamer::streamImage(cv::Mat const& img, ImageEncoding imageEncoding, std::map<uchar, Colour::bgr> const& palette, FramePool::Handle const& frameBuffers)
 {
   ASSERT(ThreadUtil::isThinkLoopThread());
 
   lock_guard<mutex> guard(d_cameraSessionsMutex);
 
   for (auto ses : d_cameraSessions)
-    ses->notifyImageAvailable(img, imageEncoding, palette);
+    ses->notifyImageAvailable(img, imageEncoding, palette, frameBuffers);
 }
@@ -0,0 +1,135 @@
+#include "framepool.hh"
+
+#include "../util/assert.hh"
+#include "../util/log.hh"
+
+using namespace bold;
+using namespace std;
+
+FramePool::FramePool(unsigned slotCount)
+  : d_slots(),
+    d_next(0),
+    d_allocationCount(0)
+{
+  ASSERT(slotCount != 0);
+
+  d_slots.reserve(slotCount);
+  for (unsigned i = 0; i < slotCount; i++)
+    d_slots.emplace_back(new Slot());
+}
+
+FramePool::Handle FramePool::acquire()
+{
+  unsigned slotCount = getSlotCount();
+
+  for (unsigned i = 0; i < slotCount; i++)
+  {
+    unsigned index = (d_next + i) % slotCount;
+    Slot* slot = d_slots[index].get();
+
+    unsigned expected = 0;
+    if (slot->refCount.compare_exchange_strong(expected, 1, memory_order_acquire))
+    {
+      d_next = (index + 1) % slotCount;
+      return Handle(this, slot);
+    }
+  }
+
+  // Every slot is held, so the pool must grow
+  log::warning("FramePool::acquire") << "All " << slotCount << " slots are in use, allocating another";
+
+  d_allocationCount++;
+  d_slots.emplace_back(new Slot());
+  Slot* slot = d_slots.back().get();
+  slot->refCount = 1;
+  d_next = 0;
+  return Handle(this, slot);
+}
+
+FramePool::Handle::Handle(FramePool* pool, Slot* slot)
+  : d_pool(pool),
+    d_slot(slot)
+{}
+
+FramePool::Handle::Handle(Handle const& other)
+  : d_pool(other.d_pool),
+    d_slot(other.d_slot)
+{
+  if (d_slot)
+    d_slot->refCount.fetch_add(1, memory_order_relaxed);
+}
+
+FramePool::Handle::Handle(Handle&& other)
+  : d_pool(other.d_pool),
+    d_slot(other.d_slot)
+{
+  other.d_pool = nullptr;
+  other.d_slot = nullptr;
+}
+
+FramePool::Handle& FramePool::Handle::operator=(Handle const& other)
+{
+  if (this != &other)
+  {
+    if (other.d_slot)
+      other.d_slot->refCount.fetch_add(1, memory_order_relaxed);
+    reset();
+    d_pool = other.d_pool;
+    d_slot = other.d_slot;
+  }
+  return *this;
+}
+
+FramePool::Handle& FramePool::Handle::operator=(Handle&& other)
+{
+  if (this != &other)
+  {
+    reset();
+    d_pool = other.d_pool;
+    d_slot = other.d_slot;
+    other.d_pool = nullptr;
+    other.d_slot = nullptr;
+  }
+  return *this;
+}
+
+void FramePool::Handle::reset()
+{
+  if (d_slot)
+    d_slot->refCount.fetch_sub(1, memory_order_release);
+
+  d_pool = nullptr;
+  d_slot = nullptr;
+}
+
+cv::Mat& FramePool::Handle::getImage(ushort width, ushort height) const
+{
+  ASSERT(d_slot);
+
+  cv::Mat& image = d_slot->image;
+
+  if (image.cols != width || image.rows != height || image.type() != CV_8UC3)
+  {
+    d_pool->d_allocationCount++;
+    image.create(height, width, CV_8UC3);
+  }
+
+  return image;
+}
+
+void FramePool::Handle::reserveLabels(unsigned pixelCount, unsigned rowCount) const
+{
+  ASSERT(d_slot);
+
+  if (d_slot->labels.capacity() < pixelCount)
+  {
+    d_pool->d_allocationCount++;
+    d_slot->labels.reserve(pixelCount);
+  }
+
+  if (d_slot->rows.capacity() < rowCount)
+  {
+    d_pool->d_allocationCount++;
+    d_slot->rows.reserve(rowCount);
+  }
+}
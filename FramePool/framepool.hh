@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "../ImageLabelData/imagelabeldata.hh"
+
+namespace bold
+{
+  /** A small ring of pre-allocated buffers used when processing camera frames.
+   *
+   * Each slot holds an image and the storage for its pixel labels. Slots are
+   * reference counted via Handle, so that another thread (eg. Round Table
+   * image streaming) may keep a frame's image after the think cycle is done
+   * with it. A slot returns to the pool when its last handle is released.
+   *
+   * Once every slot has been used, acquiring frames performs no heap allocation.
+   * Any allocation that does occur (a new slot, or a buffer that must grow) is
+   * counted, and reported via getAllocationCount.
+   *
+   * acquire must only be called from a single thread. Handles may be copied
+   * and released from any thread.
+   */
+  class FramePool
+  {
+  public:
+    struct Slot
+    {
+      Slot() : refCount(0) {}
+
+      cv::Mat image;
+      std::vector<uchar> labels;
+      std::vector<RowLabels> rows;
+      std::atomic<unsigned> refCount;
+    };
+
+    /** A counted reference to a slot in the pool. */
+    class Handle
+    {
+    public:
+      Handle() : d_pool(nullptr), d_slot(nullptr) {}
+      Handle(Handle const& other);
+      Handle(Handle&& other);
+      ~Handle() { reset(); }
+
+      Handle& operator=(Handle const& other);
+      Handle& operator=(Handle&& other);
+
+      explicit operator bool() const { return d_slot != nullptr; }
+
+      Slot* operator->() const { return d_slot; }
+      Slot& operator*() const { return *d_slot; }
+
+      /** Returns the slot's image, allocating it if it does not have the specified size. */
+      cv::Mat& getImage(ushort width, ushort height) const;
+
+      /** Ensures the slot's label storage can hold the specified number of pixels and rows without allocating. */
+      void reserveLabels(unsigned pixelCount, unsigned rowCount) const;
+
+      /** Releases this handle's reference, if any. */
+      void reset();
+
+    private:
+      friend class FramePool;
+
+      Handle(FramePool* pool, Slot* slot);
+
+      FramePool* d_pool;
+      Slot* d_slot;
+    };
+
+    explicit FramePool(unsigned slotCount);
+
+    /** Obtains a handle to an unused slot, allocating a new one only if all slots are held. */
+    Handle acquire();
+
+    unsigned getSlotCount() const { return static_cast<unsigned>(d_slots.size()); }
+
+    /** The number of heap allocations made by the pool since it was created. */
+    unsigned long getAllocationCount() const { return d_allocationCount; }
+
+  private:
+    std::vector<std::unique_ptr<Slot>> d_slots;
+    unsigned d_next;
+    std::atomic<unsigned long> d_allocationCount;
+  };
+}
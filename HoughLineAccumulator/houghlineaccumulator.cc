@@ -2,27 +2,28 @@
 
 #include <opencv2/core/core.hpp>
 
+#include "../util/assert.hh"
+
 using namespace bold;
 using namespace cv;
 using namespace std;
 
+constexpr int HoughLineAccumulator::TrigShift;
+
 void HoughLineAccumulator::add(int x, int y)
 {
   d_count++;
   uint16_t* rowBase = reinterpret_cast<uint16_t*>(d_accumulator.data);
   int halfAccRadLen = d_accumulatorRadiusLen / 2;
+  int16_t const* trig = d_trigTable.data();
 
-  for (uint t = 0; t < d_accumulatorThetaLen; t++)
+  for (uint t = 0; t < d_accumulatorThetaLen; t++, trig += 2)
   {
-    // r = x*sin(theta) + y*cos(theta)
-
-    // TODO store sin/cos in adjacent pairs for perf
-    double radius = x*d_sinCache[t] + y*d_cosCache[t];
-
-    auto radiusInt = unsigned(round(radius));
+    // r = x*sin(theta) + y*cos(theta), in fixed point, rounded to the nearest bin
+    int radius = (x * trig[0] + y * trig[1] + (1 << (TrigShift - 1))) >> TrigShift;
 
     // Recenter, as we have both positive and negative radius values
-    radiusInt += halfAccRadLen;
+    auto radiusInt = unsigned(radius + halfAccRadLen);
 
     // Check within bounds
     if (radiusInt < d_accumulatorRadiusLen)
@@ -37,22 +38,27 @@ void HoughLineAccumulator::add(int x, int y)
   }
 }
 
-HoughLineAccumulator::HoughLineAccumulator(uint xLength, uint yLength, uint accumulatorHeight)
+HoughLineAccumulator::HoughLineAccumulator(uint xLength, uint yLength, uint accumulatorHeight, double radiusResolution)
   : d_accumulatorThetaLen(accumulatorHeight),
+    d_radiusResolution(radiusResolution),
     // TODO the accumulator doesn't need to be quite this wide -- the negative side can be narrower (positive side is correct)
-    d_accumulatorRadiusLen(2 * (uint)ceil(sqrt(xLength*xLength + yLength*yLength))),
+    d_accumulatorRadiusLen(2 * (uint)ceil(sqrt(xLength*xLength + yLength*yLength) / radiusResolution)),
     d_xLength(xLength),
     d_yLength(yLength),
-    d_sinCache(new double[d_accumulatorThetaLen]),
-    d_cosCache(new double[d_accumulatorThetaLen])
+    d_trigTable(2 * accumulatorHeight),
+    d_count(0)
 {
+  // Table entries must fit within an int16
+  ASSERT(radiusResolution >= 1.0);
+
   // cache the values of sin and cos for faster processing
   const double d_thetaStepRadians = M_PI / d_accumulatorThetaLen;
+  const double scale = (1 << TrigShift) / radiusResolution;
   for (uint t = 0; t < d_accumulatorThetaLen; t++)
   {
     double theta = t*d_thetaStepRadians;
-    d_sinCache[t] = sin(theta);
-    d_cosCache[t] = cos(theta);
+    d_trigTable[t*2]   = (int16_t)round(sin(theta) * scale);
+    d_trigTable[t*2+1] = (int16_t)round(cos(theta) * scale);
   }
 
   // Accumulator matrix has x=radius, y=theta (this is 90 degrees rotated from most examples on the web)
@@ -61,15 +67,10 @@ HoughLineAccumulator::HoughLineAccumulator(uint xLength, uint yLength, uint accu
   clear();
 }
 
-HoughLineAccumulator::~HoughLineAccumulator()
-{
-  delete[] d_sinCache;
-  delete[] d_cosCache;
-}
-
 void HoughLineAccumulator::clear()
 {
   d_accumulator = cv::Scalar(0);
+  d_count = 0;
 }
 
 cv::Mat HoughLineAccumulator::getMat() const
@@ -84,5 +85,5 @@ double HoughLineAccumulator::getTheta(int y) const
 
 double HoughLineAccumulator::getRadius(int x) const
 {
-  return x - ((int)d_accumulatorRadiusLen / 2);
+  return (x - ((int)d_accumulatorRadiusLen / 2)) * d_radiusResolution;
 }
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cmath>
+#include <cstdint>
 #include <opencv2/core/core.hpp>
 
 namespace bold
@@ -11,8 +12,13 @@ namespace bold
   class HoughLineAccumulator
   {
   private:
+    /** Fixed point precision of trig table entries, in fractional bits. */
+    static constexpr int TrigShift = 14;
+
     /** Width of the accumulator matrix, spanning values of theta */
     uint const d_accumulatorThetaLen;
+    /** Size of each radius bin, in pixels */
+    double const d_radiusResolution;
     /** height of the accumulator matrix, spanning values of radius */
     uint const d_accumulatorRadiusLen;
 
@@ -21,19 +27,24 @@ namespace bold
     /** Height of the input image */
     uint const d_yLength;
 
-    // TODO multiplex these caches
-    /** Cached sine values across the integer range [0-d_accumulatorThetaLen). */
-    double* const d_sinCache;
-    /** Cached cosine values across the integer range [0-d_accumulatorThetaLen). */
-    double* const d_cosCache;
+    /** Fixed point sine and cosine values, stored in adjacent pairs for each
+     * step of theta. Values are divided by the radius resolution, so sums
+     * come out in units of radius bins.
+     */
+    std::vector<int16_t> d_trigTable;
 
     cv::Mat d_accumulator;
 
     int d_count;
 
   public:
-    HoughLineAccumulator(uint xLength, uint yLength, uint accumulatorHeight = 180);
-    ~HoughLineAccumulator();
+    /** Creates an accumulator for points within an image of the given size.
+     *
+     * accumulatorHeight is the number of steps of theta across [0,pi).
+     * radiusResolution is the width of each radius bin in pixels, and must
+     * be at least one.
+     */
+    HoughLineAccumulator(uint xLength, uint yLength, uint accumulatorHeight = 180, double radiusResolution = 1.0);
 
     /** The number of times 'add' was called since construction, or the last call to 'clear'. */
     int count() { return d_count; }
@@ -47,5 +58,7 @@ namespace bold
 
     double getTheta(int y) const;
     double getRadius(int x) const;
+
+    double getRadiusResolution() const { return d_radiusResolution; }
   };
 }
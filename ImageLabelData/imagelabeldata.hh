@@ -45,6 +45,18 @@ namespace bold
     RowLabels const* begin() const { return &(*d_rows.begin()); }
     RowLabels const* end() const { return &(*d_rows.end()); }
 
+    /** Moves this object's storage into the provided vectors, so that it may be reused for another frame.
+     *
+     * This object holds no labels afterwards.
+     */
+    void recycle(std::vector<uchar>& labels, std::vector<RowLabels>& rows)
+    {
+      labels = std::move(d_labels);
+      rows = std::move(d_rows);
+      d_labels.clear();
+      d_rows.clear();
+    }
+
   private:
     std::vector<uchar> d_labels;
     std::vector<RowLabels> d_rows;
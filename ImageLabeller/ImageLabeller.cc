@@ -1,42 +1,54 @@
 #include "imagelabeller.hh"
 
+#include <algorithm>
+#include <cstring>
+
 #include "../ImageLabelData/imagelabeldata.hh"
 #include "../ImageSampleMap/imagesamplemap.hh"
+#include "../RowLabelCache/rowlabelcache.hh"
 #include "../SequentialTimer/sequentialtimer.hh"
 #include "../Spatialiser/spatialiser.hh"
+#include "../util/workerpool.hh"
 
 using namespace cv;
 using namespace bold;
 using namespace Eigen;
 using namespace std;
 
-ImageLabeller::ImageLabeller(shared_ptr<Spatialiser> spatialiser)
+ImageLabeller::ImageLabeller(shared_ptr<Spatialiser> spatialiser, shared_ptr<WorkerPool> workerPool)
   : d_LUT(),
     d_spatialiser(spatialiser),
+    d_workerPool(workerPool),
+    d_parallel(false),
     d_lutMutex()
 {}
 
-ImageLabeller::ImageLabeller(shared_ptr<uchar const> const& lut, shared_ptr<Spatialiser> spatialiser)
+ImageLabeller::ImageLabeller(shared_ptr<LookUpTable const> const& lut, shared_ptr<Spatialiser> spatialiser, shared_ptr<WorkerPool> workerPool)
   : d_LUT(lut),
     d_spatialiser(spatialiser),
+    d_workerPool(workerPool),
+    d_parallel(false),
     d_lutMutex()
 {}
 
-void ImageLabeller::updateLut(shared_ptr<uchar const> const& lut)
+void ImageLabeller::updateLut(shared_ptr<LookUpTable const> const& lut)
 {
+  ASSERT(lut);
   lock_guard<mutex> guard(d_lutMutex);
   d_LUT = lut;
 }
 
-ImageLabelData ImageLabeller::label(Mat const& image, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer) const
+shared_ptr<LookUpTable const> ImageLabeller::getLut() const
 {
   // Make a threadsafe copy of the shared ptr, in case another thread reassigns the LUT (avoids segfault)
-  unique_lock<mutex> guard(d_lutMutex);
-  auto lutPtr = d_LUT;
-  guard.unlock();
-
-  uchar const* lut = lutPtr.get();
+  lock_guard<mutex> guard(d_lutMutex);
+  return d_LUT;
+}
 
+template<typename TLabelSpan>
+ImageLabelData ImageLabeller::labelRows(uchar const* lut, ushort width, ushort height, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                                        vector<uchar> labels, vector<RowLabels> rows, TLabelSpan const& labelSpan) const
+{
   // Everything above (and including) this row is guaranteed to be above horizon
   int maxHorizonY = 0;
   // Everything below this row is guaranteed to be under horizon
@@ -51,114 +63,264 @@ ImageLabelData ImageLabeller::label(Mat const& image, ImageSampleMap const& samp
   if (ignoreAboveHorizon)
   {
     minXHorizonY = d_spatialiser->findHorizonForColumn(0);
-    maxXHorizonY = d_spatialiser->findHorizonForColumn(image.cols - 1);
+    maxXHorizonY = d_spatialiser->findHorizonForColumn(width - 1);
     minHorizonY = min(minXHorizonY, maxXHorizonY);
     maxHorizonY = max(minXHorizonY, maxXHorizonY);
   }
   else
   {
     // If we shouldn't ignore above horizon, just say it's at the top of the image
-    minHorizonY = image.rows;
+    minHorizonY = height;
   }
 
   timer.timeEvent("Find Horizon");
 
-  auto granularity = sampleMap.begin();
-  ushort y = 0;
+  minHorizonY = min(minHorizonY, (int)height);
 
-  minHorizonY = min(minHorizonY, image.rows);
+  // Rows at or beyond this y are entirely above the horizon, and are not labelled
+  int endY = ignoreAboveHorizon && minHorizonY < height
+    ? min(maxHorizonY + 1, (int)height)
+    : minHorizonY;
 
-  // Contiguous storage for all labelled pixels
-  vector<uchar> labels;
+  // Contiguous storage for all labelled pixels. When recycled storage is
+  // provided with enough capacity, neither of these vectors allocates.
   labels.resize(sampleMap.getPixelCount());
   ASSERT(labels.size() == sampleMap.getPixelCount());
-  uchar* labelData = labels.data();
 
   // Data about each row of labelled pixels
-  vector<RowLabels> rows;
+  rows.clear();
   rows.reserve(sampleMap.getSampleRowCount());
 
-  //
-  // First batch: everything guaranteed under the horizon
-  //
-
-  while (y < minHorizonY)
+  // Lay out every row within the label storage first. Each row's offset is
+  // then fixed, so rows may be labelled in any order, or concurrently.
+  auto granularity = sampleMap.begin();
+  uchar* labelData = labels.data();
+  for (int y = 0; y < endY; y += granularity->y(), granularity++)
   {
-    uchar const* px = image.ptr<uchar>(y);
+    uchar const dx = granularity->x();
+    unsigned const pixelCount = (width + dx - 1) / dx;
 
-    uchar* from = labelData;
+    rows.emplace_back(labelData, labelData + pixelCount, y, *granularity);
+    labelData += pixelCount;
+  }
+
+  ASSERT(labelData - labels.data() <= sampleMap.getPixelCount());
 
-    const uchar dx = granularity->x();
+  timer.timeEvent("Lay Out Rows");
+
+  double horizonYRange = maxXHorizonY - minXHorizonY;
+  bool horizonUpwards = maxXHorizonY > minXHorizonY;
 
-    for (int x = 0; x < image.cols; x += dx)
+  auto labelRowRange = [&](unsigned rowBegin, unsigned rowEnd)
+  {
+    for (unsigned r = rowBegin; r < rowEnd; r++)
     {
-      *labelData = lut[((px[0] >> 2) << 12) | ((px[1] >> 2) << 6) | (px[2] >> 2)];
-      labelData++;
-      px += dx * 3;
+      RowLabels const& row = rows[r];
+      uchar* out = labels.data() + (row.begin() - labels.data());
+      ushort const y = row.imageY;
+      uchar const dx = row.granularity.x();
+      int const pixelCount = row.end() - row.begin();
+
+      // Everything guaranteed under the horizon
+      if (y < minHorizonY)
+      {
+        labelSpan(lut, y, 0, out, pixelCount, dx);
+        continue;
+      }
+
+      // The horizon goes through this row
+      double ratio = double(y - minXHorizonY) / double(horizonYRange);
+
+      int horizonX = Math::lerp(ratio, 0, width - 1);
+
+      // Rather than testing each pixel against the horizon, split the row into
+      // a span that is labelled and a span above the horizon that is zeroed.
+      // Sample i is at x = i * dx.
+      int labelBegin, labelEnd;
+      if (horizonUpwards)
+      {
+        // Above horizon where x < horizonX
+        labelBegin = horizonX <= 0 ? 0 : min(pixelCount, (horizonX + dx - 1) / dx);
+        labelEnd = pixelCount;
+      }
+      else
+      {
+        // Above horizon where x > horizonX
+        labelBegin = 0;
+        labelEnd = horizonX < 0 ? 0 : min(pixelCount, horizonX / dx + 1);
+      }
+
+      memset(out, 0, labelBegin);
+      labelSpan(lut, y, labelBegin, out + labelBegin, labelEnd - labelBegin, dx);
+      memset(out + labelEnd, 0, pixelCount - labelEnd);
     }
+  };
 
-    uchar* to = labelData;
+  unsigned const bandCount = d_parallel && d_workerPool ? d_workerPool->getConcurrency() : 1;
 
-    rows.emplace_back(from, to, y, *granularity);
+  if (bandCount == 1 || rows.size() < bandCount)
+  {
+    labelRowRange(0, rows.size());
+  }
+  else
+  {
+    // Split the rows into contiguous bands holding similar numbers of pixels.
+    // A band starts at the first row whose labels begin at or after its share
+    // of the total, which is found from the offsets laid out above.
+    size_t const totalPixelCount = labelData - labels.data();
+    auto bandStartRow = [&](unsigned band) -> unsigned
+    {
+      uchar const* bandStart = labels.data() + totalPixelCount * band / bandCount;
+      return lower_bound(rows.begin(), rows.end(), bandStart,
+                         [](RowLabels const& row, uchar const* p) { return row.begin() < p; }) - rows.begin();
+    };
 
-    y += granularity->y();
-    granularity++;
+    d_workerPool->run(bandCount, [&](unsigned band)
+    {
+      labelRowRange(bandStartRow(band), band + 1 == bandCount ? rows.size() : bandStartRow(band + 1));
+    });
   }
 
-  timer.timeEvent("Rows Under Horizon");
+  timer.timeEvent("Label Rows");
 
-  //
-  // Second batch: horizon goes through these rows
-  //
+  return ImageLabelData(move(labels), move(rows), width);
+}
 
-  double horizonYRange = maxXHorizonY - minXHorizonY;
-  if (ignoreAboveHorizon && minHorizonY < image.rows)
+template<typename TLabelSpan>
+ImageLabelData ImageLabeller::labelRegionRows(uchar const* lut, Bounds2i const& region, vector<uchar> labels, vector<RowLabels> rows, TLabelSpan const& labelSpan) const
+{
+  unsigned const width = region.width() + 1;
+  unsigned const height = region.height() + 1;
+
+  labels.resize(width * height);
+  rows.clear();
+  rows.reserve(height);
+
+  uchar* out = labels.data();
+  for (int y = region.min().y(); y <= region.max().y(); y++)
   {
-    ++maxHorizonY;
+    labelSpan(lut, y, region.min().x(), out, width);
+    rows.emplace_back(out, out + width, y, Matrix<uchar,2,1>(1, 1));
+    out += width;
+  }
 
-    bool horizonUpwards = maxXHorizonY > minXHorizonY;
+  return ImageLabelData(move(labels), move(rows), width);
+}
 
-    while (y < maxHorizonY && y < image.rows)
-    {
+ImageLabelData ImageLabeller::labelRegion(Mat const& image, Bounds2i const& region, vector<uchar> labels, vector<RowLabels> rows) const
+{
+  ASSERT(region.min().minCoeff() >= 0 && region.max().x() < image.cols && region.max().y() < image.rows);
 
-      uchar const* px = image.ptr<uchar>(y);
+  auto lut = getLut();
 
-      uchar* from = labelData;
+  auto labelSpan = [&image,&lut](uchar const* lutData, ushort y, unsigned x, uchar* out, unsigned count)
+  {
+    uchar const* px = image.ptr<uchar>(y) + x * 3;
+    switch (lut->getBitsPerChannel())
+    {
+      case 5:  labelRow<5>(lutData, px, out, count, 1); break;
+      case 6:  labelRow<6>(lutData, px, out, count, 1); break;
+      case 7:  labelRow<7>(lutData, px, out, count, 1); break;
+      default: labelRow<8>(lutData, px, out, count, 1); break;
+    }
+  };
 
-      double ratio = double(y - minXHorizonY) / double(horizonYRange);
+  return labelRegionRows(lut->data(), region, move(labels), move(rows), labelSpan);
+}
 
-      int horizonX = Math::lerp(ratio, 0, image.cols - 1);
-      // TODO: wrap two loops in for loop? Our Atom can't do branch
-      // prediction, so doing same check inside loop may be costly
-      // We can also directly fill the line we know to be 0
-      for (int x = 0; x < image.cols; x += granularity->x())
-      {
-        bool aboveHorizon =
-          (horizonUpwards && x < horizonX) ||
-          (!horizonUpwards && x > horizonX);
+ImageLabelData ImageLabeller::labelRegionYUYV(uchar const* yuyv, ushort width, ushort height, Bounds2i const& region, vector<uchar> labels, vector<RowLabels> rows) const
+{
+  ASSERT(width % 2 == 0);
+  ASSERT(region.min().minCoeff() >= 0 && region.max().x() < width && region.max().y() < height);
 
-        uchar l = aboveHorizon
-          ? (uchar)0
-          : lut[((px[0] >> 2) << 12) | ((px[1] >> 2) << 6) | (px[2] >> 2)];
+  auto lut = getLut();
+  ASSERT(lut->getColourSpace() == LUTColourSpace::YCbCr);
 
-        *labelData = l;
-        labelData++;
+  auto labelSpan = [yuyv,width,&lut](uchar const* lutData, ushort y, unsigned x, uchar* out, unsigned count)
+  {
+    uchar const* row = yuyv + y * width * 2;
+    switch (lut->getBitsPerChannel())
+    {
+      case 5:  labelRowYUYV<5>(lutData, row, x, out, count, 1); break;
+      case 6:  labelRowYUYV<6>(lutData, row, x, out, count, 1); break;
+      case 7:  labelRowYUYV<7>(lutData, row, x, out, count, 1); break;
+      default: labelRowYUYV<8>(lutData, row, x, out, count, 1); break;
+    }
+  };
 
-        px += granularity->x() * 3;
-      }
+  return labelRegionRows(lut->data(), region, move(labels), move(rows), labelSpan);
+}
 
-      uchar* to = labelData;
+template<uchar BITS>
+ImageLabelData ImageLabeller::labelImage(uchar const* lut, Mat const& image, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                                         vector<uchar> labels, vector<RowLabels> rows) const
+{
+  return labelRows(
+    lut, image.cols, image.rows, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows),
+    [&image](uchar const* lut, ushort y, unsigned begin, uchar* out, unsigned count, uchar dx)
+    {
+      labelRow<BITS>(lut, image.ptr<uchar>(y) + begin * dx * 3, out, count, dx);
+    });
+}
 
-      rows.emplace_back(from, to, y, *granularity);
+template<uchar BITS>
+ImageLabelData ImageLabeller::labelImageYUYV(uchar const* lut, uchar const* yuyv, ushort width, ushort height, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                                             vector<uchar> labels, vector<RowLabels> rows, RowLabelCache* rowCache) const
+{
+  if (rowCache)
+  {
+    return labelRows(
+      lut, width, height, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows),
+      [yuyv,width,rowCache](uchar const* lut, ushort y, unsigned begin, uchar* out, unsigned count, uchar dx)
+      {
+        rowCache->label(yuyv + y * width * 2, y, begin * dx, out, count, dx,
+                        [lut](uchar const* row, unsigned x, uchar* out, unsigned count, uchar dx)
+                        {
+                          labelRowYUYV<BITS>(lut, row, x, out, count, dx);
+                        });
+      });
+  }
 
-      y += granularity->y();
-      granularity++;
-    }
+  return labelRows(
+    lut, width, height, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows),
+    [yuyv,width](uchar const* lut, ushort y, unsigned begin, uchar* out, unsigned count, uchar dx)
+    {
+      labelRowYUYV<BITS>(lut, yuyv + y * width * 2, begin * dx, out, count, dx);
+    });
+}
+
+ImageLabelData ImageLabeller::label(Mat const& image, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                                    vector<uchar> labels, vector<RowLabels> rows) const
+{
+  auto lut = getLut();
 
-    timer.timeEvent("Rows Intersecting Horizon");
+  // Select the kernels specialised for this LUT's resolution
+  switch (lut->getBitsPerChannel())
+  {
+    case 5:  return labelImage<5>(lut->data(), image, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows));
+    case 6:  return labelImage<6>(lut->data(), image, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows));
+    case 7:  return labelImage<7>(lut->data(), image, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows));
+    default: return labelImage<8>(lut->data(), image, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows));
   }
+}
 
-  ASSERT(labelData - labels.data() <= sampleMap.getPixelCount());
+ImageLabelData ImageLabeller::labelYUYV(uchar const* yuyv, ushort width, ushort height, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                                        vector<uchar> labels, vector<RowLabels> rows, RowLabelCache* rowCache) const
+{
+  ASSERT(width % 2 == 0);
 
-  return ImageLabelData(move(labels), move(rows), image.cols);
+  auto lut = getLut();
+  ASSERT(lut->getColourSpace() == LUTColourSpace::YCbCr);
+
+  if (rowCache)
+    rowCache->beginFrame(lut);
+
+  // Select the kernels specialised for this LUT's resolution
+  switch (lut->getBitsPerChannel())
+  {
+    case 5:  return labelImageYUYV<5>(lut->data(), yuyv, width, height, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows), rowCache);
+    case 6:  return labelImageYUYV<6>(lut->data(), yuyv, width, height, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows), rowCache);
+    case 7:  return labelImageYUYV<7>(lut->data(), yuyv, width, height, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows), rowCache);
+    default: return labelImageYUYV<8>(lut->data(), yuyv, width, height, sampleMap, ignoreAboveHorizon, timer, move(labels), move(rows), rowCache);
+  }
 }
@@ -2,18 +2,23 @@
 
 #include <opencv2/core/core.hpp>
 
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <mutex>
 
+#include "../ImageLabelData/imagelabeldata.hh"
+#include "../geometry/Bounds.hh"
+#include "../LookUpTable/lookuptable.hh"
 #include "../PixelLabel/pixellabel.hh"
 
 namespace bold
 {
   class ImageSampleMap;
-  class ImageLabelData;
+  class RowLabelCache;
   class SequentialTimer;
   class Spatialiser;
+  class WorkerPool;
 
   enum class TeamColour
   {
@@ -24,19 +29,94 @@ namespace bold
   class ImageLabeller
   {
   public:
-    ImageLabeller(std::shared_ptr<Spatialiser> spatialiser);
+    ImageLabeller(std::shared_ptr<Spatialiser> spatialiser, std::shared_ptr<WorkerPool> workerPool = nullptr);
 
-    ImageLabeller(std::shared_ptr<uchar const> const& lut, std::shared_ptr<Spatialiser> spatialiser);
+    ImageLabeller(std::shared_ptr<LookUpTable const> const& lut, std::shared_ptr<Spatialiser> spatialiser, std::shared_ptr<WorkerPool> workerPool = nullptr);
 
-    /** Replaces the LUT used by this image labeller. */
-    void updateLut(std::shared_ptr<uchar const> const& lut);
+    /** Replaces the LUT used by this image labeller.
+     *
+     * The LUT may have any supported resolution. Labelling dispatches to
+     * kernels specialised for that resolution.
+     */
+    void updateLut(std::shared_ptr<LookUpTable const> const& lut);
 
-    /** Labels image pixels according to the specified sample map. */
-    ImageLabelData label(cv::Mat const& image, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer) const;
+    /** Sets whether rows are labelled in bands across the worker pool, if one was provided.
+     *
+     * Output is identical either way.
+     */
+    void setParallel(bool parallel) { d_parallel = parallel; }
+
+    /** Labels image pixels according to the specified sample map.
+     *
+     * If labels and rows are provided, their storage is reused for the result
+     * rather than being allocated afresh. See ImageLabelData::recycle.
+     */
+    ImageLabelData label(cv::Mat const& image, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                         std::vector<uchar> labels = {}, std::vector<RowLabels> rows = {}) const;
+
+    /** Labels pixels directly from a YUYV (4:2:2) buffer, such as that provided by the camera.
+     *
+     * Produces the same labels as converting the buffer to YCbCr and calling label,
+     * without materialising the intermediate image.
+     *
+     * If rowCache is provided, rows whose pixels are unchanged since they were
+     * cached take their labels from it.
+     */
+    ImageLabelData labelYUYV(uchar const* yuyv, ushort width, ushort height, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                             std::vector<uchar> labels = {}, std::vector<RowLabels> rows = {}, RowLabelCache* rowCache = nullptr) const;
+
+    /** Labels every pixel within a region of the image, at full resolution.
+     *
+     * The region's bounds are inclusive, and must lie within the image. Rows
+     * hold their y position within the image, while labels start at the
+     * region's left edge, so the result's width is that of the region.
+     */
+    ImageLabelData labelRegion(cv::Mat const& image, Bounds2i const& region,
+                               std::vector<uchar> labels = {}, std::vector<RowLabels> rows = {}) const;
+
+    /** Labels every pixel within a region of a YUYV (4:2:2) buffer, as for labelRegion. */
+    ImageLabelData labelRegionYUYV(uchar const* yuyv, ushort width, ushort height, Bounds2i const& region,
+                                   std::vector<uchar> labels = {}, std::vector<RowLabels> rows = {}) const;
+
+    /** Labels a row of YCbCr pixels using a LUT with BITS bits per channel.
+     *
+     * Reads pixelCount pixels from px, stepping dx pixels between samples,
+     * and writes one label per sample to out. Uses a vectorised kernel when
+     * built with VECTORISE_LABELLING, otherwise equivalent to labelRowScalar.
+     */
+    template<uchar BITS = 6>
+    static void labelRow(uchar const* lut, uchar const* px, uchar* out, unsigned pixelCount, uchar dx);
+
+    /** Reference scalar implementation of labelRow. */
+    template<uchar BITS = 6>
+    static void labelRowScalar(uchar const* lut, uchar const* px, uchar* out, unsigned pixelCount, uchar dx);
+
+    /** Labels a row of YUYV pixels using a LUT with BITS bits per channel, starting at column x. */
+    template<uchar BITS = 6>
+    static void labelRowYUYV(uchar const* lut, uchar const* row, unsigned x, uchar* out, unsigned pixelCount, uchar dx);
 
   private:
-    std::shared_ptr<uchar const> d_LUT;
+    std::shared_ptr<LookUpTable const> getLut() const;
+
+    template<uchar BITS>
+    ImageLabelData labelImage(uchar const* lut, cv::Mat const& image, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                              std::vector<uchar> labels, std::vector<RowLabels> rows) const;
+
+    template<uchar BITS>
+    ImageLabelData labelImageYUYV(uchar const* lut, uchar const* yuyv, ushort width, ushort height, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                                  std::vector<uchar> labels, std::vector<RowLabels> rows, RowLabelCache* rowCache) const;
+
+    template<typename TLabelSpan>
+    ImageLabelData labelRegionRows(uchar const* lut, Bounds2i const& region, std::vector<uchar> labels, std::vector<RowLabels> rows, TLabelSpan const& labelSpan) const;
+
+    template<typename TLabelSpan>
+    ImageLabelData labelRows(uchar const* lut, ushort width, ushort height, ImageSampleMap const& sampleMap, bool ignoreAboveHorizon, SequentialTimer& timer,
+                             std::vector<uchar> labels, std::vector<RowLabels> rows, TLabelSpan const& labelSpan) const;
+
+    std::shared_ptr<LookUpTable const> d_LUT;
     std::shared_ptr<Spatialiser> d_spatialiser;
+    std::shared_ptr<WorkerPool> d_workerPool;
+    std::atomic<bool> d_parallel;
     mutable std::mutex d_lutMutex;
   };
 }
@@ -0,0 +1,193 @@
+#include "imagelabeller.hh"
+
+#if defined(VECTORISE_LABELLING) && defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+#endif
+
+using namespace bold;
+
+template<uchar BITS>
+void ImageLabeller::labelRowScalar(uchar const* lut, uchar const* px, uchar* out, unsigned pixelCount, uchar dx)
+{
+  unsigned const step = dx * 3u;
+
+  for (unsigned i = 0; i < pixelCount; i++)
+  {
+    *out++ = lut[LookUpTable::index<BITS>(px[0], px[1], px[2])];
+    px += step;
+  }
+}
+
+template<uchar BITS>
+void ImageLabeller::labelRowYUYV(uchar const* lut, uchar const* row, unsigned x, uchar* out, unsigned pixelCount, uchar dx)
+{
+  // Each four byte macropixel [Y0 Cb Y1 Cr] holds two horizontally adjacent
+  // pixels which share chroma values
+  for (unsigned i = 0; i < pixelCount; i++)
+  {
+    uchar const* macropixel = row + (x & ~1u) * 2;
+    uchar y = macropixel[(x & 1u) * 2];
+    uchar cb = macropixel[1];
+    uchar cr = macropixel[3];
+
+    *out++ = lut[LookUpTable::index<BITS>(y, cb, cr)];
+    x += dx;
+  }
+}
+
+#if defined(VECTORISE_LABELLING) && defined(__SSE2__)
+
+namespace
+{
+#ifdef __SSSE3__
+  // Shuffle masks which pick channel c of 16 packed YCbCr pixels out of
+  // the 16-byte block b of a 48-byte load.
+  struct DeinterleaveMasks
+  {
+    DeinterleaveMasks()
+    {
+      for (int c = 0; c < 3; c++)
+      {
+        for (int b = 0; b < 3; b++)
+        {
+          alignas(16) int8_t bytes[16];
+          for (int i = 0; i < 16; i++)
+          {
+            int src = 3 * i + c - 16 * b;
+            bytes[i] = src >= 0 && src < 16 ? (int8_t)src : (int8_t)0x80;
+          }
+          masks[c][b] = _mm_load_si128(reinterpret_cast<__m128i const*>(bytes));
+        }
+      }
+    }
+
+    __m128i masks[3][3];
+  };
+
+  DeinterleaveMasks const deinterleaveMasks;
+#endif
+
+  /** Splits 16 contiguous YCbCr pixels into Y, Cb and Cr vectors. */
+  inline void deinterleave(uchar const* px, __m128i& y, __m128i& cb, __m128i& cr)
+  {
+#ifdef __SSSE3__
+    __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(px));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(px + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(px + 32));
+
+    auto const& m = deinterleaveMasks.masks;
+
+    y  = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m[0][0]), _mm_shuffle_epi8(b, m[0][1])), _mm_shuffle_epi8(c, m[0][2]));
+    cb = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m[1][0]), _mm_shuffle_epi8(b, m[1][1])), _mm_shuffle_epi8(c, m[1][2]));
+    cr = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m[2][0]), _mm_shuffle_epi8(b, m[2][1])), _mm_shuffle_epi8(c, m[2][2]));
+#else
+    // Without SSSE3 there is no byte shuffle, so split channels with scalar code
+    alignas(16) uchar planes[3][16];
+
+    for (unsigned i = 0; i < 16; i++)
+    {
+      planes[0][i] = px[3 * i + 0];
+      planes[1][i] = px[3 * i + 1];
+      planes[2][i] = px[3 * i + 2];
+    }
+
+    y  = _mm_load_si128(reinterpret_cast<__m128i const*>(planes[0]));
+    cb = _mm_load_si128(reinterpret_cast<__m128i const*>(planes[1]));
+    cr = _mm_load_si128(reinterpret_cast<__m128i const*>(planes[2]));
+#endif
+  }
+
+  /** Computes the LUT index of 16 pixels, for a LUT with BITS bits per channel. */
+  template<uchar BITS>
+  inline void computeIndices(__m128i y, __m128i cb, __m128i cr, uint32_t* indices)
+  {
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const mask = _mm_set1_epi8((char)(0xFF >> (8 - BITS)));
+
+    // Keep the top BITS bits of each channel. SSE2 has no 8-bit shift, so
+    // shift 16-bit lanes and mask off bits carried in from the neighbour.
+    y  = _mm_and_si128(_mm_srli_epi16(y,  8 - BITS), mask);
+    cb = _mm_and_si128(_mm_srli_epi16(cb, 8 - BITS), mask);
+    cr = _mm_and_si128(_mm_srli_epi16(cr, 8 - BITS), mask);
+
+    for (int half = 0; half < 2; half++)
+    {
+      __m128i y16  = half == 0 ? _mm_unpacklo_epi8(y,  zero) : _mm_unpackhi_epi8(y,  zero);
+      __m128i cb16 = half == 0 ? _mm_unpacklo_epi8(cb, zero) : _mm_unpackhi_epi8(cb, zero);
+      __m128i cr16 = half == 0 ? _mm_unpacklo_epi8(cr, zero) : _mm_unpackhi_epi8(cr, zero);
+
+      // The index is (y << 2*BITS) | (cb << BITS) | cr, which needs up to 24
+      // bits, so widen to 32-bit lanes before combining the channels.
+      for (int quarter = 0; quarter < 2; quarter++)
+      {
+        __m128i y32  = quarter == 0 ? _mm_unpacklo_epi16(y16,  zero) : _mm_unpackhi_epi16(y16,  zero);
+        __m128i cb32 = quarter == 0 ? _mm_unpacklo_epi16(cb16, zero) : _mm_unpackhi_epi16(cb16, zero);
+        __m128i cr32 = quarter == 0 ? _mm_unpacklo_epi16(cr16, zero) : _mm_unpackhi_epi16(cr16, zero);
+
+        __m128i index = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(y32, 2 * BITS), _mm_slli_epi32(cb32, BITS)), cr32);
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices + 8 * half + 4 * quarter), index);
+      }
+    }
+  }
+}
+
+template<uchar BITS>
+void ImageLabeller::labelRow(uchar const* lut, uchar const* px, uchar* out, unsigned pixelCount, uchar dx)
+{
+  // Sub-sampled rows are not contiguous in memory. Gathering their pixels
+  // into vectors costs more than the vectorised index computation saves, so
+  // only full resolution rows take the vectorised path.
+  if (dx != 1)
+  {
+    labelRowScalar<BITS>(lut, px, out, pixelCount, dx);
+    return;
+  }
+
+  alignas(16) uint32_t indices[16];
+
+  unsigned i = 0;
+  for (; i + 16 <= pixelCount; i += 16)
+  {
+    __m128i y, cb, cr;
+    deinterleave(px, y, cb, cr);
+    computeIndices<BITS>(y, cb, cr, indices);
+
+    for (unsigned j = 0; j < 16; j++)
+      out[j] = lut[indices[j]];
+
+    out += 16;
+    px += 16 * 3;
+  }
+
+  // Label any remaining pixels one at a time
+  labelRowScalar<BITS>(lut, px, out, pixelCount - i, dx);
+}
+
+#else
+
+template<uchar BITS>
+void ImageLabeller::labelRow(uchar const* lut, uchar const* px, uchar* out, unsigned pixelCount, uchar dx)
+{
+  labelRowScalar<BITS>(lut, px, out, pixelCount, dx);
+}
+
+#endif
+
+template void ImageLabeller::labelRow<5>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRow<6>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRow<7>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRow<8>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+
+template void ImageLabeller::labelRowScalar<5>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRowScalar<6>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRowScalar<7>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRowScalar<8>(uchar const*, uchar const*, uchar*, unsigned, uchar);
+
+template void ImageLabeller::labelRowYUYV<5>(uchar const*, uchar const*, unsigned, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRowYUYV<6>(uchar const*, uchar const*, unsigned, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRowYUYV<7>(uchar const*, uchar const*, unsigned, uchar*, unsigned, uchar);
+template void ImageLabeller::labelRowYUYV<8>(uchar const*, uchar const*, unsigned, uchar*, unsigned, uchar);
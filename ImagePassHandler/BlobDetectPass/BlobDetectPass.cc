@@ -1,28 +1,68 @@
 #include "blobdetectpass.hh"
 
+#include "../../ImageSampleMap/imagesamplemap.hh"
+
 using namespace bold;
 using namespace std;
 
+constexpr uint8_t BlobDetectPass::NoSlot;
+
 BlobDetectPass::BlobDetectPass(ushort imageWidth, ushort imageHeight, vector<shared_ptr<PixelLabel>> const& pixelLabels)
   : ImagePassHandler("BlobDetectPass"),
     d_imageHeight(imageHeight),
     d_imageWidth(imageWidth),
     d_pixelLabels(pixelLabels),
-    d_runsPerRowPerLabel()
+    d_collectRunsBySlot(pixelLabels.size(), false),
+    d_runs(),
+    d_runCounts(pixelLabels.size(), 0),
+    d_rowRunStarts(),
+    d_runCapacity(0),
+    d_rowCapacity(0)
 {
-  // Create a run length code for each label
-  for (auto const& pixelLabel : pixelLabels)
-  {
-    uint8_t pixelLabelId = (uint8_t)pixelLabel->getID();
+  ASSERT(pixelLabels.size() < NoSlot);
 
-    // A RunLengthCode is a vector of vectors of runs
-    d_runsPerRowPerLabel[pixelLabelId] = RunLengthCode();
-
-    // Initialise a vector of Runs for each row in the image
-    for (unsigned y = 0; y < d_imageHeight; ++y)
-      d_runsPerRowPerLabel[pixelLabelId].emplace_back();
+  // Give each label a slot in the run buffers
+  d_slotByLabel.fill(NoSlot);
+  for (unsigned slot = 0; slot < pixelLabels.size(); ++slot)
+  {
+    uint8_t pixelLabelId = (uint8_t)pixelLabels[slot]->getID();
+    d_slotByLabel[pixelLabelId] = (uint8_t)slot;
 
     // Initialize blob container
-    d_blobsDetectedPerLabel[pixelLabel] = vector<Blob>();
+    d_blobsDetectedPerLabel[pixelLabels[slot]] = vector<Blob>();
   }
 }
+
+void BlobDetectPass::reserve(ImageSampleMap const& sampleMap)
+{
+  reserve(sampleMap.getPixelCount(), sampleMap.getSampleRowCount());
+}
+
+void BlobDetectPass::reserve(unsigned pixelCount, unsigned rowCount)
+{
+  // A row of n samples holds at most (n + 1) / 2 runs of any one label
+  unsigned runCapacity = (pixelCount + rowCount) / 2;
+
+  if (runCapacity <= d_runCapacity && rowCount <= d_rowCapacity)
+    return;
+
+  d_runCapacity = max(d_runCapacity, runCapacity);
+  d_rowCapacity = max(d_rowCapacity, rowCount);
+
+  unsigned slotCount = d_pixelLabels.size();
+  d_runs.assign(slotCount * d_runCapacity, Run(0, 0));
+  d_rowRunStarts.assign(slotCount * (d_rowCapacity + 1), 0);
+  d_rowIndices.reserve(d_rowCapacity);
+
+  // Any runs held are discarded
+  d_rowIndices.clear();
+  fill(d_runCounts.begin(), d_runCounts.end(), 0);
+}
+
+void BlobDetectPass::setCollectRuns(shared_ptr<PixelLabel> const& pixelLabel, bool collectRuns)
+{
+  uint8_t slot = d_slotByLabel[(uint8_t)pixelLabel->getID()];
+  ASSERT(slot != NoSlot);
+  if (slot != NoSlot)
+    d_collectRunsBySlot[slot] = collectRuns;
+}
@@ -4,13 +4,15 @@
 #include <Eigen/Core>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
 #include <memory>
 #include <set>
 #include <vector>
 #include <Eigen/StdVector>
 
 #include "../imagepasshandler.hh"
-#include "../../DisjointSet/disjointset.hh"
 #include "../../ImageLabelData/imagelabeldata.hh"
 #include "../../geometry/Bounds.hh"
 #include "../../PixelLabel/pixellabel.hh"
@@ -52,6 +54,15 @@ namespace bold
 
     float midX() const { return (endX + startX) / 2.0f; }
 
+    /** Returns the sum of the x positions of pixels in the run. */
+    double sumX() const { return length() * (endX + startX) / 2.0; }
+
+    /** Returns the sum of the squared x positions of pixels in the run.
+     *
+     * Computed in closed form, as the difference of two sums of squares.
+     */
+    double sumXX() const;
+
     inline friend std::ostream& operator<<(std::ostream& stream, Run const& run)
     {
       return stream << "Run (y=" << run.y << " x=[" << run.startX << "," << run.endX << "] len=" << run.length() << ")";
@@ -66,15 +77,35 @@ namespace bold
     Blob();
     Blob(ImagePos const& _ul, ImagePos const& _br,
          unsigned _area,
-         Eigen::Vector2f _mean, // Eigen::Matrix2f _covar,
+         Eigen::Vector2f _mean, Eigen::Matrix2f _covar,
          std::set<Run> const& _runs);
 
     cv::Rect toRect() const;
 
     ImageBounds bounds() const;
 
+    /** Returns the angle of the blob's principal axis, in radians from the image's x axis.
+     *
+     * The result is in the range [-pi/2, pi/2]. It is meaningless for blobs
+     * with an eccentricity near zero, which have no dominant axis.
+     */
+    float orientation() const;
+
+    /** Returns the eccentricity of the ellipse with the blob's second moments.
+     *
+     * Zero for blobs which spread equally in all directions, approaching one
+     * as blobs become elongated. A single row or column has eccentricity one.
+     */
+    float eccentricity() const;
+
     void merge(Blob& other);
 
+    /** Moves the blob, and any runs it holds, by the given offset.
+     *
+     * Used to place blobs found within a region of the image.
+     */
+    void translate(ImagePos const& offset);
+
     bool operator<(Blob const& other) const;
     bool operator>(Blob const& other) const { return other < *this; }
 
@@ -82,9 +113,9 @@ namespace bold
     ImagePos br;             ///< Bottom right pixel (max)
     unsigned area;           ///< Number of pixels in blob
     Eigen::Vector2f mean;    ///< Mean
-//  Eigen::Matrix2f covar;   ///< Covarience
+    Eigen::Matrix2f covar;   ///< Covariance of pixel positions
 
-    std::set<Run> runs;      ///< Runs in this blob
+    std::set<Run> runs;      ///< Runs in this blob, if collected for its label
 
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -99,6 +130,7 @@ EIGEN_DEFINE_STL_VECTOR_SPECIALIZATION(bold::Blob)
 
 namespace bold
 {
+  class ImageSampleMap;
   class SequentialTimer;
 
   /** Blob detection image pass
@@ -112,6 +144,13 @@ namespace bold
 
     void clear();
 
+    /** Ensures run storage can hold the worst case for images sampled with the given map.
+     *
+     * process grows storage itself when needed, but calling this whenever the
+     * sample map changes means storage is never reallocated mid-frame.
+     */
+    void reserve(ImageSampleMap const& sampleMap);
+
     void process(ImageLabelData const& labelData, SequentialTimer& timer) override;
 
     std::vector<std::shared_ptr<PixelLabel>> pixelLabels() const { return d_pixelLabels; }
@@ -121,12 +160,54 @@ namespace bold
 
     std::map<std::shared_ptr<PixelLabel>,std::vector<Blob>> const& getDetectedBlobs() const { return d_blobsDetectedPerLabel; }
 
+    /** Sets whether blobs of the given label are populated with their runs.
+     *
+     * Collecting runs is off by default, as most consumers only need a blob's
+     * bounds, area and mean, which are accumulated without them.
+     */
+    void setCollectRuns(std::shared_ptr<PixelLabel> const& pixelLabel, bool collectRuns);
+
     static Blob runSetToBlob(std::set<Run> const& runSet);
 
   private:
-    typedef std::vector<std::vector<Run>> RunLengthCode;
+    static constexpr uint8_t NoSlot = 0xFF;
+
+    /** Running totals for a set of connected runs, held at its root. */
+    struct RunSetStats
+    {
+      ushort minX;
+      ushort minY;
+      ushort maxX;
+      ushort maxY;
+      unsigned area;
+      double sumX;
+      double sumY;
+      double sumXX;
+      double sumXY;
+      double sumYY;
+
+      /// Stats for a single run, using closed form sums over its pixels.
+      static RunSetStats fromRun(Run const& run);
+
+      /// Adds the stats of a disjoint set of runs to these.
+      void add(RunSetStats const& other);
+
+      /// Creates a blob with these bounds, area and moments, without runs.
+      Blob toBlob() const;
+    };
+
+    /// Finds the root run index of the set containing run index i, halving the path on the way.
+    unsigned findRoot(unsigned i);
 
-    void addRun(Run& run, uint8_t label);
+    /// Joins the sets containing run indices a and b, combining their stats at the new root.
+    void unite(unsigned a, unsigned b);
+
+    /// Finds blobs among one label's runs, which are grouped into rows by rowRunStarts.
+    void detectBlobs(Run const* runs, unsigned const* rowRunStarts, unsigned rowCount, bool collectRuns, std::vector<Blob>& blobs, SequentialTimer& timer);
+
+    void reserve(unsigned pixelCount, unsigned rowCount);
+
+    void addRun(uint8_t label, ushort startX, ushort endX, ushort y);
 
     ushort d_imageHeight;
     ushort d_imageWidth;
@@ -134,8 +215,26 @@ namespace bold
     std::vector<std::shared_ptr<PixelLabel>> d_pixelLabels;
     std::vector<ushort> d_rowIndices;
 
-    // Image pass state Accumulated data for the most recently passed image.
-    std::map<uint8_t, RunLengthCode> d_runsPerRowPerLabel;
+    // Maps each label ID to the index of its pixel label in d_pixelLabels, or NoSlot
+    std::array<uint8_t,256> d_slotByLabel;
+
+    // Whether blobs are populated with runs, per slot
+    std::vector<bool> d_collectRunsBySlot;
+
+    // Image pass state: runs found in the most recently passed image. Each
+    // slot owns a contiguous region of d_runs, d_runCapacity runs long, and
+    // of d_rowRunStarts, which holds the index of each row's first run within
+    // that region followed by the total run count.
+    std::vector<Run> d_runs;
+    std::vector<unsigned> d_runCounts;
+    std::vector<unsigned> d_rowRunStarts;
+    unsigned d_runCapacity;
+    unsigned d_rowCapacity;
+
+    // Union-find state over the runs of a single label, indexed by run, reused between calls
+    std::vector<unsigned> d_runParents;
+    std::vector<RunSetStats> d_runSetStats;
+    std::vector<unsigned> d_blobIndices;
 
     // Blobs detected
     std::map<std::shared_ptr<PixelLabel>,std::vector<Blob>> d_blobsDetectedPerLabel;
@@ -150,34 +249,32 @@ namespace bold
   inline void BlobDetectPass::process(ImageLabelData const& labelData, SequentialTimer& timer)
   {
     // Clear all persistent data
-    for (auto& pair : d_runsPerRowPerLabel)
-      for (std::vector<Run>& runs : pair.second)
-        runs.clear();
-
-    // TODO size of this vector is known at this point -- avoid reallocation
+    std::fill(d_runCounts.begin(), d_runCounts.end(), 0);
     d_rowIndices.clear();
 
-    uint8_t currentLabel = 0;
-    Run currentRun(0, 0);
-
     timer.timeEvent("Clear");
 
     if (labelData.getLabelledRowCount() == 0)
       return;
 
+    unsigned pixelCount = 0;
+    for (auto const& row : labelData)
+      pixelCount += row.end() - row.begin();
+    reserve(pixelCount, labelData.getLabelledRowCount());
+
+    unsigned const slotCount = d_pixelLabels.size();
+    unsigned const rowStartsStride = d_rowCapacity + 1;
+
     for (auto const& row : labelData)
     {
-      // TODO VISION might miss last run on last row with this approach
-      if (currentLabel != 0)
-      {
-        // finish whatever run we were on
-        currentRun.endX = d_imageWidth - (ushort)1;
-        addRun(currentRun, currentLabel);
-      }
-      currentRun.y = row.imageY;
-      currentLabel = 0;
+      unsigned rowIndex = d_rowIndices.size();
       d_rowIndices.push_back(row.imageY);
 
+      for (unsigned slot = 0; slot < slotCount; ++slot)
+        d_rowRunStarts[slot * rowStartsStride + rowIndex] = d_runCounts[slot];
+
+      uint8_t currentLabel = 0;
+      ushort startX = 0;
       ushort x = 0;
       for (auto const& label : row)
       {
@@ -186,33 +283,30 @@ namespace bold
         {
           // Check whether this is the end of the current run
           if (currentLabel != 0)
-          {
-            // Finished run
-            currentRun.endX = x - (ushort)1;
-            addRun(currentRun, currentLabel);
-          }
-
-          // Check whether this is the start of a new run
-          if (label != 0)
-          {
-            // Start new run
-            currentRun.startX = x;
-          }
+            addRun(currentLabel, startX, x - (ushort)1, row.imageY);
 
+          // Any new run starts here
+          startX = x;
           currentLabel = label;
         }
         x += row.granularity.x();
       }
+
+      // Finish whatever run we were on
+      if (currentLabel != 0)
+        addRun(currentLabel, startX, labelData.getImageWidth() - (ushort)1, row.imageY);
     }
+
+    for (unsigned slot = 0; slot < slotCount; ++slot)
+      d_rowRunStarts[slot * rowStartsStride + d_rowIndices.size()] = d_runCounts[slot];
+
     timer.timeEvent("Process Rows");
   }
 
   inline void BlobDetectPass::clear()
   {
     // Clear all persistent data
-    for (auto& pair : d_runsPerRowPerLabel)
-      for (std::vector<Run>& runs : pair.second)
-        runs.clear();
+    std::fill(d_runCounts.begin(), d_runCounts.end(), 0);
     d_rowIndices.clear();
     for (auto& pair : d_blobsDetectedPerLabel)
     {
@@ -221,12 +315,70 @@ namespace bold
     }
   }
 
-  inline void BlobDetectPass::addRun(Run& run, uint8_t label)
+  inline unsigned BlobDetectPass::findRoot(unsigned i)
+  {
+    while (d_runParents[i] != i)
+    {
+      d_runParents[i] = d_runParents[d_runParents[i]];
+      i = d_runParents[i];
+    }
+    return i;
+  }
+
+  inline void BlobDetectPass::unite(unsigned a, unsigned b)
+  {
+    a = findRoot(a);
+    b = findRoot(b);
+
+    if (a == b)
+      return;
+
+    // The earliest run is kept as the root, so blobs come out ordered by their first run
+    if (b < a)
+      std::swap(a, b);
+
+    d_runParents[b] = a;
+
+    d_runSetStats[a].add(d_runSetStats[b]);
+  }
+
+  inline BlobDetectPass::RunSetStats BlobDetectPass::RunSetStats::fromRun(Run const& run)
+  {
+    ushort length = run.length();
+    double sumX = run.sumX();
+    return RunSetStats{
+      run.startX, run.y, run.endX, run.y,
+      length,
+      sumX,
+      (double)length * run.y,
+      run.sumXX(),
+      sumX * run.y,
+      (double)length * run.y * run.y
+    };
+  }
+
+  inline void BlobDetectPass::RunSetStats::add(RunSetStats const& other)
   {
-    // TODO PERFORMANCE do this with pointer arithmetic rather than a map lookup
-    auto it = d_runsPerRowPerLabel.find(label);
-    if (it != d_runsPerRowPerLabel.end())
-      it->second[run.y].push_back(run);
+    minX = std::min(minX, other.minX);
+    minY = std::min(minY, other.minY);
+    maxX = std::max(maxX, other.maxX);
+    maxY = std::max(maxY, other.maxY);
+    area += other.area;
+    sumX += other.sumX;
+    sumY += other.sumY;
+    sumXX += other.sumXX;
+    sumXY += other.sumXY;
+    sumYY += other.sumYY;
+  }
+
+  inline void BlobDetectPass::addRun(uint8_t label, ushort startX, ushort endX, ushort y)
+  {
+    uint8_t slot = d_slotByLabel[label];
+    if (slot == NoSlot)
+      return;
+
+    ASSERT(d_runCounts[slot] < d_runCapacity);
+    d_runs[slot * d_runCapacity + d_runCounts[slot]++] = Run(startX, endX, y);
   }
 
   //
@@ -254,6 +406,13 @@ namespace bold
     return std::max(endX, b.endX) - std::min(startX, b.startX) < length() + b.length();
   }
 
+  inline double Run::sumXX() const
+  {
+    // Sum of n^2 for n in [0,k] is k(k+1)(2k+1)/6
+    auto squareSum = [](double k) { return k * (k + 1) * (2 * k + 1) / 6; };
+    return squareSum(endX) - squareSum(startX - 1.0);
+  }
+
   inline bool Run::operator<(Run const& other) const
   {
     return
@@ -268,19 +427,19 @@ namespace bold
     : ul(std::numeric_limits<ushort>::max(),std::numeric_limits<ushort>::max()),
       br(std::numeric_limits<ushort>::min(),std::numeric_limits<ushort>::min()),
       area(0),
-      mean(Eigen::Vector2f::Zero())
-//    covar(Eigen::Matrix2f::Zero()
+      mean(Eigen::Vector2f::Zero()),
+      covar(Eigen::Matrix2f::Zero())
   {}
 
   inline Blob::Blob(ImagePos const& _ul, ImagePos const& _br,
                     unsigned _area,
-                    Eigen::Vector2f _mean, //Eigen::Matrix2f _covar,
+                    Eigen::Vector2f _mean, Eigen::Matrix2f _covar,
                     std::set<Run> const& _runs)
     : ul(_ul),
       br(_br),
       area(_area),
       mean(_mean),
-//    covar(_covar),
+      covar(_covar),
       runs(_runs)
   {}
 
@@ -295,9 +454,34 @@ namespace bold
     return ImageBounds(ul, br);
   }
 
+  inline float Blob::orientation() const
+  {
+    return 0.5f * std::atan2(2 * covar(0,1), covar(0,0) - covar(1,1));
+  }
+
+  inline float Blob::eccentricity() const
+  {
+    // Eigenvalues of the covariance are the variances along the principal axes
+    float halfTrace = (covar(0,0) + covar(1,1)) / 2;
+    float halfDiff = (covar(0,0) - covar(1,1)) / 2;
+    float offset = std::sqrt(halfDiff * halfDiff + covar(0,1) * covar(0,1));
+    float major = halfTrace + offset;
+    float minor = halfTrace - offset;
+
+    if (major <= 0)
+      return 0;
+
+    return std::sqrt(std::max(0.0f, 1 - minor / major));
+  }
+
   inline void Blob::merge(Blob& other)
   {
     ASSERT(other.area != 0);
+    // Pool covariances, adding the spread between the two means
+    Eigen::Vector2f meanDiff = mean - other.mean;
+    float total = area + other.area;
+    covar = (covar * area + other.covar * other.area) / total
+      + (meanDiff * meanDiff.transpose()) * (area * (other.area / (total * total)));
     mean = ((mean * area) + (other.mean * other.area)) / (area + other.area);
     area += other.area;
     // TODO can we do this more nicely using Eigen?
@@ -311,6 +495,18 @@ namespace bold
       br.y() = other.br.y();
   }
 
+  inline void Blob::translate(ImagePos const& offset)
+  {
+    ul += offset;
+    br += offset;
+    mean += offset.cast<float>();
+
+    std::set<Run> translatedRuns;
+    for (Run const& run : runs)
+      translatedRuns.insert(translatedRuns.end(), Run(run.startX + offset.x(), run.endX + offset.x(), run.y + offset.y()));
+    runs = std::move(translatedRuns);
+  }
+
   inline bool Blob::operator<(Blob const& other) const
   {
     return
@@ -9,57 +9,88 @@ map<shared_ptr<PixelLabel>,vector<Blob>> const& BlobDetectPass::detectBlobs(Sequ
     return d_blobsDetectedPerLabel;
 
   // For each label that we're configured to look at
-  for (auto pixelLabel : d_pixelLabels)
+  for (unsigned slot = 0; slot < d_pixelLabels.size(); ++slot)
   {
+    auto const& pixelLabel = d_pixelLabels[slot];
     timer.enter(pixelLabel->getName());
-    auto pixelLabelId = (uint8_t)pixelLabel->getID();
 
-    // Go through all runs and add them to the disjoint set
+    detectBlobs(d_runs.data() + slot * d_runCapacity,
+                d_rowRunStarts.data() + slot * (d_rowCapacity + 1),
+                d_rowIndices.size(),
+                d_collectRunsBySlot[slot],
+                d_blobsDetectedPerLabel[pixelLabel],
+                timer);
 
-    // RunSets; one set of runSets for each label, each blob is a set of runs
+    timer.exit();
+  }
 
-    RunLengthCode& runsPerRow = d_runsPerRowPerLabel[pixelLabelId];
+  return d_blobsDetectedPerLabel;
+}
 
-    DisjointSet<Run> rSet;
+void BlobDetectPass::detectBlobs(Run const* runs, unsigned const* rowRunStarts, unsigned rowCount, bool collectRuns, vector<Blob>& blobs, SequentialTimer& timer)
+{
+  unsigned runCount = rowRunStarts[rowCount];
 
-    // Just insert all runs of first (bottom) row
-    for (Run const& run : runsPerRow[d_rowIndices[0]])
-      rSet.insert(run);
+  // Each run starts out as its own set, with stats for just itself
+  d_runParents.resize(runCount);
+  d_runSetStats.resize(runCount);
+  for (unsigned index = 0; index < runCount; ++index)
+  {
+    d_runParents[index] = index;
+    d_runSetStats[index] = RunSetStats::fromRun(runs[index]);
+  }
 
-    // From the second row on...
-    for (unsigned i = 1; i < d_rowIndices.size(); ++i)
-    {
-      unsigned y = d_rowIndices[i];
+  timer.timeEvent("Initialise Runs");
 
-      for (Run& run : runsPerRow[y])
-      {
-        rSet.insert(run);
+  // Join overlapping runs in adjacent rows. Both rows are ordered by x and
+  // their runs do not overlap each other, so a single sweep finds all pairs.
+  for (unsigned i = 1; i < rowCount; ++i)
+  {
+    unsigned p = rowRunStarts[i - 1];
+    unsigned r = rowRunStarts[i];
+    unsigned const previousRowEnd = rowRunStarts[i];
+    unsigned const rowEnd = rowRunStarts[i + 1];
 
-        // Attempt to merge this run with runs in the row above
-        for (Run& run2 : runsPerRow[d_rowIndices[i - 1]])
-          if (run.overlaps(run2))
-            rSet.merge(run, run2);
-      }
+    while (p < previousRowEnd && r < rowEnd)
+    {
+      if (runs[r].overlaps(runs[p]))
+        unite(r, p);
+
+      // Advance whichever run finishes first, as it can overlap nothing further
+      if (runs[p].endX < runs[r].endX)
+        ++p;
+      else
+        ++r;
     }
+  }
 
-    timer.timeEvent("Build Run Set");
+  timer.timeEvent("Join Runs");
 
-    set<set<Run>> runSets = rSet.getSubSets();
+  blobs.clear();
 
-    timer.timeEvent("Get SubSets");
+  // Roots are the first run of their set, so this visits blobs in order of
+  // their first run
+  d_blobIndices.resize(runCount);
+  for (unsigned index = 0; index < runCount; ++index)
+  {
+    if (d_runParents[index] != index)
+      continue;
 
-    auto& blobSet = d_blobsDetectedPerLabel[pixelLabel];
-    blobSet.clear();
+    d_blobIndices[index] = blobs.size();
+    blobs.push_back(d_runSetStats[index].toBlob());
+  }
 
-    // Convert sets of run-sets to sets of blob
-    transform(runSets.begin(), runSets.end(),
-              inserter(blobSet, blobSet.end()),
-              runSetToBlob);
+  timer.timeEvent("Convert");
 
-    timer.timeEvent("Convert");
+  if (collectRuns)
+  {
+    // Runs are visited in order, so each insertion is at the end of its set
+    for (unsigned index = 0; index < runCount; ++index)
+    {
+      auto& blobRuns = blobs[d_blobIndices[findRoot(index)]].runs;
+      blobRuns.insert(blobRuns.end(), runs[index]);
+    }
 
-    timer.exit();
+    timer.timeEvent("Collect Runs");
   }
-
-  return d_blobsDetectedPerLabel;
 }
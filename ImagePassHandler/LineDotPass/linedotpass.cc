@@ -1,10 +1,14 @@
 #include "linedotpass.hh"
 
+#include "../FieldEdgePass/fieldedgepass.hh"
 #include "../../Config/config.hh"
 #include "../../ImageLabelData/imagelabeldata.hh"
 #include "../../PixelLabel/pixellabel.hh"
 #include "../../SequentialTimer/sequentialtimer.hh"
 
+#include <algorithm>
+#include <limits>
+
 using namespace bold;
 using namespace std;
 
@@ -14,57 +18,84 @@ LineDotPass::LineDotPass(ushort imageWidth, shared_ptr<PixelLabel> inLabel, shar
     d_imageWidth(imageWidth),
     d_inLabel(inLabel),
     d_onLabel(onLabel),
+    d_fieldEdgePass(),
+    d_rowTracker((uint8_t)inLabel->getID(), (uint8_t)onLabel->getID(), 0),
+    d_maxYByX(imageWidth, numeric_limits<ushort>::max()),
     d_lastXGranularity(-1)
 {
   auto hysteresisLimit = Config::getSetting<int>("vision.line-detection.line-dots.hysteresis");
+  d_fieldEdgeMargin = Config::getSetting<int>("vision.line-detection.line-dots.field-edge-margin");
 
   // Create trackers
 
+  d_rowTracker.setHysteresisLimit(hysteresisLimit->getValue());
+
   d_colTrackers = vector<bold::LineRunTracker>();
 
-  for (ushort x = 0; x <= imageWidth; ++x)
-  {
-    d_colTrackers.emplace_back(
-      (uint8_t)inLabel->getID(), (uint8_t)onLabel->getID(), /*otherCoordinate*/x, hysteresisLimit->getValue(),
-      [this](ushort const from, ushort const to, ushort const other) mutable {
-        int mid = (from + to) / 2;
-        lineDots.emplace_back((int)other, mid);
-      }
-    );
-  }
+  for (ushort x = 0; x < imageWidth; ++x)
+    d_colTrackers.emplace_back((uint8_t)inLabel->getID(), (uint8_t)onLabel->getID(), hysteresisLimit->getValue());
 
-  d_rowTracker = make_unique<LineRunTracker>(
-    (uint8_t)inLabel->getID(), (uint8_t)onLabel->getID(), /*otherCoordinate*/0, hysteresisLimit->getValue(),
-    [this](ushort const from, ushort const to, ushort const other) mutable {
-      int mid = (from + to) / 2;
-      lineDots.emplace_back(mid, (int)other);
-    }
-  );
+  // Dots are appended directly to this buffer. Its capacity is kept between
+  // frames, so it only reallocates when a frame has more dots than any before.
+  lineDots.reserve(imageWidth * 4);
 
   // Create controls
 
   hysteresisLimit->changed.connect([this](int const& value) mutable
   {
-    d_rowTracker->setHysteresisLimit(value);
+    d_rowTracker.setHysteresisLimit(value);
 
     for (LineRunTracker& colTracker : d_colTrackers)
       colTracker.setHysteresisLimit(value);
   });
 }
 
+void LineDotPass::setFieldEdgePass(shared_ptr<FieldEdgePass> fieldEdgePass)
+{
+  d_fieldEdgePass = fieldEdgePass;
+
+  if (fieldEdgePass)
+    setDependencies({ fieldEdgePass.get() });
+  else
+    setDependencies({});
+}
+
 void LineDotPass::process(ImageLabelData const& labelData, SequentialTimer& timer)
 {
   // reset all run trackers
-  d_rowTracker->reset();
+  d_rowTracker.reset();
   for (ushort x = 0; x < d_imageWidth; ++x)
     d_colTrackers[x].reset();
   lineDots.clear();
   timer.timeEvent("Clear");
 
+  // Line dots are only searched for at or below the field edge (plus a
+  // margin, as the edge is smoothed). Remember that the image appears upside
+  // down, so these are the pixels with lower y values.
+  ushort maxY = numeric_limits<ushort>::max();
+  if (d_fieldEdgePass)
+  {
+    int margin = d_fieldEdgeMargin->getValue();
+    maxY = 0;
+    for (ushort x = 0; x < d_imageWidth; ++x)
+    {
+      d_maxYByX[x] = (ushort)min<int>(d_fieldEdgePass->getEdgeYValue(x) + margin, numeric_limits<ushort>::max());
+      maxY = max(maxY, d_maxYByX[x]);
+    }
+    timer.timeEvent("Field Edge");
+  }
+  else
+  {
+    fill(d_maxYByX.begin(), d_maxYByX.end(), maxY);
+  }
+
   for (auto const& row : labelData)
   {
-    d_rowTracker->reset();
-    d_rowTracker->otherCoordinate = row.imageY;
+    // Rows are ordered by increasing y, so no later row is below the field edge either
+    if (row.imageY > maxY)
+      break;
+
+    d_rowTracker.reset();
 
     // *   *   *   *   *   *   *   *   *   *   *   *   * 4
     // *   *   *   *   *   *   *   *   *   *   *   *   * 4
@@ -102,9 +133,21 @@ void LineDotPass::process(ImageLabelData const& labelData, SequentialTimer& time
 
     for (auto const& label : row)
     {
-      d_rowTracker->update(label, x);
-      d_colTrackers[x].update(label, row.imageY);
+      if (row.imageY > d_maxYByX[x])
+      {
+        // Above the field edge. Columns stop here, and runs along the row
+        // may not bridge across this pixel.
+        d_rowTracker.reset();
+      }
+      else
+      {
+        if (d_rowTracker.update(label, x))
+          lineDots.emplace_back((d_rowTracker.getRunStart() + x) / 2, (int)row.imageY);
+        if (d_colTrackers[x].update(label, row.imageY))
+          lineDots.emplace_back((int)x, (d_colTrackers[x].getRunStart() + row.imageY) / 2);
+      }
       x += row.granularity.x();
     }
   }
+  timer.timeEvent("Process Rows");
 }
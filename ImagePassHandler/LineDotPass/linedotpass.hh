@@ -11,15 +11,28 @@
 
 namespace bold
 {
+  class FieldEdgePass;
   class PixelLabel;
   class ImageLabelData;
   class SequentialTimer;
+  template<typename> class Setting;
 
   class LineDotPass : public ImagePassHandler
   {
   public:
     LineDotPass(ushort imageWidth, std::shared_ptr<PixelLabel> inLabel, std::shared_ptr<PixelLabel> onLabel);
 
+    /** Limits the search for line dots to pixels below the field edge.
+     *
+     * The field edge pass becomes a dependency of this pass. If null, the
+     * whole image is searched.
+     *
+     * process reads the field edge pass without locking, so while this pass is
+     * held by an ImagePassRunner, call this only from the configure function
+     * given to ImagePassRunner::replaceHandler.
+     */
+    void setFieldEdgePass(std::shared_ptr<FieldEdgePass> fieldEdgePass);
+
     void process(ImageLabelData const& labelData, SequentialTimer& timer) override;
 
     std::vector<Eigen::Vector2i> lineDots;
@@ -28,8 +41,12 @@ namespace bold
     const ushort d_imageWidth;
     std::shared_ptr<PixelLabel> d_inLabel;
     std::shared_ptr<PixelLabel> d_onLabel;
-    std::unique_ptr<LineRunTracker> d_rowTracker;
-    std::vector<bold::LineRunTracker> d_colTrackers;
+    std::shared_ptr<FieldEdgePass> d_fieldEdgePass;
+    Setting<int>* d_fieldEdgeMargin;
+    LineRunTracker d_rowTracker;
+    std::vector<LineRunTracker> d_colTrackers;
+    // Highest y value searched in each column, taken from the field edge
+    std::vector<ushort> d_maxYByX;
     int d_lastXGranularity;
   };
 }
@@ -2,6 +2,9 @@
 
 #include <Eigen/Core>
 
+#include <string>
+#include <vector>
+
 namespace bold
 {
   class ImageLabelData;
@@ -24,7 +27,23 @@ namespace bold
 
     std::string const& id() const { return d_id; };
 
+    /** Handlers whose results this handler reads while processing.
+     *
+     * When run by the same ImagePassRunner, these are processed first. A
+     * runner reads dependencies when its handlers are added or removed, so
+     * they should be set before then.
+     *
+     * Only inputs are declared. Results are read from the handlers directly,
+     * by the dependent handlers and by the handlers' owner once the pass has
+     * completed.
+     */
+    std::vector<ImagePassHandler const*> const& getDependencies() const { return d_dependencies; }
+
+  protected:
+    void setDependencies(std::vector<ImagePassHandler const*> dependencies) { d_dependencies = std::move(dependencies); }
+
   private:
     std::string d_id;
+    std::vector<ImagePassHandler const*> d_dependencies;
   };
 }
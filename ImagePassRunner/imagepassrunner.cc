@@ -3,17 +3,31 @@
 #include "../ImagePassHandler/imagepasshandler.hh"
 #include "../ImageLabelData/imagelabeldata.hh"
 #include "../SequentialTimer/sequentialtimer.hh"
+#include "../State/state.hh"
+#include "../StateObject/ImagePassScheduleState/imagepassschedulestate.hh"
+#include "../util/log.hh"
+#include "../util/workerpool.hh"
+
+#include <algorithm>
 
 using namespace bold;
 using namespace std;
 
+ImagePassRunner::ImagePassRunner(shared_ptr<WorkerPool> workerPool)
+  : d_parallel(false),
+    d_workerPool(move(workerPool))
+{}
+
 void ImagePassRunner::addHandler(std::shared_ptr<ImagePassHandler> handler)
 {
   ASSERT(handler);
 
   lock_guard<mutex> guard(d_handlerMutex);
   if (std::find(d_handlers.begin(), d_handlers.end(), handler) == d_handlers.end())
-    d_handlers.insert(handler);
+  {
+    d_handlers.push_back(handler);
+    buildSchedule();
+  }
 }
 
 /** Removes the specified handler, if it already exists in the runner.
@@ -23,10 +37,13 @@ void ImagePassRunner::removeHandler(std::shared_ptr<ImagePassHandler> handler)
   ASSERT(handler);
 
   lock_guard<mutex> guard(d_handlerMutex);
-  auto it = d_handlers.find(handler);
+  auto it = std::find(d_handlers.begin(), d_handlers.end(), handler);
 
   if (it != d_handlers.end())
+  {
     d_handlers.erase(it);
+    buildSchedule();
+  }
 }
 
 /** Adds or removes the specified handler, depending upon the bool 'enabled' parameter.
@@ -41,15 +58,143 @@ void ImagePassRunner::setHandler(std::shared_ptr<ImagePassHandler> handler, bool
     removeHandler(handler);
 }
 
+void ImagePassRunner::replaceHandler(shared_ptr<ImagePassHandler> oldHandler, shared_ptr<ImagePassHandler> newHandler,
+                                     function<void()> const& configure)
+{
+  ASSERT(newHandler);
+
+  // Passes hold this lock throughout, so none sees a partial change
+  lock_guard<mutex> guard(d_handlerMutex);
+
+  if (configure)
+    configure();
+
+  auto it = std::find(d_handlers.begin(), d_handlers.end(), oldHandler);
+  if (it != d_handlers.end())
+    d_handlers.erase(it);
+
+  if (std::find(d_handlers.begin(), d_handlers.end(), newHandler) == d_handlers.end())
+    d_handlers.push_back(newHandler);
+
+  buildSchedule();
+}
+
 /** Passes over the image, calling out to all ImagePassHandlers with data from the image.
 */
 void ImagePassRunner::pass(ImageLabelData const& labelData, SequentialTimer& timer) const
 {
   lock_guard<mutex> guard(d_handlerMutex);
+
+  if (d_parallel && d_workerPool && d_workerPool->getConcurrency() > 1 && d_handlers.size() > 1)
+    passParallel(labelData, timer);
+  else
+    passSerial(labelData, timer);
+}
+
+vector<vector<string>> ImagePassRunner::getSchedule() const
+{
+  lock_guard<mutex> guard(d_handlerMutex);
+
+  vector<vector<string>> schedule;
+  for (auto const& stage : d_stages)
+  {
+    schedule.emplace_back();
+    for (auto handler : stage)
+      schedule.back().push_back(handler->id());
+  }
+  return schedule;
+}
+
+void ImagePassRunner::buildSchedule()
+{
+  vector<ImagePassHandler*> remaining;
+  remaining.reserve(d_handlers.size());
   for (auto const& handler : d_handlers)
+    remaining.push_back(handler.get());
+
+  auto isRemaining = [&remaining](ImagePassHandler const* handler)
+  {
+    return find(remaining.begin(), remaining.end(), handler) != remaining.end();
+  };
+
+  d_stages.clear();
+  while (!remaining.empty())
+  {
+    // Handlers whose dependencies have all been scheduled, or are not held by this runner
+    vector<ImagePassHandler*> stage;
+    for (auto handler : remaining)
+    {
+      auto const& dependencies = handler->getDependencies();
+      if (none_of(dependencies.begin(), dependencies.end(), isRemaining))
+        stage.push_back(handler);
+    }
+
+    if (stage.empty())
+    {
+      log::error("ImagePassRunner::buildSchedule") << "Cyclic dependency between " << remaining.size() << " handlers";
+      stage = remaining;
+    }
+
+    for (auto handler : stage)
+      remaining.erase(find(remaining.begin(), remaining.end(), handler));
+
+    d_stages.push_back(move(stage));
+  }
+
+  // Publish the schedule, naming only those dependencies which this runner holds
+  vector<vector<ImagePassScheduleState::Entry>> stages;
+  for (auto const& stage : d_stages)
+  {
+    stages.emplace_back();
+    for (auto handler : stage)
+    {
+      ImagePassScheduleState::Entry entry;
+      entry.id = handler->id();
+      for (auto dependency : handler->getDependencies())
+      {
+        if (any_of(d_handlers.begin(), d_handlers.end(), [dependency](shared_ptr<ImagePassHandler> const& h) { return h.get() == dependency; }))
+          entry.dependencies.push_back(dependency->id());
+      }
+      stages.back().push_back(move(entry));
+    }
+  }
+  State::make<ImagePassScheduleState>(move(stages));
+}
+
+void ImagePassRunner::passSerial(ImageLabelData const& labelData, SequentialTimer& timer) const
+{
+  for (auto const& stage : d_stages)
   {
-    timer.enter(handler->id());
-    handler->process(labelData, timer);
-    timer.exit();
+    for (auto handler : stage)
+    {
+      timer.enter(handler->id());
+      handler->process(labelData, timer);
+      timer.exit();
+    }
   }
 }
+
+void ImagePassRunner::passParallel(ImageLabelData const& labelData, SequentialTimer& timer) const
+{
+  // Handlers only read the label data, and each writes only its own state,
+  // so handlers within a stage may run concurrently. SequentialTimer is not
+  // thread safe, so each handler records its events with its own timer.
+  timer.enter("Parallel");
+
+  for (auto const& stage : d_stages)
+  {
+    vector<SequentialTimer> timers(stage.size());
+
+    d_workerPool->run(stage.size(), [&stage,&timers,&labelData](unsigned i)
+    {
+      timers[i].enter(stage[i]->id());
+      stage[i]->process(labelData, timers[i]);
+      timers[i].exit();
+    });
+
+    for (auto& handlerTimer : timers)
+      timer.append(*handlerTimer.flush());
+  }
+
+  timer.exit();
+}
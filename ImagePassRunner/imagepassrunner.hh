@@ -1,25 +1,39 @@
 #pragma once
 
-#include <set>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 namespace bold
 {
   class ImageLabelData;
   class ImagePassHandler;
   class SequentialTimer;
+  class WorkerPool;
 
   class ImagePassRunner
   {
   public:
-    ImagePassRunner() = default;
+    /** Initialises a runner.
+     *
+     * @param workerPool Threads used when running handlers in parallel. If
+     *        null, handlers always run serially.
+     */
+    ImagePassRunner(std::shared_ptr<WorkerPool> workerPool = nullptr);
 
     /** Adds the specified handler, if it does not already exist in the runner.
+     *
+     * The schedule is rebuilt from the handlers' dependencies, and published
+     * as ImagePassScheduleState.
      */
     void addHandler(std::shared_ptr<ImagePassHandler> handler);
 
     /** Removes the specified handler, if it already exists in the runner.
+     *
+     * The schedule is rebuilt, as for addHandler.
      */
     void removeHandler(std::shared_ptr<ImagePassHandler> handler);
 
@@ -29,13 +43,48 @@ namespace bold
      */
     void setHandler(std::shared_ptr<ImagePassHandler> handler, bool enabled);
 
+    /** Removes one handler and adds another, with no pass running in between.
+     *
+     * configure, if given, is called first, while no pass can run. It is the
+     * place to change state which handlers read while processing, such as the
+     * handlers they depend upon. The schedule is then rebuilt once.
+     */
+    void replaceHandler(std::shared_ptr<ImagePassHandler> oldHandler, std::shared_ptr<ImagePassHandler> newHandler,
+                        std::function<void()> const& configure = nullptr);
+
+    /** Sets whether handlers run concurrently on a pool of worker threads, or one after another on the calling thread.
+     *
+     * Has no effect if the runner has no worker pool.
+     */
+    void setParallel(bool parallel) { d_parallel = parallel; }
+
     /** Passes over the image, calling out to all ImagePassHandlers with data from the image.
+     *
+     * Handlers run after any of their dependencies which this runner also
+     * holds. In parallel mode, handlers whose dependencies have completed
+     * run concurrently, and each handler's timings are recorded by its own
+     * timer and then appended to the provided timer.
      */
     void pass(ImageLabelData const& labelData, SequentialTimer& timer) const;
 
-    std::set<std::shared_ptr<ImagePassHandler>> d_handlers;
+    /** The ids of handlers in each stage of the current schedule. */
+    std::vector<std::vector<std::string>> getSchedule() const;
 
   private:
+    /** Groups handlers into stages, each depending only upon handlers in earlier stages.
+     *
+     * Must be called with d_handlerMutex held.
+     */
+    void buildSchedule();
+
+    void passSerial(ImageLabelData const& labelData, SequentialTimer& timer) const;
+    void passParallel(ImageLabelData const& labelData, SequentialTimer& timer) const;
+
+    // In the order added
+    std::vector<std::shared_ptr<ImagePassHandler>> d_handlers;
+    std::vector<std::vector<ImagePassHandler*>> d_stages;
     mutable std::mutex d_handlerMutex;
+    std::atomic<bool> d_parallel;
+    std::shared_ptr<WorkerPool> d_workerPool;
   };
 }
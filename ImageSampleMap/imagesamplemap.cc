@@ -6,7 +6,8 @@ using namespace std;
 
 ImageSampleMap::ImageSampleMap(function<Matrix<uchar, 2, 1>(ushort)> granularityFunction, ushort width, ushort height)
   : d_granularities(),
-    d_width(width)
+    d_width(width),
+    d_height(height)
 {
   unsigned pixelCount = 0;
   ushort y = 0;
@@ -23,6 +23,9 @@ namespace bold
 
     unsigned getPixelCount() const { return d_pixelCount; }
 
+    ushort getWidth() const { return d_width; }
+    ushort getHeight() const { return d_height; }
+
     ushort getSampleRowCount() const { return static_cast<ushort>(d_granularities.size()); }
 
     std::vector<Eigen::Matrix<uchar,2,1>>::const_iterator begin() const { return d_granularities.begin(); }
@@ -31,5 +34,6 @@ namespace bold
     std::vector<Eigen::Matrix<uchar,2,1>> d_granularities;
     unsigned d_pixelCount;
     ushort d_width;
+    ushort d_height;
   };
 }
@@ -29,7 +29,7 @@ IntegralImage IntegralImage::create(cv::Mat const& image)
     target = integral.ptr<int>(y);
     int const* above = integral.ptr<int const>(y - 1);
 
-    *target = *source + *above;
+    *target = *(source++) + *above;
 
     for (int x = 1; x < image.cols; x++)
     {
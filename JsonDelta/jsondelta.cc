@@ -0,0 +1,183 @@
+#include "jsondelta.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace bold;
+using namespace std;
+
+bool JsonDelta::compute(string const& base, string const& target, string& delta)
+{
+  delta.clear();
+  return computeObject(Span(base.data(), base.data() + base.size()),
+                       Span(target.data(), target.data() + target.size()),
+                       delta);
+}
+
+bool JsonDelta::computeObject(Span base, Span target, string& delta)
+{
+  vector<Member> baseMembers;
+  vector<Member> targetMembers;
+  if (!parseObject(base, baseMembers) || !parseObject(target, targetMembers))
+    return false;
+
+  auto spanEquals = [](Span a, Span b)
+  {
+    return a.second - a.first == b.second - b.first && memcmp(a.first, b.first, a.second - a.first) == 0;
+  };
+
+  // Members are usually written in the same order, so look for each one
+  // where the previous was found before searching the whole object
+  vector<bool> isBaseMemberFound(baseMembers.size(), false);
+  size_t hint = 0;
+
+  delta += '{';
+  bool isFirst = true;
+
+  for (Member const& member : targetMembers)
+  {
+    size_t index = baseMembers.size();
+    for (size_t i = 0; i < baseMembers.size(); i++)
+    {
+      size_t candidate = (hint + i) % baseMembers.size();
+      if (spanEquals(baseMembers[candidate].key, member.key))
+      {
+        index = candidate;
+        break;
+      }
+    }
+
+    Span value = member.value;
+    string childDelta;
+
+    if (index != baseMembers.size())
+    {
+      isBaseMemberFound[index] = true;
+      hint = index + 1;
+
+      Span baseValue = baseMembers[index].value;
+
+      if (spanEquals(baseValue, value))
+        continue;
+
+      if (isObject(baseValue) && isObject(value))
+      {
+        // A client merges objects, so send only what changed within them
+        if (!computeObject(baseValue, value, childDelta))
+          return false;
+        value = Span(childDelta.data(), childDelta.data() + childDelta.size());
+      }
+    }
+
+    if (!isFirst)
+      delta += ',';
+    isFirst = false;
+
+    delta.append(member.key.first, member.key.second);
+    delta += ':';
+    delta.append(value.first, value.second);
+  }
+
+  delta += '}';
+
+  // Merging cannot remove a member
+  return all_of(isBaseMemberFound.begin(), isBaseMemberFound.end(), [](bool found) { return found; });
+}
+
+bool JsonDelta::parseObject(Span span, vector<Member>& members)
+{
+  char const* pos = span.first;
+  char const* end = span.second;
+
+  if (pos == end || *pos != '{')
+    return false;
+  pos++;
+
+  if (pos != end && *pos == '}')
+    return pos + 1 == end;
+
+  while (pos != end)
+  {
+    if (*pos != '"')
+      return false;
+
+    Member member;
+    member.key.first = pos;
+    pos = skipValue(pos, end);
+    if (!pos || pos == end || *pos != ':')
+      return false;
+    member.key.second = pos;
+
+    pos++;
+    member.value.first = pos;
+    pos = skipValue(pos, end);
+    if (!pos || pos == end)
+      return false;
+    member.value.second = pos;
+
+    members.push_back(member);
+
+    if (*pos == '}')
+      return pos + 1 == end;
+    if (*pos != ',')
+      return false;
+    pos++;
+  }
+
+  return false;
+}
+
+char const* JsonDelta::skipValue(char const* pos, char const* end)
+{
+  if (pos == end)
+    return nullptr;
+
+  if (*pos == '"')
+  {
+    for (pos++; pos != end; pos++)
+    {
+      if (*pos == '\\')
+      {
+        if (++pos == end)
+          return nullptr;
+      }
+      else if (*pos == '"')
+      {
+        return pos + 1;
+      }
+    }
+    return nullptr;
+  }
+
+  if (*pos == '{' || *pos == '[')
+  {
+    int depth = 0;
+    while (pos != end)
+    {
+      if (*pos == '"')
+      {
+        pos = skipValue(pos, end);
+        if (!pos)
+          return nullptr;
+        continue;
+      }
+
+      if (*pos == '{' || *pos == '[')
+        depth++;
+      else if (*pos == '}' || *pos == ']')
+        depth--;
+
+      pos++;
+
+      if (depth == 0)
+        return pos;
+    }
+    return nullptr;
+  }
+
+  // A number, true, false or null runs until the next delimiter
+  char const* start = pos;
+  while (pos != end && *pos != ',' && *pos != '}' && *pos != ']')
+    pos++;
+  return pos == start ? nullptr : pos;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bold
+{
+  /** Computes patches between two JSON documents, for sending changes to a large object rather than the whole object.
+   *
+   * A delta is an object holding those members of the target whose values
+   * differ from the base. Clients apply it by merging: where both the delta's
+   * value and the base's value are objects, the delta is applied to the base's
+   * value recursively; otherwise the delta's value replaces the base's.
+   *
+   * Members are compared by their encoded text, so both documents must be
+   * written the same way, as they are when produced by the same writeJson.
+   * No whitespace is expected between tokens.
+   */
+  class JsonDelta
+  {
+  public:
+    /** Writes the delta that turns base into target.
+     *
+     * Returns false if no delta can express the change, because either
+     * document is not an object, or a member of an object in base is absent
+     * from target. A full copy of target must then be sent instead.
+     */
+    static bool compute(std::string const& base, std::string const& target, std::string& delta);
+
+  private:
+    JsonDelta() = delete;
+
+    typedef std::pair<char const*, char const*> Span;
+
+    struct Member
+    {
+      Span key;
+      Span value;
+    };
+
+    static bool computeObject(Span base, Span target, std::string& delta);
+
+    /** Splits an object's text into its members. Returns false if span does not hold an object. */
+    static bool parseObject(Span span, std::vector<Member>& members);
+
+    /** Returns the end of the value starting at pos, or nullptr if the text is malformed. */
+    static char const* skipValue(char const* pos, char const* end);
+
+    static bool isObject(Span span) { return span.first != span.second && *span.first == '{'; }
+  };
+}
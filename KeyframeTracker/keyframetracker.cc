@@ -0,0 +1,74 @@
+#include "keyframetracker.hh"
+
+#include "../util/assert.hh"
+
+#include <algorithm>
+
+using namespace bold;
+using namespace std;
+
+KeyframeTracker::KeyframeTracker()
+  : d_unacknowledged(),
+    d_acknowledged(),
+    d_deltasSinceKeyframe(0)
+{}
+
+void KeyframeTracker::reset()
+{
+  d_unacknowledged.clear();
+  d_acknowledged = Keyframe();
+  d_deltasSinceKeyframe = 0;
+}
+
+KeyframeTracker::Keyframe const* KeyframeTracker::getAwaitedKeyframe(Clock::Timestamp now, double timeoutSeconds) const
+{
+  if (d_unacknowledged.empty())
+    return nullptr;
+
+  SentKeyframe const& latest = d_unacknowledged.back();
+
+  if (now >= latest.sentAt && Clock::timestampToSeconds(now - latest.sentAt) >= timeoutSeconds)
+    return nullptr;
+
+  return &latest.keyframe;
+}
+
+bool KeyframeTracker::isKeyframeDue(unsigned keyframeInterval, Clock::Timestamp now, double timeoutSeconds) const
+{
+  if (!d_acknowledged.json)
+    return true;
+
+  return d_deltasSinceKeyframe >= keyframeInterval && getAwaitedKeyframe(now, timeoutSeconds) == nullptr;
+}
+
+void KeyframeTracker::keyframeSent(Keyframe keyframe, Clock::Timestamp now)
+{
+  ASSERT(keyframe.json);
+
+  // Sending the awaited keyframe again changes nothing
+  if (!d_unacknowledged.empty() && d_unacknowledged.back().keyframe.id == keyframe.id)
+    return;
+
+  // New keyframes are only sent once the last has timed out, so those kept
+  // here span several timeouts, allowing for acknowledgements that arrive late
+  const size_t MaxUnacknowledgedKeyframes = 8;
+
+  d_unacknowledged.push_back({move(keyframe), now});
+  if (d_unacknowledged.size() > MaxUnacknowledgedKeyframes)
+    d_unacknowledged.pop_front();
+
+  d_deltasSinceKeyframe = 0;
+}
+
+bool KeyframeTracker::acknowledge(long long unsigned id)
+{
+  auto it = find_if(d_unacknowledged.begin(), d_unacknowledged.end(),
+                    [id](SentKeyframe const& sent) { return sent.keyframe.id == id; });
+
+  if (it == d_unacknowledged.end())
+    return false;
+
+  d_acknowledged = move(it->keyframe);
+  d_unacknowledged.erase(d_unacknowledged.begin(), it + 1);
+  return true;
+}
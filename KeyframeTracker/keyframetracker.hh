@@ -0,0 +1,75 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "../Clock/clock.hh"
+
+namespace bold
+{
+  /** Tracks the keyframes sent to a client receiving deltas, and which of them the client has acknowledged.
+   *
+   * Deltas are computed against the latest acknowledged keyframe. While a
+   * keyframe awaits acknowledgement, no new one is due, so that a client whose
+   * acknowledgements lag by several updates is not sent a fresh keyframe with
+   * each of them. A keyframe not acknowledged within the timeout is presumed
+   * lost, and a new one becomes due, though a late acknowledgement of it is
+   * still accepted.
+   */
+  class KeyframeTracker
+  {
+  public:
+    struct Keyframe
+    {
+      /// Identifies the keyframe in messages to and from the client
+      long long unsigned id;
+      std::shared_ptr<std::string const> json;
+    };
+
+    KeyframeTracker();
+
+    /** Forgets all keyframes, so that the next update is sent as a keyframe. */
+    void reset();
+
+    /** The latest keyframe acknowledged by the client, against which deltas are computed, or nullptr if there is none. */
+    Keyframe const* getAcknowledgedKeyframe() const { return d_acknowledged.json ? &d_acknowledged : nullptr; }
+
+    /** The latest keyframe sent, if it is unacknowledged and was sent less than timeoutSeconds before now, otherwise nullptr.
+     *
+     * When a delta cannot be sent, the complete state should be sent without
+     * a new keyframe, as the client will acknowledge this one shortly. Until
+     * the client has acknowledged any keyframe, this one is sent again.
+     */
+    Keyframe const* getAwaitedKeyframe(Clock::Timestamp now, double timeoutSeconds) const;
+
+    /** Whether to send a keyframe rather than a delta.
+     *
+     * This is so when none is acknowledged, or keyframeInterval deltas have
+     * been sent since the last and no keyframe is awaited.
+     */
+    bool isKeyframeDue(unsigned keyframeInterval, Clock::Timestamp now, double timeoutSeconds) const;
+
+    void keyframeSent(Keyframe keyframe, Clock::Timestamp now);
+    void deltaSent() { d_deltasSinceKeyframe++; }
+
+    /** Records that the client holds the given keyframe, so that later deltas may be computed against it.
+     *
+     * Returns false, ignoring the acknowledgement, if the keyframe is unknown
+     * or older than one already acknowledged.
+     */
+    bool acknowledge(long long unsigned id);
+
+  private:
+    struct SentKeyframe
+    {
+      Keyframe keyframe;
+      Clock::Timestamp sentAt;
+    };
+
+    /// Keyframes sent but not yet acknowledged, oldest first
+    std::deque<SentKeyframe> d_unacknowledged;
+    Keyframe d_acknowledged;
+    unsigned d_deltasSinceKeyframe;
+  };
+}
@@ -1,58 +1,113 @@
 #include "lutbuilder.hh"
 
+#include <atomic>
+
+#include "../util/workerpool.hh"
+
 using namespace bold;
 using namespace std;
 
-shared_ptr<uchar const> LUTBuilder::buildLookUpTableBGR24(vector<shared_ptr<PixelLabel>> const& labels)
+namespace
 {
-  uchar* lut = new uchar[1<<24];
-  uchar* p = lut;
+  // Returns the HSV colour of a LUT cell, given its channel values
+  Colour::hsv cellHsv(LUTColourSpace colourSpace, uchar bitsPerChannel, unsigned index, uchar c0, uchar c1, uchar c2)
+  {
+    if (colourSpace == LUTColourSpace::BGR)
+      return Colour::bgr2hsv(Colour::bgr(c0, c1, c2));
+
+    // Precomputed tables cover the default and full resolutions
+    if (bitsPerChannel == 6)
+      return Colour::yCbCr2hsv18Table()[index];
+    if (bitsPerChannel == 8)
+      return Colour::yCbCr2hsv24(Colour::YCbCr(c0, c1, c2));
+
+    // TODO should we use the floating point conversion from YCbCr to BGR here for accuracy?
+    return Colour::bgr2hsv(Colour::YCbCr(c0, c1, c2).toBgrInt());
+  }
+
+  // Calls visit(index, hsv) for every cell of a LUT. Each plane of the first
+  // channel is independent, so bands of planes are spread across the worker
+  // pool if given.
+  template<typename TVisit>
+  void visitCells(LookUpTable const& lut, WorkerPool* workerPool, TVisit const& visit)
+  {
+    LUTColourSpace const colourSpace = lut.getColourSpace();
+    uchar const bits = lut.getBitsPerChannel();
+    unsigned const channelSize = 1u << bits;
+    uchar const shift = 8 - bits;
+
+    auto visitPlanes = [&visit,colourSpace,bits,channelSize,shift](unsigned begin, unsigned end)
+    {
+      unsigned index = begin << (2 * bits);
+      for (unsigned c0 = begin; c0 < end; ++c0)
+        for (unsigned c1 = 0; c1 < channelSize; ++c1)
+          for (unsigned c2 = 0; c2 < channelSize; ++c2, ++index)
+            visit(index, cellHsv(colourSpace, bits, index, c0 << shift, c1 << shift, c2 << shift));
+    };
 
-  for (int b = 0; b < 256; ++b)
-    for (int g = 0; g < 256; ++g)
-      for (int r = 0; r < 256; ++r)
-          *(p++) = labelPixel(labels, Colour::bgr(b, g, r));
+    if (!workerPool || workerPool->getConcurrency() == 1)
+    {
+      visitPlanes(0, channelSize);
+      return;
+    }
 
-  return shared_ptr<uchar const>(lut, [](uchar const* p) { delete[] p; });
+    unsigned bandCount = workerPool->getConcurrency();
+    workerPool->run(bandCount, [&](unsigned band)
+    {
+      visitPlanes(channelSize * band / bandCount, channelSize * (band + 1) / bandCount);
+    });
+  }
 }
 
-shared_ptr<uchar const> LUTBuilder::buildLookUpTableBGR18(vector<shared_ptr<PixelLabel>> const& labels)
+shared_ptr<LookUpTable> LUTBuilder::buildLookUpTable(LUTColourSpace colourSpace, uchar bitsPerChannel,
+                                                     vector<shared_ptr<PixelLabel>> const& labels,
+                                                     WorkerPool* workerPool)
 {
-  uchar* lut = new uchar[1<<18];
-  uchar* p = lut;
+  auto lut = make_shared<LookUpTable>(colourSpace, bitsPerChannel);
+  uchar* data = lut->data();
 
-  for (int b = 0; b < 64; ++b)
-    for (int g = 0; g < 64; ++g)
-      for (int r = 0; r < 64; ++r)
-          *(p++) = labelPixel(labels, Colour::bgr(b<<2, g<<2, r<<2));
+  visitCells(*lut, workerPool, [data,&labels](unsigned index, Colour::hsv const& hsv)
+  {
+    data[index] = labelPixel(labels, hsv);
+  });
 
-  return shared_ptr<uchar const>(lut, [](uchar const* p) { delete[] p; });
+  return lut;
 }
 
-shared_ptr<uchar const> LUTBuilder::buildLookUpTableYCbCr18(vector<shared_ptr<PixelLabel>> const& labels)
+unsigned LUTBuilder::updateLookUpTable(LookUpTable& lut, vector<shared_ptr<PixelLabel>> const& labels,
+                                       Colour::hsvRange const& oldRange, Colour::hsvRange const& newRange,
+                                       WorkerPool* workerPool)
 {
-  uchar* lut = new uchar[1<<18];
-  uchar* p = lut;
+  if (oldRange == newRange)
+    return 0;
 
-  // TODO should we use the floating point conversion from YCbCr to BGR here for accuracy?
+  uchar* data = lut.data();
+  atomic<unsigned> relabelCount(0);
 
-  for (int y = 0; y < 64; ++y)
-    for (int cb = 0; cb < 64; ++cb)
-      for (int cr = 0; cr < 64; ++cr)
-          *(p++) = labelPixel(labels, Colour::YCbCr(y<<2, cb<<2, cr<<2).toBgrInt());
+  visitCells(lut, workerPool, [data,&labels,&oldRange,&newRange,&relabelCount](unsigned index, Colour::hsv const& hsv)
+  {
+    if (oldRange.contains(hsv) || newRange.contains(hsv))
+    {
+      data[index] = labelPixel(labels, hsv);
+      relabelCount.fetch_add(1, memory_order_relaxed);
+    }
+  });
 
-  return shared_ptr<uchar const>(lut, [](uchar const* p) { delete[] p; });
+  return relabelCount;
 }
 
 uchar LUTBuilder::labelPixel(vector<shared_ptr<PixelLabel>> const& labels, Colour::bgr const& bgr)
 {
-  auto const& hsv = Colour::bgr2hsv(bgr);
+  return labelPixel(labels, Colour::bgr2hsv(bgr));
+}
 
+uchar LUTBuilder::labelPixel(vector<shared_ptr<PixelLabel>> const& labels, Colour::hsv const& hsv)
+{
   // Find best matching label
   float bestProb = 0.0f;
   uint8_t bestLabel = 0u;
 
-  for (shared_ptr<PixelLabel> label : labels)
+  for (auto const& label : labels)
   {
     auto prob = label->labelProb(hsv);
     if (prob > bestProb)
@@ -4,21 +4,41 @@
 #include <memory>
 
 #include "../Colour/colour.hh"
+#include "../LookUpTable/lookuptable.hh"
 #include "../PixelLabel/pixellabel.hh"
 
 namespace bold
 {
+  class WorkerPool;
+
   class LUTBuilder
   {
   public:
-    // TODO MEMORY LEAK returning shared_ptr to the first byte won't free the whole LUT buffer
-    static std::shared_ptr<uchar const> buildLookUpTableBGR24(std::vector<std::shared_ptr<PixelLabel>> const& labels);
-    static std::shared_ptr<uchar const> buildLookUpTableBGR18(std::vector<std::shared_ptr<PixelLabel>> const& labels);
-    static std::shared_ptr<uchar const> buildLookUpTableYCbCr18(std::vector<std::shared_ptr<PixelLabel>> const& labels);
+    /** Builds a LUT in the given colour space and resolution, spreading the work across workerPool if one is provided. */
+    static std::shared_ptr<LookUpTable> buildLookUpTable(LUTColourSpace colourSpace, uchar bitsPerChannel,
+                                                         std::vector<std::shared_ptr<PixelLabel>> const& labels,
+                                                         WorkerPool* workerPool = nullptr);
+
+    /** Updates a LUT after one label's HSV range changed from oldRange to newRange.
+     *
+     * Only cells whose colour lies in either range can change label, so only
+     * those are relabelled. labels must already hold the new range. The result
+     * matches a full rebuild with the same labels.
+     *
+     * Returns the number of cells that were relabelled.
+     */
+    static unsigned updateLookUpTable(LookUpTable& lut, std::vector<std::shared_ptr<PixelLabel>> const& labels,
+                                      Colour::hsvRange const& oldRange, Colour::hsvRange const& newRange,
+                                      WorkerPool* workerPool = nullptr);
 
     /**
      * Returns the id of the first label that matches the specified BGR colour.
      */
     static uchar labelPixel(std::vector<std::shared_ptr<PixelLabel>> const& labels, Colour::bgr const& bgr);
+
+    /**
+     * Returns the id of the first label that matches the specified HSV colour.
+     */
+    static uchar labelPixel(std::vector<std::shared_ptr<PixelLabel>> const& labels, Colour::hsv const& hsv);
   };
 }
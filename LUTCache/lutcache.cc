@@ -0,0 +1,221 @@
+#include "lutcache.hh"
+
+#include "../util/log.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iomanip>
+#include <pthread.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace bold;
+using namespace std;
+
+LUTCache::LUTCache(string directory, unsigned maxEntryCount, double storeDelaySeconds)
+  : d_directory(directory),
+    d_maxEntryCount(maxEntryCount),
+    d_storeDelay(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(storeDelaySeconds))),
+    d_pending(),
+    d_stop(false)
+{
+  ASSERT(maxEntryCount > 0);
+  ASSERT(storeDelaySeconds >= 0);
+
+  d_writeThread = thread(&LUTCache::runWriteThread, this);
+}
+
+LUTCache::~LUTCache()
+{
+  {
+    lock_guard<mutex> lock(d_pendingMutex);
+    d_stop = true;
+  }
+  d_pendingCondition.notify_one();
+  d_writeThread.join();
+}
+
+void LUTCache::runWriteThread()
+{
+  pthread_setname_np(pthread_self(), "LUT Cache");
+
+  unique_lock<mutex> lock(d_pendingMutex);
+
+  while (true)
+  {
+    if (!d_pending)
+    {
+      if (d_stop)
+        return;
+      d_pendingCondition.wait(lock);
+      continue;
+    }
+
+    // Wait until stores have been quiet for the delay. Stopping writes
+    // whatever is waiting straight away, so it isn't lost.
+    if (!d_stop && chrono::steady_clock::now() < d_pendingTime + d_storeDelay)
+    {
+      d_pendingCondition.wait_until(lock, d_pendingTime + d_storeDelay);
+      continue;
+    }
+
+    unique_ptr<Entry> entry = move(d_pending);
+    lock.unlock();
+    write(entry->key, entry->lut->data(), entry->lut->getSize());
+    lock.lock();
+  }
+}
+
+string LUTCache::getKey(string const& lutType, vector<shared_ptr<PixelLabel>> const& labels)
+{
+  // Bump when the way LUT cells are computed changes, invalidating stored LUTs
+  const int formatVersion = 1;
+
+  stringstream definition;
+  definition << lutType << " " << formatVersion;
+  for (auto const& label : labels)
+  {
+    definition << "\n";
+    label->writeDefinition(definition);
+  }
+
+  // 64-bit FNV-1a
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : definition.str())
+  {
+    hash ^= (uchar)c;
+    hash *= 1099511628211ull;
+  }
+
+  stringstream key;
+  key << lutType << "-" << hex << setw(16) << setfill('0') << hash;
+  return key.str();
+}
+
+shared_ptr<LookUpTable const> LUTCache::load(string const& key, LUTColourSpace colourSpace, uchar bitsPerChannel) const
+{
+  size_t size = size_t(1) << (3 * bitsPerChannel);
+
+  int fd = open(getPath(key).c_str(), O_RDONLY);
+  if (fd == -1)
+    return nullptr;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size != size)
+  {
+    log::warning("LUTCache::load") << "Ignoring " << getPath(key) << " as its size is unexpected";
+    close(fd);
+    return nullptr;
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  // Pruning removes the entries modified longest ago, so mark this one as in use
+  if (data != MAP_FAILED && futimens(fd, nullptr) != 0)
+    log::warning("LUTCache::load") << "Unable to touch " << getPath(key) << ": " << strerror(errno);
+
+  close(fd);
+
+  if (data == MAP_FAILED)
+  {
+    log::warning("LUTCache::load") << "Unable to map " << getPath(key) << ": " << strerror(errno);
+    return nullptr;
+  }
+
+  return make_shared<LookUpTable>(colourSpace, bitsPerChannel, static_cast<uchar*>(data), [size](uchar* p) { munmap(p, size); });
+}
+
+void LUTCache::store(string const& key, shared_ptr<LookUpTable const> lut)
+{
+  {
+    lock_guard<mutex> lock(d_pendingMutex);
+    d_pending = unique_ptr<Entry>(new Entry{key, lut});
+    d_pendingTime = chrono::steady_clock::now();
+  }
+  d_pendingCondition.notify_one();
+}
+
+bool LUTCache::write(string const& key, uchar const* lut, size_t size)
+{
+  mkdir(d_directory.c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
+
+  // Write to a temporary file then rename it, so that a crash mid-write never
+  // leaves a truncated LUT under the real key
+  string path = getPath(key);
+  string tempPath = path + ".tmp";
+
+  int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd == -1)
+  {
+    log::warning("LUTCache::write") << "Unable to create " << tempPath << ": " << strerror(errno);
+    return false;
+  }
+
+  size_t written = 0;
+  while (written < size)
+  {
+    ssize_t count = ::write(fd, lut + written, size - written);
+    if (count <= 0)
+      break;
+    written += count;
+  }
+  close(fd);
+
+  if (written != size || rename(tempPath.c_str(), path.c_str()) != 0)
+  {
+    log::warning("LUTCache::write") << "Unable to write " << path;
+    unlink(tempPath.c_str());
+    return false;
+  }
+
+  log::verbose("LUTCache::write") << "Wrote " << path;
+
+  prune();
+  return true;
+}
+
+string LUTCache::getPath(string const& key) const
+{
+  return d_directory + "/" + key + ".lut";
+}
+
+void LUTCache::prune()
+{
+  DIR* dir = opendir(d_directory.c_str());
+  if (dir == nullptr)
+    return;
+
+  vector<pair<double,string>> entries;
+
+  struct dirent* ent;
+  while ((ent = readdir(dir)) != nullptr)
+  {
+    string name = ent->d_name;
+    if (name.size() < 4 || name.compare(name.size() - 4, 4, ".lut") != 0)
+      continue;
+
+    string path = d_directory + "/" + name;
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) == 0)
+      entries.emplace_back(fileStat.st_mtim.tv_sec + fileStat.st_mtim.tv_nsec / 1e9, path);
+  }
+
+  closedir(dir);
+
+  if (entries.size() <= d_maxEntryCount)
+    return;
+
+  // Newest first
+  sort(entries.begin(), entries.end(), [](pair<double,string> const& a, pair<double,string> const& b) { return a.first > b.first; });
+
+  for (unsigned i = d_maxEntryCount; i < entries.size(); i++)
+  {
+    log::verbose("LUTCache::prune") << "Removing " << entries[i].second;
+    unlink(entries[i].second.c_str());
+  }
+}
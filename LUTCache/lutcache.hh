@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../LookUpTable/lookuptable.hh"
+#include "../PixelLabel/pixellabel.hh"
+
+namespace bold
+{
+  /** Stores pixel label LUTs on disk, keyed by a hash of everything that determines their content.
+   *
+   * A LUT built once can then be mapped back into memory on later runs, rather
+   * than being rebuilt. Writes happen on a background thread, once stores
+   * have stopped for a quiet period, so that tuning a label writes only the
+   * LUT it settles on. Only the most recently written or loaded entries are
+   * kept.
+   */
+  class LUTCache
+  {
+  public:
+    LUTCache(std::string directory, unsigned maxEntryCount, double storeDelaySeconds = 0);
+
+    ~LUTCache();
+
+    /** Returns the key for a LUT of the given format (see LookUpTable::getName) built from labels, in order. */
+    static std::string getKey(std::string const& lutType, std::vector<std::shared_ptr<PixelLabel>> const& labels);
+
+    /** Maps a stored LUT into memory, or returns nullptr if no LUT of the expected size is stored under key.
+     *
+     * A hit marks the entry as recently used, so that pruning keeps it.
+     */
+    std::shared_ptr<LookUpTable const> load(std::string const& key, LUTColourSpace colourSpace, uchar bitsPerChannel) const;
+
+    /** Has the background thread write a LUT under key, once no other store has followed it for the store delay.
+     *
+     * A later store replaces one still waiting. Any waiting LUT is written
+     * when the cache is destroyed.
+     */
+    void store(std::string const& key, std::shared_ptr<LookUpTable const> lut);
+
+    /** Writes a LUT under key on the calling thread, then removes the oldest entries beyond the maximum count. */
+    bool write(std::string const& key, uchar const* lut, size_t size);
+
+  private:
+    struct Entry
+    {
+      std::string key;
+      std::shared_ptr<LookUpTable const> lut;
+    };
+
+    std::string getPath(std::string const& key) const;
+
+    void prune();
+
+    void runWriteThread();
+
+    std::string d_directory;
+    unsigned d_maxEntryCount;
+    std::chrono::steady_clock::duration d_storeDelay;
+
+    std::mutex d_pendingMutex;
+    std::condition_variable d_pendingCondition;
+    /// The LUT waiting to be written, if any
+    std::unique_ptr<Entry> d_pending;
+    std::chrono::steady_clock::time_point d_pendingTime;
+    bool d_stop;
+    std::thread d_writeThread;
+  };
+}
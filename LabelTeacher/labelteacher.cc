@@ -134,8 +134,7 @@ vector<Colour::hsv> LabelTeacher::getSamples(cv::Mat const& mask) const
       if (maskRow[j] != 0)
       {
         auto yuv = Colour::YCbCr{trainImageRow[j * 3 + 0], trainImageRow[j * 3 + 1], trainImageRow[j * 3 + 2]};
-        auto bgr = yuv.toBgrInt();
-        auto hsv = bgr2hsv(bgr);
+        auto hsv = Colour::yCbCr2hsv24(yuv);
 
         samples.push_back(hsv);
       }
@@ -238,8 +237,7 @@ void LabelTeacher::train(unsigned labelIdx, cv::Mat const& mask)
       if (maskRow[j] != 0)
       {
         auto yuv = Colour::YCbCr{trainImageRow[j * 3 + 0], trainImageRow[j * 3 + 1], trainImageRow[j * 3 + 2]};
-        auto bgr = yuv.toBgrInt();
-        auto hsv = bgr2hsv(bgr);
+        auto hsv = Colour::yCbCr2hsv24(yuv);
 
         if (d_useRange->getValue() == UseRange::XSigmas)
           if (!distRange.contains(hsv))
@@ -276,8 +274,7 @@ cv::Mat LabelTeacher::label(unsigned labelIdx) const
     for (int j = 0; j < labelImg.cols; ++j)
     {
       auto yuv = Colour::YCbCr{trainImageRow[j * 3 + 0], trainImageRow[j * 3 + 1], trainImageRow[j * 3 + 2]};
-      auto bgr = yuv.toBgrInt();
-      auto hsv = bgr2hsv(bgr);
+      auto hsv = Colour::yCbCr2hsv24(yuv);
       labelRow[j] = d_labels[labelIdx]->labelProb(hsv) * 255;
     }
   }
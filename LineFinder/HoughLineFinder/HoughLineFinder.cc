@@ -0,0 +1,30 @@
+#include "houghlinefinder.ih"
+
+HoughLineFinder::HoughLineFinder(ushort imageWidth, ushort imageHeight)
+: d_imageWidth(imageWidth),
+  d_imageHeight(imageHeight),
+  d_extractor(),
+  d_rebuildNeeded(false)
+{
+  d_thetaSteps              = Config::getSetting<int>("vision.line-detection.hough.theta-steps");
+  d_radiusResolution        = Config::getSetting<double>("vision.line-detection.hough.radius-resolution");
+  d_minVotes                = Config::getSetting<int>("vision.line-detection.hough.min-votes");
+  d_suppressionAngleDegrees = Config::getSetting<double>("vision.line-detection.hough.suppression-angle-degrees");
+  d_suppressionRadius       = Config::getSetting<double>("vision.line-detection.hough.suppression-radius");
+  d_maxDotDistance          = Config::getSetting<double>("vision.line-detection.hough.max-dot-distance");
+  d_maxGap                  = Config::getSetting<double>("vision.line-detection.hough.max-gap");
+  d_minLength               = Config::getSetting<double>("vision.line-detection.hough.min-length");
+  d_maxLineCount            = Config::getSetting<int>("vision.line-detection.hough.max-lines-returned");
+
+  // Rebuild on the next call, rather than while the accumulator may be in use
+  d_settingConnections.push_back(d_thetaSteps->changed.connect([this](int value) { d_rebuildNeeded = true; }));
+  d_settingConnections.push_back(d_radiusResolution->changed.connect([this](double value) { d_rebuildNeeded = true; }));
+
+  rebuild();
+}
+
+HoughLineFinder::~HoughLineFinder()
+{
+  for (sigc::connection& connection : d_settingConnections)
+    connection.disconnect();
+}
@@ -0,0 +1,111 @@
+#include "houghlinefinder.ih"
+
+vector<LineSegment2i> HoughLineFinder::findLineSegments(vector<Vector2i>& lineDots)
+{
+  if (d_rebuildNeeded)
+    rebuild();
+
+  // load settings values as locals
+  unsigned minVotes = max(1, d_minVotes->getValue());
+  double maxDotDistance = d_maxDotDistance->getValue();
+  double maxGap = d_maxGap->getValue();
+  double minLength = d_minLength->getValue();
+  unsigned maxLineCount = d_maxLineCount->getValue();
+
+  //
+  // Vote
+  //
+  d_accumulator->clear();
+  for (auto const& dot : lineDots)
+    d_accumulator->add(dot.x(), dot.y());
+
+  //
+  // Find peaks, strongest first, which are maximal within their neighbourhood
+  //
+  int suppressionRadiusBins = max(1, (int)round(d_suppressionRadius->getValue() / d_accumulator->getRadiusResolution()));
+  auto peaks = d_extractor.findLines(*d_accumulator, int(minVotes) - 1, Math::degToRad(d_suppressionAngleDegrees->getValue()), suppressionRadiusBins);
+
+  //
+  // Turn peaks into segments
+  //
+  d_dotUsed.assign(lineDots.size(), false);
+
+  vector<LineSegment2i> segments;
+  for (auto const& peak : peaks)
+  {
+    if (segments.size() >= maxLineCount)
+      break;
+
+    // r = x*sin(theta) + y*cos(theta)
+    double s = sin(peak.item().theta());
+    double c = cos(peak.item().theta());
+    double r = peak.item().radius();
+
+    // Gather unused dots near the line, with their position along it
+    d_lineDots.clear();
+    for (unsigned i = 0; i < lineDots.size(); i++)
+    {
+      if (d_dotUsed[i])
+        continue;
+
+      Vector2i const& dot = lineDots[i];
+      if (fabs(dot.x() * s + dot.y() * c - r) <= maxDotDistance)
+        d_lineDots.emplace_back(float(dot.x() * c - dot.y() * s), i);
+    }
+
+    if (d_lineDots.size() < minVotes)
+      continue;
+
+    sort(d_lineDots.begin(), d_lineDots.end());
+
+    // Split the dots into stretches wherever there is too large a gap. This
+    // separates collinear lines, such as the two halves of a touch line broken
+    // by the halfway line, and drops stray dots far along the line.
+    unsigned begin = 0;
+    for (unsigned end = 1; end <= d_lineDots.size() && segments.size() < maxLineCount; end++)
+    {
+      if (end != d_lineDots.size() && d_lineDots[end].first - d_lineDots[end - 1].first <= maxGap)
+        continue;
+
+      unsigned stretchBegin = begin;
+      begin = end;
+
+      if (end - stretchBegin < minVotes || d_lineDots[end - 1].first - d_lineDots[stretchBegin].first < minLength)
+        continue;
+
+      // Refit the line to the stretch's dots, as the peak is only as precise as its bin
+      Vector2d mean = Vector2d::Zero();
+      for (unsigned i = stretchBegin; i < end; i++)
+        mean += lineDots[d_lineDots[i].second].cast<double>();
+      mean /= end - stretchBegin;
+
+      Matrix2d covar = Matrix2d::Zero();
+      for (unsigned i = stretchBegin; i < end; i++)
+      {
+        Vector2d offset = lineDots[d_lineDots[i].second].cast<double>() - mean;
+        covar += offset * offset.transpose();
+      }
+
+      double angle = 0.5 * atan2(2 * covar(0,1), covar(0,0) - covar(1,1));
+      Vector2d direction(cos(angle), sin(angle));
+
+      double minT = numeric_limits<double>::max();
+      double maxT = numeric_limits<double>::lowest();
+      for (unsigned i = stretchBegin; i < end; i++)
+      {
+        unsigned dotIndex = d_lineDots[i].second;
+        double t = (lineDots[dotIndex].cast<double>() - mean).dot(direction);
+        minT = min(minT, t);
+        maxT = max(maxT, t);
+        d_dotUsed[dotIndex] = true;
+      }
+
+      Vector2d p1 = mean + direction * minT;
+      Vector2d p2 = mean + direction * maxT;
+      segments.emplace_back(Vector2i(round(p1.x()), round(p1.y())),
+                            Vector2i(round(p2.x()), round(p2.y())));
+    }
+  }
+
+  return segments;
+}
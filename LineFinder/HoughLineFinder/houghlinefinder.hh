@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <Eigen/Core>
+#include <sigc++/connection.h>
+
+#include "../../geometry/LineSegment/LineSegment2/LineSegment2i/linesegment2i.hh"
+#include "../../HoughLineExtractor/houghlineextractor.hh"
+#include "../linefinder.hh"
+
+namespace bold
+{
+  template<typename> class Setting;
+
+  /** Finds lines by voting with line dots in a fixed point Hough accumulator.
+   *
+   * Peaks which survive non-maximum suppression are taken in order of votes.
+   * Each is turned into segments from the dots lying close to it: the
+   * stretches of dots between large gaps are each refit by least squares,
+   * and those dots are then unavailable to later peaks. This stops the many
+   * peaks around a thick or curved line producing duplicate segments.
+   */
+  class HoughLineFinder : public LineFinder
+  {
+  public:
+    HoughLineFinder(ushort imageWidth, ushort imageHeight);
+
+    ~HoughLineFinder();
+
+    std::vector<LineSegment2i> findLineSegments(std::vector<Eigen::Vector2i>& lineDots) override;
+
+  private:
+    void rebuild();
+
+    ushort d_imageWidth;
+    ushort d_imageHeight;
+
+    // Accumulator resolution
+    Setting<int>* d_thetaSteps;
+    Setting<double>* d_radiusResolution;
+    // Minimum votes for a peak, and for the dots supporting a segment
+    Setting<int>* d_minVotes;
+    // Neighbourhood within which peaks must be maximal
+    Setting<double>* d_suppressionAngleDegrees;
+    Setting<double>* d_suppressionRadius;
+    // Maximum distance of a dot from a peak's line for it to support a segment
+    Setting<double>* d_maxDotDistance;
+    // Maximum gap between consecutive dots along a segment
+    Setting<double>* d_maxGap;
+    Setting<double>* d_minLength;
+    Setting<int>* d_maxLineCount;
+
+    std::unique_ptr<HoughLineAccumulator> d_accumulator;
+    HoughLineExtractor d_extractor;
+    /// Set on the thread that changed a setting, and read on the one finding lines
+    std::atomic<bool> d_rebuildNeeded;
+    /// Connections to setting changes, as this finder may be destroyed before its settings
+    std::vector<sigc::connection> d_settingConnections;
+
+    // Working storage, reused between calls
+    std::vector<bool> d_dotUsed;
+    std::vector<std::pair<float,unsigned>> d_lineDots;
+  };
+}
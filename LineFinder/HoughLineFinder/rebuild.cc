@@ -0,0 +1,7 @@
+#include "houghlinefinder.ih"
+
+void HoughLineFinder::rebuild()
+{
+  d_rebuildNeeded = false;
+  d_accumulator.reset(new HoughLineAccumulator(d_imageWidth, d_imageHeight, d_thetaSteps->getValue(), d_radiusResolution->getValue()));
+}
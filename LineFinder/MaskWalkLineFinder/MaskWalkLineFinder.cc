@@ -4,7 +4,8 @@ MaskWalkLineFinder::MaskWalkLineFinder()
 : d_imageWidth(Config::getStaticValue<int>("camera.image-width")),
   d_imageHeight(Config::getStaticValue<int>("camera.image-height")),
   d_mask(d_imageHeight, d_imageWidth, CV_8UC1),
-  d_trigTable()
+  d_trigTable(),
+  d_rebuildNeeded(false)
 {
   d_drThreshold         = Config::getSetting<double>("vision.line-detection.mask-walk.delta-r");
   d_dtThresholdDegs     = Config::getSetting<double>("vision.line-detection.mask-walk.delta-theta-degs");
@@ -13,8 +14,15 @@ MaskWalkLineFinder::MaskWalkLineFinder()
   d_maxLineGap          = Config::getSetting<int>("vision.line-detection.mask-walk.max-line-gap");
   d_maxLineSegmentCount = Config::getSetting<int>("vision.line-detection.mask-walk.max-lines-returned");
 
-  d_drThreshold->changed.connect([this](double value) { rebuild(); });
-  d_dtThresholdDegs->changed.connect([this](double value) { rebuild(); });
+  // Rebuild on the next call, rather than while the accumulator may be in use
+  d_settingConnections.push_back(d_drThreshold->changed.connect([this](double value) { d_rebuildNeeded = true; }));
+  d_settingConnections.push_back(d_dtThresholdDegs->changed.connect([this](double value) { d_rebuildNeeded = true; }));
 
   rebuild();
 }
+
+MaskWalkLineFinder::~MaskWalkLineFinder()
+{
+  for (sigc::connection& connection : d_settingConnections)
+    connection.disconnect();
+}
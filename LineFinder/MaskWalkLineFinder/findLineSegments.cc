@@ -2,6 +2,9 @@
 
 vector<LineSegment2i> MaskWalkLineFinder::findLineSegments(vector<Vector2i>& lineDots)
 {
+  if (d_rebuildNeeded)
+    rebuild();
+
   // IDEA instead of clearing the mask, just use a different value each time around -- clear every 255 runs
 
   // load settings values as locals
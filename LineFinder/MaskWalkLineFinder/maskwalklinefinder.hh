@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <opencv2/core/core.hpp>
 #include <Eigen/Core>
+#include <sigc++/connection.h>
 
 #include "../../geometry/LineSegment/LineSegment2/LineSegment2i/linesegment2i.hh"
 #include "../linefinder.hh"
@@ -15,6 +17,8 @@ namespace bold
   public:
     MaskWalkLineFinder();
 
+    ~MaskWalkLineFinder();
+
     void walkLine(Eigen::Vector2i const& start, float theta, bool forward, std::function<bool(int/*x*/,int/*y*/)> const& callback, uchar width = 1);
 
     std::vector<LineSegment2i> findLineSegments(std::vector<Eigen::Vector2i>& lineDots) override;
@@ -42,5 +46,10 @@ namespace bold
     int d_tSteps;
     int d_rSteps;
     std::vector<float> d_trigTable;
+
+    /// Set on the thread that changed a setting, and read on the one finding lines
+    std::atomic<bool> d_rebuildNeeded;
+    /// Connections to setting changes, as this finder may be destroyed before its settings
+    std::vector<sigc::connection> d_settingConnections;
   };
 }
@@ -2,6 +2,8 @@
 
 void MaskWalkLineFinder::rebuild()
 {
+  d_rebuildNeeded = false;
+
   auto dtThresholdRads = Math::degToRad(d_dtThresholdDegs->getValue());
   auto drThreshold = d_drThreshold->getValue();
 
@@ -2,63 +2,111 @@
 
 vector<LineSegment2i> ScanningLineFinder::findLineSegments(vector<Vector2i>& linePoints)
 {
-  SparseMatrix<bool, ColMajor> linePointsMatrix(d_cameraModel->imageHeight(), d_cameraModel->imageWidth());
-  vector<Triplet<bool>> triplets;
-  for (auto const& p : linePoints)
-    triplets.emplace_back(p.y(), p.x(), true);
-
   // Make sure all points are sorted by column first, then row
-  linePointsMatrix.setFromTriplets(begin(triplets), end(triplets));
+  sortDots(linePoints);
 
   vector<IncrementalRegression,Eigen::aligned_allocator<IncrementalRegression>> regressions;
 
   auto maxHeadDist = d_maxHeadDist->getValue();
   auto  worstFitAllowed = d_maxRMSFactor->getValue();
 
-  // Matrix is col-major, so outersize is width
-  for (unsigned k = 0; k < static_cast<unsigned>(linePointsMatrix.outerSize()); ++k)
-    // Iterate over all elements in column k
-    for (SparseMatrix<bool>::InnerIterator it(linePointsMatrix, k); it; ++it)
-    {
-      Vector2f point{it.col(), it.row()};
-      auto bestFitingRegression = regressions.end();
-      float bestFit = worstFitAllowed + 1;
+  // Bucket regressions by the band of rows their head lies in. Bands are at
+  // least maxHeadDist high, so any head within reach of a dot lies in the
+  // dot's band or a neighbouring one. Heads projected beyond the image are
+  // clamped into the outermost bands, which keeps this true. Heads which
+  // are not a number can never be reached, and are put in the first band.
+  float bandHeight = max(1.0f, float(maxHeadDist));
+  int bandCount = int(d_cameraModel->imageHeight() / bandHeight) + 1;
+  auto bandForY = [bandHeight,bandCount](float y)
+  {
+    if (!(y > 0))
+      return 0;
+    if (y >= bandCount * bandHeight)
+      return bandCount - 1;
+    return int(y / bandHeight);
+  };
+
+  d_headBuckets.resize(bandCount);
+  for (auto& bucket : d_headBuckets)
+    bucket.clear();
+  d_regressionBuckets.clear();
+
+  for (Vector2i const& dot : d_sortedDots)
+  {
+    Vector2f point = dot.cast<float>();
+    int band = bandForY(point.y());
+
+    unsigned bestFittingRegression = regressions.size();
+    float bestFit = worstFitAllowed + 1;
 
-      for (auto iter = begin(regressions); iter != end(regressions); ++iter)
+    for (int b = max(0, band - 1); b <= min(bandCount - 1, band + 1); ++b)
+    {
+      auto& bucket = d_headBuckets[b];
+      for (unsigned i = 0; i < bucket.size(); )
       {
-        auto& regression = *iter;
-        float dist = (regression.head() - point.cast<float>()).norm();
-        if (dist <= maxHeadDist)
+        unsigned index = bucket[i];
+        auto& regression = regressions[index];
+
+        // Dots arrive in column order, so a head this far behind is out of reach for good
+        if (regression.head().x() + maxHeadDist < point.x())
         {
-          //if (regression.getNPoints() > 1)
-          {
-            // Error should not be more than current RMSE
-            auto fit = regression.fit(point);
-            // only accept within 2 sigma
-            if (fit > worstFitAllowed || fit > bestFit)
-              continue;
-
-            bestFit = fit;
-            bestFitingRegression = iter;
-          }
+          bucket[i] = bucket.back();
+          bucket.pop_back();
+          continue;
         }
-      }
+        ++i;
 
-      if (bestFitingRegression != regressions.end())
-      {
-        bestFitingRegression->addPoint(point);
-        bestFitingRegression->solve();
+        float dist = (regression.head() - point).norm();
+        if (!(dist <= maxHeadDist))
+          continue;
+
+        // Error should not be more than current RMSE
+        auto fit = regression.fit(point);
+        // only accept within 2 sigma
+        if (fit > worstFitAllowed || fit > bestFit)
+          continue;
+
+        // Of equally good fits, prefer the most recently started regression
+        if (fit == bestFit && index < bestFittingRegression)
+          continue;
+
+        bestFit = fit;
+        bestFittingRegression = index;
       }
-      else
-      {
-        // Start new regression
-        IncrementalRegression newRegression;
-        newRegression.setSqError(100.0);
+    }
 
-        newRegression.addPoint(point);
-        regressions.push_back(newRegression);
+    if (bestFittingRegression != regressions.size())
+    {
+      auto& regression = regressions[bestFittingRegression];
+      regression.addPoint(point);
+      regression.solve();
+
+      // Move the regression's index if its head has changed band
+      unsigned oldBand = d_regressionBuckets[bestFittingRegression];
+      unsigned newBand = bandForY(regression.head().y());
+      if (newBand != oldBand)
+      {
+        auto& oldBucket = d_headBuckets[oldBand];
+        auto it = find(oldBucket.begin(), oldBucket.end(), bestFittingRegression);
+        ASSERT(it != oldBucket.end());
+        *it = oldBucket.back();
+        oldBucket.pop_back();
+        d_headBuckets[newBand].push_back(bestFittingRegression);
+        d_regressionBuckets[bestFittingRegression] = newBand;
       }
     }
+    else
+    {
+      // Start new regression
+      IncrementalRegression newRegression;
+      newRegression.setSqError(100.0);
+
+      newRegression.addPoint(point);
+      d_headBuckets[band].push_back(regressions.size());
+      d_regressionBuckets.push_back(band);
+      regressions.push_back(newRegression);
+    }
+  }
 
   float minLength = d_minLength->getValue();
   float minCoverage = d_minCoverage->getValue();
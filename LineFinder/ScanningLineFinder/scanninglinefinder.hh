@@ -6,7 +6,17 @@
 namespace bold
 {
   class CameraModel;
+  class IncrementalRegression;
 
+  /** Finds lines by sweeping across line dots column by column, growing
+   * regressions from dots near their heads.
+   *
+   * Dots are ordered with a counting sort. Regression heads are bucketed
+   * into bands of rows, max-head-dist high, so each dot only considers
+   * regressions in its own and neighbouring bands. Regressions whose head
+   * falls more than max-head-dist behind the scan column can take no
+   * further dots, and are dropped from the buckets as they are met.
+   */
   class ScanningLineFinder : public LineFinder
   {
   public:
@@ -15,8 +25,18 @@ namespace bold
     std::vector<LineSegment2i> findLineSegments(std::vector<Eigen::Vector2i>& lineDots) override;
 
   private:
+    /// Orders line dots by column, then row, into d_sortedDots, dropping duplicates.
+    void sortDots(std::vector<Eigen::Vector2i> const& lineDots);
+
     std::shared_ptr<CameraModel> d_cameraModel;
 
+    // Working storage, reused between calls
+    std::vector<Eigen::Vector2i> d_sortedDots;
+    std::vector<Eigen::Vector2i> d_rowSortedDots;
+    std::vector<unsigned> d_counts;
+    std::vector<std::vector<unsigned>> d_headBuckets;
+    std::vector<unsigned> d_regressionBuckets;
+
     // Minimum line segment length required
     Setting<double>* d_minLength;
     // Minimum ratio of dots / length required
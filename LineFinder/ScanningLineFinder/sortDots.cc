@@ -0,0 +1,31 @@
+#include "scanninglinefinder.ih"
+
+void ScanningLineFinder::sortDots(vector<Vector2i> const& lineDots)
+{
+  unsigned width = d_cameraModel->imageWidth();
+  unsigned height = d_cameraModel->imageHeight();
+
+  // Two stable counting sorts, by row and then by column, leave dots
+  // ordered by column first, then row
+  auto countingSort = [this](vector<Vector2i> const& in, vector<Vector2i>& out, unsigned range, int axis)
+  {
+    d_counts.assign(range + 1, 0);
+    for (auto const& dot : in)
+    {
+      ASSERT(dot(axis) >= 0 && unsigned(dot(axis)) < range);
+      d_counts[dot(axis) + 1]++;
+    }
+
+    for (unsigned i = 1; i <= range; i++)
+      d_counts[i] += d_counts[i - 1];
+
+    out.resize(in.size());
+    for (auto const& dot : in)
+      out[d_counts[dot(axis)]++] = dot;
+  };
+
+  countingSort(lineDots, d_rowSortedDots, height, 1);
+  countingSort(d_rowSortedDots, d_sortedDots, width, 0);
+
+  d_sortedDots.erase(unique(d_sortedDots.begin(), d_sortedDots.end()), d_sortedDots.end());
+}
@@ -1,13 +1,12 @@
 #pragma once
 
 #include <opencv2/core/core.hpp>
-#include <functional>
 
 namespace bold
 {
   /**
-  * A state machine that calls back when it detects a run of one label sandwiched
-  * between runs of another label.
+  * A state machine that detects a run of one label sandwiched between runs of
+  * another label.
   *
   * This type was designed for finding line segments in an image row/column.
   *
@@ -20,17 +19,13 @@ namespace bold
     LineRunTracker(
       uint8_t inLabel,
       uint8_t onLabel,
-      ushort otherCoordinate,
-      uint8_t hysteresisLimit,
-      std::function<void(ushort const, ushort const, ushort const)> callback
+      uint8_t hysteresisLimit
     )
-      : otherCoordinate(otherCoordinate),
-	inLabel(inLabel),
+      : inLabel(inLabel),
 	onLabel(onLabel),
 	hysteresisLimit(hysteresisLimit),
 	state(State::Out),
 	startedAt(0),
-	callback(callback),
 	hysteresis(0)
     {}
 
@@ -39,13 +34,18 @@ namespace bold
       state = State::Out;
     }
 
-    void update(uint8_t label, ushort position);
+    /** Advances the tracker to the label at the given position.
+     *
+     * Returns true if this completes a run, in which case the run spans from
+     * getRunStart() to position.
+     */
+    bool update(uint8_t label, ushort position);
+
+    ushort getRunStart() const { return startedAt; }
 
     uint8_t getHysteresisLimit() const { return hysteresisLimit; }
     void setHysteresisLimit(uint8_t limit) { hysteresisLimit = limit; }
 
-    ushort otherCoordinate;
-
   private:
     enum class State : uint8_t
     {
@@ -62,11 +62,10 @@ namespace bold
     uint8_t hysteresisLimit;
     State state;
     ushort startedAt;
-    std::function<void(ushort const, ushort const, ushort const)> callback;
     uint hysteresis;
   };
 
-  inline void LineRunTracker::update(uint8_t label, ushort position)
+  inline bool LineRunTracker::update(uint8_t label, ushort position)
   {
     switch (state)
     {
@@ -113,7 +112,7 @@ namespace bold
 	// we completed a run!
 	state = State::In;
 	hysteresis = 0;
-	callback(startedAt, position, otherCoordinate);
+	return true;
       }
       else if (label == onLabel)
       {
@@ -130,5 +129,7 @@ namespace bold
       break;
     }
     }
+
+    return false;
   }
 }
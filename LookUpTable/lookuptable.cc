@@ -0,0 +1,54 @@
+#include "lookuptable.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+using namespace bold;
+using namespace std;
+
+LookUpTable::LookUpTable(LUTColourSpace colourSpace, uchar bitsPerChannel)
+  : d_colourSpace(colourSpace),
+    d_bitsPerChannel(bitsPerChannel),
+    d_data(nullptr),
+    d_release(free)
+{
+  ASSERT(bitsPerChannel >= 5 && bitsPerChannel <= 8);
+
+  void* data;
+  if (posix_memalign(&data, 64, getSize()) != 0)
+    throw bad_alloc();
+  d_data = static_cast<uchar*>(data);
+
+  memset(d_data, 0, getSize());
+}
+
+LookUpTable::LookUpTable(LUTColourSpace colourSpace, uchar bitsPerChannel, uchar* data, function<void(uchar*)> release)
+  : d_colourSpace(colourSpace),
+    d_bitsPerChannel(bitsPerChannel),
+    d_data(data),
+    d_release(release)
+{
+  ASSERT(bitsPerChannel >= 5 && bitsPerChannel <= 8);
+  ASSERT(data);
+}
+
+LookUpTable::~LookUpTable()
+{
+  d_release(d_data);
+}
+
+shared_ptr<LookUpTable> LookUpTable::clone() const
+{
+  auto copy = make_shared<LookUpTable>(d_colourSpace, d_bitsPerChannel);
+  memcpy(copy->data(), d_data, getSize());
+  return copy;
+}
+
+string LookUpTable::getName(LUTColourSpace colourSpace, uchar bitsPerChannel)
+{
+  stringstream name;
+  name << (colourSpace == LUTColourSpace::YCbCr ? "ycbcr" : "bgr") << (3 * bitsPerChannel);
+  return name.str();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <opencv2/core/core.hpp>
+
+#include "../util/assert.hh"
+
+namespace bold
+{
+  enum class LUTColourSpace
+  {
+    BGR = 0,
+    YCbCr = 1
+  };
+
+  /** Maps colours, quantised to a number of bits per channel, to pixel label IDs.
+   *
+   * Cells are indexed by channel in order: (y, cb, cr) for YCbCr tables and
+   * (b, g, r) for BGR tables. Tables with 5, 6, 7 or 8 bits per channel (15,
+   * 18, 21 or 24-bit indices) trade cache footprint against label accuracy.
+   *
+   * Storage is cache line aligned, and owned by the table.
+   */
+  class LookUpTable
+  {
+  public:
+    /** Allocates a table with every cell zero (unlabelled). */
+    LookUpTable(LUTColourSpace colourSpace, uchar bitsPerChannel);
+
+    /** Adopts existing storage, such as a memory mapping, which release is called to free. */
+    LookUpTable(LUTColourSpace colourSpace, uchar bitsPerChannel, uchar* data, std::function<void(uchar*)> release);
+
+    ~LookUpTable();
+
+    /** Returns a copy of this table with its own storage. */
+    std::shared_ptr<LookUpTable> clone() const;
+
+    LUTColourSpace getColourSpace() const { return d_colourSpace; }
+    uchar getBitsPerChannel() const { return d_bitsPerChannel; }
+    unsigned getBitDepth() const { return 3u * d_bitsPerChannel; }
+    size_t getSize() const { return size_t(1) << getBitDepth(); }
+
+    /** Returns a short name, such as "ycbcr18", identifying the table's format. */
+    std::string getName() const { return getName(d_colourSpace, d_bitsPerChannel); }
+
+    static std::string getName(LUTColourSpace colourSpace, uchar bitsPerChannel);
+
+    uchar const* data() const { return d_data; }
+    uchar* data() { return d_data; }
+
+    unsigned getIndex(uchar c0, uchar c1, uchar c2) const
+    {
+      uchar const shift = 8 - d_bitsPerChannel;
+      return ((c0 >> shift) << (2 * d_bitsPerChannel)) | ((c1 >> shift) << d_bitsPerChannel) | (c2 >> shift);
+    }
+
+    /** As getIndex, for a resolution known at compile time, so that shifts are constants. */
+    template<uchar BITS>
+    static constexpr unsigned index(uchar c0, uchar c1, uchar c2)
+    {
+      return ((c0 >> (8 - BITS)) << (2 * BITS)) | ((c1 >> (8 - BITS)) << BITS) | (c2 >> (8 - BITS));
+    }
+
+    uchar lookUp(uchar c0, uchar c1, uchar c2) const { return d_data[getIndex(c0, c1, c2)]; }
+
+  private:
+    LookUpTable(LookUpTable const&) = delete;
+    LookUpTable& operator=(LookUpTable const&) = delete;
+
+    LUTColourSpace d_colourSpace;
+    uchar d_bitsPerChannel;
+    uchar* d_data;
+    std::function<void(uchar*)> d_release;
+  };
+}
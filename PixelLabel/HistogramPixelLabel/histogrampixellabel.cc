@@ -252,6 +252,14 @@ void HistogramPixelLabel<CHANNEL_BITS>::read(istream& in)
     d_totalCount += v;
 }
 
+template<uint8_t CHANNEL_BITS>
+void HistogramPixelLabel<CHANNEL_BITS>::writeDefinition(ostream& out) const
+{
+  PixelLabel::writeDefinition(out);
+  out << " histogram " << (int)CHANNEL_BITS << " ";
+  write(out);
+}
+
 template class bold::HistogramPixelLabel<8>;
 template class bold::HistogramPixelLabel<7>;
 template class bold::HistogramPixelLabel<6>;
@@ -43,6 +43,8 @@ namespace bold
     void write(std::ostream& out) const;
     void read(std::istream& in);
 
+    void writeDefinition(std::ostream& out) const override;
+
   private:
     constexpr static unsigned BIN_SIZE = (256 >> CHANNEL_BITS);
     constexpr static unsigned NBINS = 1 << CHANNEL_BITS;
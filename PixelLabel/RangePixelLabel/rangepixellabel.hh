@@ -18,6 +18,7 @@ namespace bold
     Colour::hsv modalColour() const override;
 
     void print(std::ostream& out) const override;
+    void writeDefinition(std::ostream& out) const override;
 
   private:
     Colour::hsvRange d_hsvRange;
@@ -58,4 +59,12 @@ namespace bold
     PixelLabel::print(out);
     out << " " << d_hsvRange;
   }
+
+  inline void RangePixelLabel::writeDefinition(std::ostream& out) const
+  {
+    PixelLabel::writeDefinition(out);
+    out << " range " << (int)d_hsvRange.hMin << " " << (int)d_hsvRange.hMax
+        << " " << (int)d_hsvRange.sMin << " " << (int)d_hsvRange.sMax
+        << " " << (int)d_hsvRange.vMin << " " << (int)d_hsvRange.vMax;
+  }
 }
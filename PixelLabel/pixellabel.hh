@@ -36,6 +36,11 @@ namespace bold
 
     virtual void print(std::ostream& out) const;
 
+    /** Writes everything that determines labelProb, so that labels which write
+     * the same definition label every colour identically.
+     */
+    virtual void writeDefinition(std::ostream& out) const;
+
   private:
     LabelClass d_id;
     std::string d_name;
@@ -52,6 +57,11 @@ namespace bold
   {
     out << d_name << " (" << (int)d_id << ")";
   }
+
+  inline void PixelLabel::writeDefinition(std::ostream& out) const
+  {
+    out << d_name << " " << (int)d_id;
+  }
 }
 
 namespace std
@@ -0,0 +1,55 @@
+#include "rowlabelcache.hh"
+
+using namespace bold;
+using namespace std;
+
+RowLabelCache::RowLabelCache(ushort imageHeight, double maxMeanDelta)
+  : d_entries(imageHeight),
+    d_changedRowCount(0),
+    d_maxMeanDelta(maxMeanDelta)
+{}
+
+void RowLabelCache::clear()
+{
+  for (Entry& entry : d_entries)
+    entry = Entry();
+}
+
+void RowLabelCache::beginFrame(shared_ptr<LookUpTable const> const& lut)
+{
+  if (lut != d_lut)
+  {
+    clear();
+    d_lut = lut;
+  }
+
+  d_changedRowCount = 0;
+}
+
+bool RowLabelCache::isUnchanged(Entry const& entry, uchar const* row) const
+{
+  bool unchanged = true;
+  double maxMeanDelta = d_maxMeanDelta;
+
+  visitBlocks(row, entry.x, entry.pixelCount, entry.dx, [&](unsigned block, int y, int cb, int cr, unsigned count)
+  {
+    int const* sums = &entry.sums[block * 3];
+    int delta = abs(y - sums[0]) + abs(cb - sums[1]) + abs(cr - sums[2]);
+    unchanged = delta <= maxMeanDelta * count;
+    return unchanged;
+  });
+
+  return unchanged;
+}
+
+void RowLabelCache::summarise(uchar const* row, unsigned x, unsigned pixelCount, uchar dx, vector<int>& sums)
+{
+  sums.clear();
+  visitBlocks(row, x, pixelCount, dx, [&sums](unsigned block, int y, int cb, int cr, unsigned count)
+  {
+    sums.push_back(y);
+    sums.push_back(cb);
+    sums.push_back(cr);
+    return true;
+  });
+}
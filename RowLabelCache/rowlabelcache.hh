@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "../LookUpTable/lookuptable.hh"
+
+namespace bold
+{
+  /** Keeps the labels of YUYV image rows between frames, so that rows whose pixels barely change need not be labelled again.
+   *
+   * Each labelled span of a row is summarised by the sums of its sampled Y, Cb
+   * and Cr values over fixed width blocks. Summing averages out sensor noise,
+   * while an object moving within a block still changes its sums markedly. A
+   * span's labels are reused while every block stays within tolerance of the
+   * sums taken when it was last labelled, so slow drift eventually causes the
+   * span to be labelled again.
+   *
+   * Cached labels depend upon the LUT, so the cache clears itself when a
+   * frame is labelled with a different one. Distinct rows may be labelled
+   * concurrently.
+   */
+  class RowLabelCache
+  {
+  public:
+    /// Number of samples summed together when comparing rows
+    static constexpr unsigned BlockSize = 32;
+
+    RowLabelCache(ushort imageHeight, double maxMeanDelta);
+
+    /** Sets the largest mean difference per sample, summed over Y, Cb and Cr, for which a block is considered unchanged. */
+    void setMaxMeanDelta(double maxMeanDelta) { d_maxMeanDelta = maxMeanDelta; }
+
+    /** Forgets every row. */
+    void clear();
+
+    /** Prepares to label a new frame with the given LUT, resetting the count of changed rows. */
+    void beginFrame(std::shared_ptr<LookUpTable const> const& lut);
+
+    /** The number of row spans labelled afresh since beginFrame. */
+    unsigned getChangedRowCount() const { return d_changedRowCount; }
+
+    /** Writes labels for a span of a YUYV row, copying cached labels if the span's pixels are unchanged.
+     *
+     * The span holds pixelCount samples, from column x, stepping dx columns
+     * between samples. If it has changed, labelSpan(row, x, out, pixelCount, dx)
+     * labels it and the result is cached.
+     */
+    template<typename TLabelSpan>
+    void label(uchar const* row, ushort y, unsigned x, uchar* out, unsigned pixelCount, uchar dx, TLabelSpan const& labelSpan);
+
+  private:
+    struct Entry
+    {
+      Entry() : x(0), pixelCount(0), dx(0) {}
+
+      unsigned x;
+      unsigned pixelCount;
+      uchar dx;
+      /// Sums of Y, Cb and Cr for each block, when the labels were produced
+      std::vector<int> sums;
+      std::vector<uchar> labels;
+    };
+
+    bool isUnchanged(Entry const& entry, uchar const* row) const;
+
+    static void summarise(uchar const* row, unsigned x, unsigned pixelCount, uchar dx, std::vector<int>& sums);
+
+    template<typename TVisitor>
+    static void visitBlocks(uchar const* row, unsigned x, unsigned pixelCount, uchar dx, TVisitor const& visitor);
+
+    std::vector<Entry> d_entries;
+    /// The LUT that cached labels were produced with. Holding it ensures a new LUT is never mistaken for it.
+    std::shared_ptr<LookUpTable const> d_lut;
+    std::atomic<unsigned> d_changedRowCount;
+    std::atomic<double> d_maxMeanDelta;
+  };
+
+  template<typename TLabelSpan>
+  inline void RowLabelCache::label(uchar const* row, ushort y, unsigned x, uchar* out, unsigned pixelCount, uchar dx, TLabelSpan const& labelSpan)
+  {
+    Entry& entry = d_entries[y];
+
+    if (entry.x == x && entry.pixelCount == pixelCount && entry.dx == dx && isUnchanged(entry, row))
+    {
+      std::copy(entry.labels.begin(), entry.labels.end(), out);
+      return;
+    }
+
+    labelSpan(row, x, out, pixelCount, dx);
+
+    entry.x = x;
+    entry.pixelCount = pixelCount;
+    entry.dx = dx;
+    summarise(row, x, pixelCount, dx, entry.sums);
+    entry.labels.assign(out, out + pixelCount);
+
+    d_changedRowCount++;
+  }
+
+  template<typename TVisitor>
+  inline void RowLabelCache::visitBlocks(uchar const* row, unsigned x, unsigned pixelCount, uchar dx, TVisitor const& visitor)
+  {
+    unsigned block = 0;
+    for (unsigned i = 0; i < pixelCount; i += BlockSize, block++)
+    {
+      unsigned end = std::min(pixelCount, i + BlockSize);
+      int y = 0, cb = 0, cr = 0;
+      for (unsigned j = i; j < end; j++, x += dx)
+      {
+        // Each four byte macropixel [Y0 Cb Y1 Cr] holds two pixels which share chroma values
+        uchar const* macropixel = row + (x & ~1u) * 2;
+        y += macropixel[(x & 1u) * 2];
+        cb += macropixel[1];
+        cr += macropixel[3];
+      }
+      if (!visitor(block, y, cb, cr, end - i))
+        return;
+    }
+  }
+}
@@ -59,6 +59,18 @@ namespace bold
       rebuildPrefix();
     }
 
+    /** Records events timed elsewhere, such as by a timer on another thread, under this timer's current prefix. */
+    void append(std::vector<EventTiming> const& eventTimings)
+    {
+      ASSERT(!d_flushed);
+      for (auto const& timing : eventTimings)
+      {
+        std::string name = d_prefix.size() ? d_prefix + '/' + timing.second : timing.second;
+        d_eventTimings->emplace_back(timing.first, name);
+      }
+      d_last = Clock::getTimestamp();
+    }
+
     std::string getPrefix() const { return d_prefix; }
 
   private:
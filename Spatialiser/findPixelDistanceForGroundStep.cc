@@ -0,0 +1,25 @@
+#include "spatialiser.ih"
+
+Maybe<double> Spatialiser::findPixelDistanceForGroundStep(double y, double stepMetres) const
+{
+  // Ground point under the centre pixel of row y, in homogeneous coordinates.
+  // Pixels are relative to the image centre, so that pixel is (0, v).
+  double v = y - d_cameraModel->imageHeight() / 2.0;
+  Vector3d ground = d_zeroGroundPixelTr.col(1) * v + d_zeroGroundPixelTr.col(2);
+
+  // Above the horizon
+  if (ground.z() <= 0)
+    return Maybe<double>::empty();
+
+  // The inverse transform maps ground points back to pixels. Mapping the
+  // stepped ground point (ground / w) + (step, 0, 1) and scaling by w gives
+  // the row's own pixel plus a multiple of the inverse's first column.
+  Matrix3d pixelGroundTr = d_zeroGroundPixelTr.inverse();
+  Vector3d pixel = Vector3d(0, v, 1) + stepMetres * ground.z() * pixelGroundTr.col(0);
+
+  // Behind the camera
+  if (pixel.z() <= 0)
+    return Maybe<double>::empty();
+
+  return Maybe<double>((pixel.head<2>() / pixel.z() - Vector2d(0, v)).norm());
+}
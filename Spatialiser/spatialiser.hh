@@ -77,6 +77,15 @@ namespace bold
     Maybe<Eigen::Vector2d> findPixelForAgentPoint(Eigen::Vector3d const& agentPoint,
                                                   Eigen::Affine3d const& agentCameraTr) const;
 
+    /** Returns the distance, in pixels, spanned by a step along the agent's
+     * x axis on the ground, starting at the centre pixel of image row y.
+     *
+     * Computed in closed form from the zero ground pixel transform, and
+     * equivalent to finding the ground point for the pixel, offsetting it and
+     * projecting it back into the image. Empty if the row is above the horizon.
+     */
+    Maybe<double> findPixelDistanceForGroundStep(double y, double stepMetres) const;
+
     int findHorizonForColumn(int column);
     int findHorizonForColumn(int column, Eigen::Affine3d const& agentCameraTr);
 
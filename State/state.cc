@@ -3,8 +3,6 @@
 using namespace bold;
 using namespace std;
 
-sigc::signal<void, shared_ptr<StateTracker const>> State::updated;
-
 mutex State::d_mutex;
 
 unordered_map<type_index, vector<shared_ptr<StateObserver>>> State::d_observersByTypeIndex;
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
-#include <sigc++/signal.h>
 #include <type_traits>
 #include <typeindex>
 #include <vector>
@@ -38,7 +38,8 @@ namespace bold
 
     StateTracker(std::string name)
     : websocketProtocol(nullptr),
-      d_name(name)
+      d_name(name),
+      d_updateCount(0)
     {}
 
     void set(std::shared_ptr<StateObject const> state)
@@ -76,6 +77,19 @@ namespace bold
       return time == StateTime::MostRecent ? d_stateMostRecent : d_stateCameraImage;
     }
 
+    /** Returns the most recent state if it has been set since updateCount was obtained, advancing updateCount.
+     *
+     * Returns nullptr if there has been no update. Any versions set in between are skipped.
+     */
+    std::shared_ptr<StateObject const> stateIfUpdatedSince(long long unsigned& updateCount) const
+    {
+      std::lock_guard<std::mutex> guard(d_mutex);
+      if (d_updateCount == updateCount)
+        return nullptr;
+      updateCount = d_updateCount;
+      return d_stateMostRecent;
+    }
+
     std::string name() const { return d_name; }
     long long unsigned updateCount() const { return d_updateCount; }
 
@@ -86,7 +100,7 @@ namespace bold
     const std::string d_name;
     std::shared_ptr<StateObject const> d_stateMostRecent;
     std::shared_ptr<StateObject const> d_stateCameraImage;
-    long long unsigned d_updateCount;
+    std::atomic<long long unsigned> d_updateCount;
   };
 
   class State
@@ -101,19 +115,6 @@ namespace bold
 
     static unsigned stateTypeCount() { return d_trackerByTypeId.size(); }
 
-    /** Fires when a state object is updated.
-     *
-     * Currently only used by DataStreamer, which may serialise the
-     * StateObject for attached clients.
-     *
-     * A lock is held over d_mutex while this event is raised :(
-     *
-     * TODO avoid unbounded holding of d_mutex by getting rid of this
-     * signal and using a queue for the DataStreamer thread to process
-     * (?)
-     */
-    static sigc::signal<void, std::shared_ptr<StateTracker const>> updated;
-
     static void registerObserver(std::shared_ptr<StateObserver> observer);
 
     static void callbackObservers(ThreadId threadId, SequentialTimer& timer);
@@ -183,16 +184,17 @@ namespace bold
   {
     static_assert(std::is_base_of<StateObject, T>::value, "T must be a descendant of StateObject");
 
+    // Only the tracker's latest version is updated here. Publishers, such as
+    // DataStreamer, poll trackers for new versions on their own threads, so
+    // setting state never waits on serialisation.
     auto const& tracker = getTracker<T const>();
     tracker->set(state);
 
     std::vector<std::shared_ptr<StateObserver>>* observers;
 
-    // Raise event and look up observers while holding lock
+    // Look up observers while holding lock
     {
-      // TODO this blocks for too long. eventing won't work well. need to do all updates async, off the motion thread
       std::lock_guard<std::mutex> guard(d_mutex);
-      updated(tracker);
 
       auto it = d_observersByTypeIndex.find(typeid(T));
       ASSERT(it != d_observersByTypeIndex.end());
@@ -7,6 +7,7 @@
 #include "../../MX28/mx28.hh"
 
 using namespace bold;
+using namespace rapidjson;
 using namespace std;
 using namespace Eigen;
 
@@ -135,6 +136,43 @@ Affine3d BodyState::determineFootAgentTr(bool leftFoot) const
   return Math::alignUp(footTorsoTr);
 }
 
+void BodyState::writeBinarySchemaJson(Writer<WebSocketBuffer>& writer) const
+{
+  const unsigned jointCount = (uchar)JointId::MAX - (uchar)JointId::MIN + 1;
+
+  beginBinarySchema(writer);
+  {
+    writeBinaryField(writer, "motion-cycle", "u32");
+    writeBinaryField(writer, "angles", "f32", jointCount);
+    writeBinaryField(writer, "errors", "i16", jointCount);
+    writeBinaryField(writer, "com", "f32", 3);
+  }
+  endBinarySchema(writer);
+}
+
+void BodyState::writeBinary(WebSocketBuffer& buffer) const
+{
+  const size_t jointCount = (uchar)JointId::MAX - (uchar)JointId::MIN + 1;
+  const size_t payloadSize = 4 + jointCount * 4 + jointCount * 2 + 3 * 4;
+
+  BufferWriter writer = beginBinary(buffer, payloadSize);
+
+  writer.writeInt32u(static_cast<uint32_t>(d_motionCycleNumber));
+
+  for (uchar j = (uchar)JointId::MIN; j <= (uchar)JointId::MAX; j++)
+    writer.writeFloat32(static_cast<float>(d_jointById[j]->getAngleRads()));
+
+  for (uchar j = (uchar)JointId::MIN; j <= (uchar)JointId::MAX; j++)
+    writer.writeInt16(d_positionValueDiffById[j]);
+
+  Vector3d const& com = getCentreOfMass();
+  writer.writeFloat32(static_cast<float>(com.x()));
+  writer.writeFloat32(static_cast<float>(com.y()));
+  writer.writeFloat32(static_cast<float>(com.z()));
+
+  ASSERT(writer.pos() == BinaryHeaderSize + payloadSize);
+}
+
 shared_ptr<BodyState const> BodyState::zero(shared_ptr<BodyModel const> const& bodyModel, ulong thinkCycleNumber)
 {
   array<double,23> angles;
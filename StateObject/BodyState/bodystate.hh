@@ -132,6 +132,10 @@ namespace bold
     void writeJson(rapidjson::Writer<WebSocketBuffer>& writer) const override { writeJsonInternal(writer); }
     void writeJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
 
+    bool hasBinaryEncoding() const override { return true; }
+    void writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const override;
+    void writeBinary(WebSocketBuffer& buffer) const override;
+
     /** Transformation describing camera frame in agent frame, used to
      * transform camera coordinates to agent coordinates */
     Eigen::Affine3d const& getAgentCameraTransform() const { return d_agentCameraTr; }
@@ -48,6 +48,10 @@ namespace bold
     void writeJson(rapidjson::Writer<WebSocketBuffer>& writer) const override { writeJsonInternal(writer); }
     void writeJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
 
+    bool hasBinaryEncoding() const override { return true; }
+    void writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const override;
+    void writeBinary(WebSocketBuffer& buffer) const override;
+
     ulong getReceivedBytes() const { return d_rxBytes; }
     ulong getTransmittedBytes() const { return d_txBytes; }
     ulong getMotionCycleNumber() const { return d_motionCycleNumber; }
@@ -141,4 +145,71 @@ namespace bold
     }
     writer.EndObject();
   }
+
+  inline void HardwareState::writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const
+  {
+    beginBinarySchema(writer);
+    {
+      writeBinaryField(writer, "cycle", "u32");
+      writeBinaryField(writer, "acc", "f32", 3);
+      writeBinaryField(writer, "gyro", "f32", 3);
+      writeBinaryField(writer, "eye", "f32", 3);
+      writeBinaryField(writer, "forehead", "f32", 3);
+      writeBinaryField(writer, "led2", "bool");
+      writeBinaryField(writer, "led3", "bool");
+      writeBinaryField(writer, "led4", "bool");
+      writeBinaryField(writer, "volts", "f32");
+      writeBinaryField(writer, "rxBytes", "u32");
+      writeBinaryField(writer, "txBytes", "u32");
+      beginBinaryGroup(writer, "joints", static_cast<unsigned>(d_mx28States.size()));
+      {
+        writeBinaryField(writer, "id", "u8");
+        writeBinaryField(writer, "val", "u16");
+        writeBinaryField(writer, "rpm", "f32");
+        writeBinaryField(writer, "load", "f32");
+        writeBinaryField(writer, "temp", "u8");
+        writeBinaryField(writer, "volts", "f32");
+      }
+      endBinaryGroup(writer);
+    }
+    endBinarySchema(writer);
+  }
+
+  inline void HardwareState::writeBinary(WebSocketBuffer& buffer) const
+  {
+    const size_t jointSize = 1 + 2 + 4 + 4 + 1 + 4;
+    const size_t payloadSize = 4 + 4 * 3 * 4 + 3 + 4 + 4 + 4 + d_mx28States.size() * jointSize;
+
+    BufferWriter writer = beginBinary(buffer, payloadSize);
+
+    writer.writeInt32u(static_cast<uint32_t>(d_motionCycleNumber));
+
+    for (auto const* vec : { &d_cm730State->acc, &d_cm730State->gyro, &d_cm730State->eyeColor, &d_cm730State->foreheadColor })
+    {
+      writer.writeFloat32(static_cast<float>(vec->x()));
+      writer.writeFloat32(static_cast<float>(vec->y()));
+      writer.writeFloat32(static_cast<float>(vec->z()));
+    }
+
+    writer.writeInt8u(d_cm730State->isLed2On ? 1 : 0);
+    writer.writeInt8u(d_cm730State->isLed3On ? 1 : 0);
+    writer.writeInt8u(d_cm730State->isLed4On ? 1 : 0);
+
+    writer.writeFloat32(static_cast<float>(d_cm730State->voltage));
+
+    writer.writeInt32u(static_cast<uint32_t>(d_rxBytes));
+    writer.writeInt32u(static_cast<uint32_t>(d_txBytes));
+
+    for (auto const& mx28 : d_mx28States)
+    {
+      writer.writeInt8u(mx28->id);
+      writer.writeInt16u(mx28->presentPositionValue);
+      writer.writeFloat32(static_cast<float>(mx28->presentSpeedRPM));
+      writer.writeFloat32(static_cast<float>(mx28->presentLoad));
+      writer.writeInt8u(mx28->presentTemp);
+      writer.writeFloat32(static_cast<float>(mx28->presentVoltage));
+    }
+
+    ASSERT(writer.pos() == BinaryHeaderSize + payloadSize);
+  }
 }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../stateobject.hh"
+
+namespace bold
+{
+  /** The order in which an ImagePassRunner processes its handlers.
+   *
+   * Handlers within a stage are independent of one another, and only depend
+   * upon handlers in earlier stages.
+   */
+  class ImagePassScheduleState : public StateObject
+  {
+  public:
+    struct Entry
+    {
+      std::string id;
+      std::vector<std::string> dependencies;
+    };
+
+    ImagePassScheduleState(std::vector<std::vector<Entry>> stages)
+    : d_stages(std::move(stages))
+    {}
+
+    std::vector<std::vector<Entry>> const& getStages() const { return d_stages; }
+
+    void writeJson(rapidjson::Writer<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
+    void writeJson(rapidjson::Writer<WebSocketBuffer>& writer) const override { writeJsonInternal(writer); }
+    void writeJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
+
+  private:
+    template<typename TBuffer>
+    void writeJsonInternal(rapidjson::Writer<TBuffer> &writer) const;
+
+    std::vector<std::vector<Entry>> d_stages;
+  };
+
+  template<typename TBuffer>
+  inline void ImagePassScheduleState::writeJsonInternal(rapidjson::Writer<TBuffer> &writer) const
+  {
+    writer.StartObject();
+    {
+      writer.String("stages");
+      writer.StartArray();
+      {
+        for (auto const& stage : d_stages)
+        {
+          writer.StartArray();
+          {
+            for (auto const& entry : stage)
+            {
+              writer.StartObject();
+              {
+                writer.String("id");
+                writer.String(entry.id.c_str());
+                writer.String("dependencies");
+                writer.StartArray();
+                for (auto const& dependency : entry.dependencies)
+                  writer.String(dependency.c_str());
+                writer.EndArray();
+              }
+              writer.EndObject();
+            }
+          }
+          writer.EndArray();
+        }
+      }
+      writer.EndArray();
+    }
+    writer.EndObject();
+  }
+}
@@ -4,6 +4,7 @@
 #include "../../Colour/colour.hh"
 #include "../../util/json.hh"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -27,11 +28,26 @@ namespace bold
     void writeJson(rapidjson::Writer<WebSocketBuffer>& writer) const override { writeJsonInternal(writer); }
     void writeJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
 
+    bool hasBinaryEncoding() const override { return true; }
+    void writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const override;
+    void writeBinary(WebSocketBuffer& buffer) const override;
+
     std::shared_ptr<std::vector<EventTiming> const> getTimings() const { return d_eventTimings; }
 
     ulong getCycleNumber() const { return d_cycleNumber; }
     double getAverageFps() const { return d_averageFps; }
 
+  protected:
+    /** Writes the members common to all timing states into the current JSON object. */
+    template<typename TBuffer>
+    void writeJsonMembers(rapidjson::Writer<TBuffer>& writer) const;
+
+    /** Describes the binary fields common to all timing states. */
+    void writeBinarySchemaMembers(rapidjson::Writer<WebSocketBuffer>& writer) const;
+    /** The number of bytes writeBinaryMembers writes. */
+    size_t getBinaryMembersSize() const;
+    void writeBinaryMembers(BufferWriter& writer) const;
+
   private:
     template<typename TBuffer>
     void writeJsonInternal(rapidjson::Writer<TBuffer>& writer) const;
@@ -44,27 +60,85 @@ namespace bold
   template<typename TBuffer>
   inline void TimingState::writeJsonInternal(rapidjson::Writer<TBuffer>& writer) const
   {
+    writer.StartObject();
+    writeJsonMembers(writer);
+    writer.EndObject();
+  }
+
+  template<typename TBuffer>
+  inline void TimingState::writeJsonMembers(rapidjson::Writer<TBuffer>& writer) const
+  {
+    writer.String("cycle");
+    writer.Uint64(d_cycleNumber);
+    writer.String("fps");
+    writer.Double(d_averageFps, "%.3f");
+    writer.String("timings");
     writer.StartObject();
     {
-      writer.String("cycle");
-      writer.Uint64(d_cycleNumber);
-      writer.String("fps");
-      writer.Double(d_averageFps, "%.3f");
-      writer.String("timings");
-      writer.StartObject();
+      std::vector<EventTiming> const& timings = *d_eventTimings;
+      for (EventTiming const& timing : timings)
       {
-        std::vector<EventTiming> const& timings = *d_eventTimings;
-        for (EventTiming const& timing : timings)
-        {
-          writer.String(timing.second.c_str()); // event name
-          writer.Double(timing.first, "%.3f");  // duration in milliseconds
-        }
+        writer.String(timing.second.c_str()); // event name
+        writer.Double(timing.first, "%.3f");  // duration in milliseconds
       }
-      writer.EndObject();
     }
     writer.EndObject();
   }
 
+  inline void TimingState::writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const
+  {
+    beginBinarySchema(writer);
+    writeBinarySchemaMembers(writer);
+    endBinarySchema(writer);
+  }
+
+  inline void TimingState::writeBinary(WebSocketBuffer& buffer) const
+  {
+    size_t payloadSize = getBinaryMembersSize();
+    BufferWriter writer = beginBinary(buffer, payloadSize);
+    writeBinaryMembers(writer);
+    ASSERT(writer.pos() == BinaryHeaderSize + payloadSize);
+  }
+
+  inline void TimingState::writeBinarySchemaMembers(rapidjson::Writer<WebSocketBuffer>& writer) const
+  {
+    writeBinaryField(writer, "cycle", "u32");
+    writeBinaryField(writer, "fps", "f32");
+    beginBinaryGroup(writer, "timings", "u16");
+    {
+      writeBinaryField(writer, "event", "str8");
+      writeBinaryField(writer, "ms", "f32");
+    }
+    endBinaryGroup(writer);
+  }
+
+  inline size_t TimingState::getBinaryMembersSize() const
+  {
+    size_t size = 4 + 4 + 2;
+    for (EventTiming const& timing : *d_eventTimings)
+      size += 1 + std::min<size_t>(timing.second.size(), UINT8_MAX) + 4;
+    return size;
+  }
+
+  inline void TimingState::writeBinaryMembers(BufferWriter& writer) const
+  {
+    std::vector<EventTiming> const& timings = *d_eventTimings;
+
+    ASSERT(timings.size() <= UINT16_MAX);
+
+    writer.writeInt32u(static_cast<uint32_t>(d_cycleNumber));
+    writer.writeFloat32(static_cast<float>(d_averageFps));
+    writer.writeInt16u(static_cast<uint16_t>(timings.size()));
+    for (EventTiming const& timing : timings)
+    {
+      // Event names longer than a str8 allows are truncated
+      uint8_t nameLength = static_cast<uint8_t>(std::min<size_t>(timing.second.size(), UINT8_MAX));
+      writer.writeInt8u(nameLength);
+      writer.writeBytes(timing.second.data(), nameLength);
+      writer.writeFloat32(static_cast<float>(timing.first));
+    }
+  }
+
   class MotionTimingState : public TimingState
   {
   public:
@@ -76,8 +150,54 @@ namespace bold
   class ThinkTimingState : public TimingState
   {
   public:
-    ThinkTimingState(std::shared_ptr<std::vector<EventTiming>> eventTimings, ulong cycleNumber, double averageFps)
-    : TimingState(eventTimings, cycleNumber, averageFps)
+    ThinkTimingState(std::shared_ptr<std::vector<EventTiming>> eventTimings, ulong cycleNumber, double averageFps, ulong framePoolAllocationCount)
+    : TimingState(eventTimings, cycleNumber, averageFps),
+      d_framePoolAllocationCount(framePoolAllocationCount)
     {}
+
+    void writeJson(rapidjson::Writer<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
+    void writeJson(rapidjson::Writer<WebSocketBuffer>& writer) const override { writeJsonInternal(writer); }
+    void writeJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer) const override { writeJsonInternal(writer); }
+
+    void writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const override
+    {
+      beginBinarySchema(writer);
+      {
+        writeBinarySchemaMembers(writer);
+        writeBinaryField(writer, "framePoolAllocations", "u32");
+      }
+      endBinarySchema(writer);
+    }
+
+    void writeBinary(WebSocketBuffer& buffer) const override
+    {
+      size_t payloadSize = getBinaryMembersSize() + 4;
+      BufferWriter writer = beginBinary(buffer, payloadSize);
+      writeBinaryMembers(writer);
+      writer.writeInt32u(static_cast<uint32_t>(d_framePoolAllocationCount));
+      ASSERT(writer.pos() == BinaryHeaderSize + payloadSize);
+    }
+
+    /** The number of allocations made by the camera's frame pool during this think cycle. Zero in the steady state.
+     *
+     * Only counts the pool's own buffers for captured images and label data.
+     * Other allocations made by the vision loop are not included.
+     */
+    ulong getFramePoolAllocationCount() const { return d_framePoolAllocationCount; }
+
+  private:
+    template<typename TBuffer>
+    void writeJsonInternal(rapidjson::Writer<TBuffer>& writer) const
+    {
+      writer.StartObject();
+      {
+        writeJsonMembers(writer);
+        writer.String("framePoolAllocations");
+        writer.Uint64(d_framePoolAllocationCount);
+      }
+      writer.EndObject();
+    }
+
+    ulong d_framePoolAllocationCount;
   };
 }
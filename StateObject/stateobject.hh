@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include "../util/assert.hh"
+#include "../util/bufferwriter.hh"
 #include "../util/websocketbuffer.hh"
 
 namespace bold
@@ -28,6 +31,24 @@ namespace bold
     virtual void writeJson(rapidjson::Writer<WebSocketBuffer>& writer) const = 0;
     virtual void writeJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer) const = 0;
 
+    /** Whether this type has a compact binary encoding, offered to clients of high rate streams as an alternative to JSON. */
+    virtual bool hasBinaryEncoding() const { return false; }
+
+    /** Describes the fields written by writeBinary.
+     *
+     * Clients receive this JSON once, before the first binary message, so
+     * that they can decode the packed fields that follow.
+     */
+    virtual void writeBinarySchemaJson(rapidjson::Writer<WebSocketBuffer>& writer) const {}
+
+    /** Appends the binary encoding: a header of the encoding version and payload size, then packed little endian fields. */
+    virtual void writeBinary(WebSocketBuffer& buffer) const {}
+
+    /// The layout version of binary messages, sent in each header and in the schema
+    static constexpr uint8_t BinaryEncodingVersion = 1;
+    /// A uint8 encoding version followed by a uint16 payload size
+    static constexpr size_t BinaryHeaderSize = 3;
+
     template<typename TBuffer, typename TState>
     static void writeJsonOrNull(rapidjson::Writer<TBuffer>& writer, std::shared_ptr<TState const> const& stateObject)
     {
@@ -38,5 +59,79 @@ namespace bold
       else
         writer.Null();
     }
+
+  protected:
+    /** Appends the header of a binary message, reserving its payload, and returns a writer positioned at the payload. */
+    static BufferWriter beginBinary(WebSocketBuffer& buffer, size_t payloadSize)
+    {
+      ASSERT(payloadSize <= UINT16_MAX);
+
+      BufferWriter writer(reinterpret_cast<char*>(buffer.Push(BinaryHeaderSize + payloadSize)));
+      writer.writeInt8u(BinaryEncodingVersion);
+      writer.writeInt16u(static_cast<uint16_t>(payloadSize));
+      return writer;
+    }
+
+    /** Opens the schema written by writeBinarySchemaJson. Fields are then described with writeBinaryField and closed with endBinarySchema. */
+    static void beginBinarySchema(rapidjson::Writer<WebSocketBuffer>& writer)
+    {
+      writer.StartObject();
+      writer.String("version");
+      writer.Uint(BinaryEncodingVersion);
+      writer.String("fields");
+      writer.StartArray();
+    }
+
+    static void endBinarySchema(rapidjson::Writer<WebSocketBuffer>& writer)
+    {
+      writer.EndArray();
+      writer.EndObject();
+    }
+
+    /** Describes a field of type u8, u16, i16, u32, f32, bool (one byte) or str8 (a u8 length then that many bytes), repeated count times. */
+    static void writeBinaryField(rapidjson::Writer<WebSocketBuffer>& writer, char const* name, char const* type, unsigned count = 1)
+    {
+      writer.StartObject();
+      writer.String("name");
+      writer.String(name);
+      writer.String("type");
+      writer.String(type);
+      if (count != 1)
+      {
+        writer.String("count");
+        writer.Uint(count);
+      }
+      writer.EndObject();
+    }
+
+    /** Opens a group of fields repeated count times. Describe its fields, then call endBinaryGroup. */
+    static void beginBinaryGroup(rapidjson::Writer<WebSocketBuffer>& writer, char const* name, unsigned count)
+    {
+      writer.StartObject();
+      writer.String("name");
+      writer.String(name);
+      writer.String("count");
+      writer.Uint(count);
+      writer.String("fields");
+      writer.StartArray();
+    }
+
+    /** Opens a group of fields whose number of repetitions is written before them, as a field of countType. */
+    static void beginBinaryGroup(rapidjson::Writer<WebSocketBuffer>& writer, char const* name, char const* countType)
+    {
+      writer.StartObject();
+      writer.String("name");
+      writer.String(name);
+      writer.String("count-type");
+      writer.String(countType);
+      writer.String("fields");
+      writer.StartArray();
+    }
+
+    static void endBinaryGroup(rapidjson::Writer<WebSocketBuffer>& writer)
+    {
+      writer.EndArray();
+      writer.EndObject();
+    }
   };
 }
@@ -2,6 +2,7 @@
 
 #include "../Camera/camera.hh"
 #include "../CameraModel/cameramodel.hh"
+#include "../Clock/clock.hh"
 #include "../DataStreamer/datastreamer.hh"
 #include "../ImageLabeller/imagelabeller.hh"
 #include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
@@ -12,12 +13,15 @@
 #include "../ImagePassHandler/LabelCountPass/labelcountpass.hh"
 #include "../ImagePassHandler/LineDotPass/linedotpass.hh"
 #include "../ImagePassRunner/imagepassrunner.hh"
-#include "../LineFinder/ScanningLineFinder/scanninglinefinder.hh"
+#include "../ImageSampleMap/imagesamplemap.hh"
+#include "../RowLabelCache/rowlabelcache.hh"
 #include "../LUTBuilder/lutbuilder.hh"
+#include "../LUTCache/lutcache.hh"
 #include "../Spatialiser/spatialiser.hh"
 #include "../State/state.hh"
 #include "../StateObject/BodyState/bodystate.hh"
 #include "../MotionModule/HeadModule/headmodule.hh"
+#include "../util/workerpool.hh"
 
 using namespace bold;
 using namespace Eigen;
@@ -32,6 +36,11 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
     d_cameraModel(cameraModel),
     d_dataStreamer(dataStreamer),
     d_spatialiser(spatialiser),
+    d_sampleMapStale(true),
+    d_previousCameraRotation(Matrix3d::Identity()),
+    d_skippedFrameCount(0),
+    d_coarseSampleMapGranularity(0),
+    d_requestedLineFinderType(LineFinderType::Scanning),
     d_saveNextYUVFrame(false),
     d_saveNextDebugFrame(false)
 {
@@ -46,6 +55,15 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
   d_shouldDetectBlobs         = Config::getSetting<bool>("vision.blob-detection.enable");
 
   d_shouldIgnoreAboveHorizon  = Config::getSetting<bool>("vision.ignore-above-horizon");
+  d_sampleMapToleranceDegrees = Config::getSetting<double>("vision.sample-map-tolerance-degrees");
+  d_temporalCoherenceEnabled  = Config::getSetting<bool>("vision.temporal-coherence.enable");
+  d_stillToleranceDegrees     = Config::getSetting<double>("vision.temporal-coherence.still-tolerance-degrees");
+  d_maxSkippedFrames          = Config::getSetting<int>("vision.temporal-coherence.max-skipped-frames");
+  d_roiEnabled                = Config::getSetting<bool>("vision.roi.enable");
+  d_roiCoarseGranularity      = Config::getSetting<int>("vision.roi.coarse-granularity");
+  d_roiMarginPixels           = Config::getSetting<int>("vision.roi.margin-pixels");
+  d_roiMaxAgeFrames           = Config::getSetting<int>("vision.roi.max-age-frames");
+  d_roiMaxCount               = Config::getSetting<int>("vision.roi.max-regions");
   d_isRecordingYUVFrames      = Config::getSetting<bool>("camera.recording-frames");
 
   d_streamFramePeriod         = Config::getSetting<int>("round-table.camera-frame-frequency");
@@ -114,28 +132,71 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
     vector<shared_ptr<PixelLabel>>({ goalLabel, ballLabel, cyanLabel, magentaLabel }) :
     vector<shared_ptr<PixelLabel>>({ goalLabel, ballLabel });
 
-  d_imageLabeller = make_shared<ImageLabeller>(d_spatialiser);
+  // Threads shared by labelling and image passes, which never run at the same time
+  auto workerPool = make_shared<WorkerPool>("Vision", Config::getStaticValue<int>("vision.worker-threads"));
+
+  d_imageLabeller = make_shared<ImageLabeller>(d_spatialiser, workerPool);
+
+  Config::getSetting<bool>("vision.labelling.parallel")->track([this](bool value) { d_imageLabeller->setParallel(value); });
 
   d_labelTeacher = unique_ptr<LabelTeacher>{new LabelTeacher{d_pixelLabels}};
 
-  auto createLookupTable = [this]()
+  log::info("VisualCortex::VisualCortex") << "Creating pixel label LUT";
+  for (shared_ptr<PixelLabel> label : d_rangePixelLabels)
+    log::verbose("VisualCortex::VisualCortex") << "  " << *label;
+
+  auto lutStartTime = Clock::getTimestamp();
+
+  uchar lutBitsPerChannel = Config::getStaticValue<int>("vision.lut-bits-per-channel");
+  string lutName = LookUpTable::getName(LUTColourSpace::YCbCr, lutBitsPerChannel);
+
+  if (Config::getStaticValue<bool>("vision.lut-cache.enable"))
   {
-    log::info("VisualCortex::VisualCortex") << "Creating pixel label LUT";
-    for (shared_ptr<PixelLabel> label : d_rangePixelLabels)
-      log::verbose("VisualCortex::VisualCortex") << "  " << *label;
+    d_lutCache = unique_ptr<LUTCache>(new LUTCache(
+      Config::getStaticValue<string>("vision.lut-cache.directory"),
+      Config::getStaticValue<int>("vision.lut-cache.max-entries"),
+      Config::getStaticValue<double>("vision.lut-cache.store-delay-seconds")));
 
-    d_imageLabeller->updateLut(LUTBuilder::buildLookUpTableYCbCr18(d_pixelLabels));
-  };
+    auto key = LUTCache::getKey(lutName, d_pixelLabels);
+    d_lut = d_lutCache->load(key, LUTColourSpace::YCbCr, lutBitsPerChannel);
 
-  createLookupTable();
+    if (d_lut)
+      log::info("VisualCortex::VisualCortex") << "Loaded pixel label LUT " << key << " from cache in " << Clock::getMillisSince(lutStartTime) << " ms";
+  }
 
-  // Recreate lookup table on dynamic configuration changes
-  auto bindLabel = [createLookupTable](string name, shared_ptr<RangePixelLabel> label)
+  if (!d_lut)
   {
+    // The vision loop isn't running yet, so the initial build may use its threads
+    d_lut = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, lutBitsPerChannel, d_pixelLabels, workerPool.get());
+
+    log::info("VisualCortex::VisualCortex") << "Built " << lutName << " pixel label LUT in " << Clock::getMillisSince(lutStartTime) << " ms";
+
+    if (d_lutCache)
+      d_lutCache->store(LUTCache::getKey(lutName, d_pixelLabels), d_lut);
+  }
+
+  d_imageLabeller->updateLut(d_lut);
+
+  // The rebuild thread labels against its own copies of the labels, so that
+  // settings changes on other threads can't alter them mid-rebuild
+  for (auto const& label : d_rangePixelLabels)
+    d_lutLabels.push_back(make_shared<RangePixelLabel>(*label));
+
+  // Update the lookup table on dynamic configuration changes. This happens on a
+  // background thread, so that tuning ranges never stalls the think loop.
+  d_lutRebuildQueue = unique_ptr<ConsumerQueueThread<LutRangeChange>>(new ConsumerQueueThread<LutRangeChange>(
+    "LUT Rebuild",
+    [this](LutRangeChange change) { rebuildLut(change.first, change.second); }));
+
+  auto bindLabel = [this](string name, shared_ptr<RangePixelLabel> label)
+  {
+    unsigned labelIndex = find(d_rangePixelLabels.begin(), d_rangePixelLabels.end(), label) - d_rangePixelLabels.begin();
+    ASSERT(labelIndex < d_rangePixelLabels.size());
+
     auto setting = Config::getSetting<Colour::hsvRange>(string("vision.pixel-labels.") + name);
-    setting->changed.connect([label,createLookupTable](Colour::hsvRange value) {
+    setting->changed.connect([this,label,labelIndex](Colour::hsvRange value) {
       label->setHSVRange(value);
-      createLookupTable();
+      d_lutRebuildQueue->push(make_pair(labelIndex, value));
     });
   };
   bindLabel("goal", goalLabel);
@@ -149,15 +210,22 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
   d_minBallAreaPixels              = Config::getSetting<int>("vision.ball-detection.min-area-px");
   d_maxBallFieldEdgeDistPixels     = Config::getSetting<int>("vision.ball-detection.max-field-edge-distance-px");
   d_acceptedBallMeasuredSizeRatio  = Config::getSetting<Range<double>>("vision.ball-detection.accepted-size-ratio");
+  d_ballIntegralValidationEnabled  = Config::getSetting<bool>("vision.ball-detection.integral-validation.enable");
+  d_minBallFillRatio               = Config::getSetting<double>("vision.ball-detection.integral-validation.min-fill-ratio");
+  d_ballRingWidthPixels            = Config::getSetting<int>("vision.ball-detection.integral-validation.ring-width-px");
+  d_minBallRingSurroundRatio       = Config::getSetting<double>("vision.ball-detection.integral-validation.min-ring-surround-ratio");
 
   // goal detection settings
   d_minGoalDimensionPixels         = Config::getSetting<int>("vision.goal-detection.min-dimension-px");
   d_maxGoalFieldEdgeDistPixels     = Config::getSetting<int>("vision.goal-detection.max-field-edge-distance-px");
   d_acceptedGoalMeasuredWidthRatio = Config::getSetting<Range<double>>("vision.goal-detection.accepted-width-ratio");
+  d_minGoalEccentricity            = Config::getSetting<double>("vision.goal-detection.min-eccentricity");
+  d_maxGoalTiltDegrees             = Config::getSetting<double>("vision.goal-detection.max-tilt-degrees");
 
   // player detection settings
   d_minPlayerAreaPixels            = Config::getSetting<int>("vision.player-detection.min-area-px");
   d_minPlayerLengthPixels          = Config::getSetting<int>("vision.player-detection.min-length-px");
+  d_maxPlayerEccentricity          = Config::getSetting<double>("vision.player-detection.max-eccentricity");
   d_goalieMarkerHeight             = Config::getSetting<double>("vision.player-detection.goalie-marker-height");
 
   // Field thresholding
@@ -169,15 +237,24 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
 
   d_lineDotPass = make_shared<LineDotPass>(imageWidth, fieldLabel, lineLabel);
   d_blobDetectPass = make_shared<BlobDetectPass>(imageWidth, imageHeight, blobPixelLabels);
+  // Goal detection measures the width of goal posts from their runs
+  d_blobDetectPass->setCollectRuns(goalLabel, true);
+  d_rowLabelCache = unique_ptr<RowLabelCache>(new RowLabelCache(imageHeight, Config::getValue<double>("vision.temporal-coherence.max-mean-delta")));
+  Config::getSetting<double>("vision.temporal-coherence.max-mean-delta")->changed.connect(
+    [this](double value) { d_rowLabelCache->setMaxMeanDelta(value); });
+  d_roiBlobDetectPass = make_shared<BlobDetectPass>(imageWidth, imageHeight, blobPixelLabels);
+  d_roiBlobDetectPass->setCollectRuns(goalLabel, true);
   d_cartoonPass = make_shared<CartoonPass>(imageWidth, imageHeight);
   auto labelCountPass = make_shared<LabelCountPass>(d_pixelLabels);
   auto completeFieldEdgePass = make_shared<CompleteFieldEdgePass>(fieldLabel, imageWidth, imageHeight);
   auto periodicFieldEdgePass = make_shared<PeriodicFieldEdgePass>(fieldLabel, lineLabel, imageWidth, imageHeight, 1*2*3*4);
   d_fieldHistogramPass = make_shared<FieldHistogramPass>(fieldLabel, imageHeight);
 
-  d_imagePassRunner = make_shared<ImagePassRunner>();
+  d_imagePassRunner = make_shared<ImagePassRunner>(workerPool);
   d_imagePassRunner->addHandler(d_fieldHistogramPass);
 
+  Config::getSetting<bool>("vision.image-passes.parallel")->track([this](bool value) { d_imagePassRunner->setParallel(value); });
+
   Config::getSetting<FieldEdgeType>("vision.field-edge-pass.field-edge-type")->track(
     [this,periodicFieldEdgePass,completeFieldEdgePass]
     (FieldEdgeType fieldEdgeType)
@@ -185,13 +262,18 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
       switch (fieldEdgeType)
       {
         case FieldEdgeType::Complete:
-          d_imagePassRunner->removeHandler(periodicFieldEdgePass);
-          d_imagePassRunner->addHandler(completeFieldEdgePass);
+          // Swap the pass and the line dot pass's dependency upon it together, between passes
+          d_imagePassRunner->replaceHandler(periodicFieldEdgePass, completeFieldEdgePass, [this,completeFieldEdgePass]
+          {
+            d_lineDotPass->setFieldEdgePass(completeFieldEdgePass);
+          });
           d_fieldEdgePass = completeFieldEdgePass;
           break;
         case FieldEdgeType::Periodic:
-          d_imagePassRunner->removeHandler(completeFieldEdgePass);
-          d_imagePassRunner->addHandler(periodicFieldEdgePass);
+          d_imagePassRunner->replaceHandler(completeFieldEdgePass, periodicFieldEdgePass, [this,periodicFieldEdgePass]
+          {
+            d_lineDotPass->setFieldEdgePass(periodicFieldEdgePass);
+          });
           d_fieldEdgePass = periodicFieldEdgePass;
           break;
       }
@@ -232,27 +314,17 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
           auto maxGranularity = Config::getSetting<int>("vision.max-granularity");
           d_granularityFunction = [this,maxGranularity](int y) mutable
           {
-            Vector2d referencePixel(d_cameraModel->imageWidth()/2, y);
-
-            Maybe<Vector3d> midLineAgentSpace = d_spatialiser->findGroundPointForPixel(referencePixel);
-
-            int pixelDelta = numeric_limits<int>::max();
-
-            if (midLineAgentSpace)
-            {
-              double desiredDistanceMetres = 0.01; // TODO as setting
-              Vector3d offsetAgentSpace(*midLineAgentSpace + Vector3d(desiredDistanceMetres, 0, 0));
-              Maybe<Vector2d> offsetPixel = d_spatialiser->findPixelForAgentPoint(offsetAgentSpace);
-
-              if (offsetPixel)
-                pixelDelta = (int)round(abs((*offsetPixel - referencePixel).norm()));
-            }
+            double desiredDistanceMetres = 0.01; // TODO as setting
+            Maybe<double> pixelDistance = d_spatialiser->findPixelDistanceForGroundStep(y, desiredDistanceMetres);
 
             auto max = maxGranularity->getValue();
 
-            if (pixelDelta > max)
-              pixelDelta = max;
-            else if (pixelDelta < 1)
+            // Rows above the horizon use the coarsest granularity
+            int pixelDelta = pixelDistance && *pixelDistance < max
+              ? (int)round(*pixelDistance)
+              : max;
+
+            if (pixelDelta < 1)
               pixelDelta = 1;
 
             return Eigen::Matrix<uchar,2,1>(pixelDelta, pixelDelta);
@@ -260,9 +332,13 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
           break;
         }
       }
+
+      d_sampleMapStale = true;
     }
   );
 
+  Config::getSetting<int>("vision.max-granularity")->changed.connect([this](int) { d_sampleMapStale = true; });
+
   d_shouldDetectLines->track([this](bool value) { d_imagePassRunner->setHandler(d_lineDotPass, value); });
   d_shouldCountLabels->track([this,labelCountPass](bool value) { d_imagePassRunner->setHandler(labelCountPass, value); });
   d_shouldDetectBlobs->track([this](bool value)
@@ -282,9 +358,16 @@ VisualCortex::VisualCortex(shared_ptr<Camera> camera,
   d_imageType->track([setCartoonHandler](ImageType value) { setCartoonHandler(); });
   d_dataStreamer->hasClientChanged.connect([setCartoonHandler](std::string protocol, bool enabled) { if (protocol == "camera-protocol") setCartoonHandler(); });
 
-  d_lineFinder = make_shared<ScanningLineFinder>(d_cameraModel);
+  // The finder is replaced on the think thread, which may be using the current one
+  Config::getSetting<LineFinderType>("vision.line-detection.line-finder")->track(
+    [this](LineFinderType lineFinderType) { d_requestedLineFinderType = lineFinderType; });
 
   // Image capture
   Config::addAction("camera.save-yuv-frame",   "Save YUV Frame",   [this] { d_saveNextYUVFrame   = true; });
   Config::addAction("camera.save-debug-frame", "Save Debug Frame", [this] { d_saveNextDebugFrame = true; });
 }
+
+VisualCortex::~VisualCortex()
+{
+  d_lutRebuildQueue->stop();
+}
@@ -0,0 +1,59 @@
+#include "visualcortex.hh"
+
+#include "../BallValidationImage/ballvalidationimage.hh"
+#include "../ImageLabeller/imagelabeller.hh"
+#include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
+
+using namespace bold;
+using namespace cv;
+using namespace Eigen;
+using namespace std;
+
+vector<BallValidationImage> VisualCortex::buildBallValidationImages(Camera::Frame& frame, vector<Blob> const& ballBlobs)
+{
+  int width = frame.getWidth();
+  int height = frame.getHeight();
+  Vector2i ringWidth = Vector2i::Constant(d_ballRingWidthPixels->getValue());
+
+  uchar ballLabel = uchar(LabelClass::BALL);
+  uchar fieldLabel = uchar(LabelClass::FIELD);
+  uchar lineLabel = uchar(LabelClass::LINE);
+
+  vector<BallValidationImage> images;
+
+  // Label each candidate and the ring around it, rather than all rows between
+  // candidates, which may be far apart
+  for (Blob const& blob : ballBlobs)
+  {
+    if (!isBallBlobLargeEnough(blob))
+      continue;
+
+    Bounds2i region((blob.ul.cast<int>() - ringWidth).cwiseMax(0),
+                    (blob.br.cast<int>() + ringWidth).cwiseMin(Vector2i(width - 1, height - 1)));
+
+    ImageLabelData labelData = frame.hasYUYV()
+      ? d_imageLabeller->labelRegionYUYV(frame.getYUYV(), width, height, region, move(d_roiLabels), move(d_roiRows))
+      : d_imageLabeller->labelRegion(frame.getImage(), region, move(d_roiLabels), move(d_roiRows));
+
+    Mat ballMask(region.height() + 1, region.width() + 1, CV_8UC1);
+    Mat surroundingsMask(region.height() + 1, region.width() + 1, CV_8UC1);
+
+    for (RowLabels const& row : labelData)
+    {
+      int y = row.imageY - region.min().y();
+      uchar* ball = ballMask.ptr<uchar>(y);
+      uchar* surroundings = surroundingsMask.ptr<uchar>(y);
+      for (uchar label : row)
+      {
+        *(ball++) = label == ballLabel ? 1 : 0;
+        *(surroundings++) = label == fieldLabel || label == lineLabel ? 1 : 0;
+      }
+    }
+
+    labelData.recycle(d_roiLabels, d_roiRows);
+
+    images.emplace_back(ballMask, surroundingsMask, region);
+  }
+
+  return images;
+}
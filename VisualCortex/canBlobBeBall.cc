@@ -1,5 +1,6 @@
 #include "visualcortex.hh"
 
+#include "../BallValidationImage/ballvalidationimage.hh"
 #include "../FieldMap/fieldmap.hh"
 #include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
 #include "../ImagePassHandler/FieldEdgePass/fieldedgepass.hh"
@@ -10,7 +11,12 @@ using namespace cv;
 using namespace Eigen;
 using namespace std;
 
-bool VisualCortex::canBlobBeBall(Blob const& blob, Vector2d& imagePos, Vector3d& agentFramePos)
+bool VisualCortex::isBallBlobLargeEnough(Blob const& blob) const
+{
+  return blob.area != 0 && blob.area >= unsigned(d_minBallAreaPixels->getValue());
+}
+
+bool VisualCortex::canBlobBeBall(Blob const& blob, vector<BallValidationImage> const* validation, Vector2d& imagePos, Vector3d& agentFramePos)
 {
   //
   // Basic filtering
@@ -18,7 +24,7 @@ bool VisualCortex::canBlobBeBall(Blob const& blob, Vector2d& imagePos, Vector3d&
 
   // Ignore balls that are too small (avoid noise)
   // Also ignores blobs that were previously merged into another blob (zero area)
-  if (blob.area < unsigned(d_minBallAreaPixels->getValue()))
+  if (!isBallBlobLargeEnough(blob))
     return false;
 
   // Ignore ball if it is too far from the field edge
@@ -31,6 +37,24 @@ bool VisualCortex::canBlobBeBall(Blob const& blob, Vector2d& imagePos, Vector3d&
     return false;
   }
 
+  //
+  // Verify the blob's shape against full resolution labels
+  //
+
+  if (validation)
+  {
+    Bounds2i box(blob.ul.cast<int>(), blob.br.cast<int>());
+
+    auto image = find_if(validation->begin(), validation->end(),
+                         [&box](BallValidationImage const& image) { return image.contains(box); });
+
+    if (image == validation->end())
+      return false;
+
+    if (!image->isBallShaped(box, d_minBallFillRatio->getValue(), d_ballRingWidthPixels->getValue(), d_minBallRingSurroundRatio->getValue()))
+      return false;
+  }
+
   //
   // Verify blob is about the expected pixel size at that position of the frame
   //
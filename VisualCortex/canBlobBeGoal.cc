@@ -1,6 +1,7 @@
 #include "visualcortex.hh"
 
 #include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
+#include "../Math/math.hh"
 #include "../Spatialiser/spatialiser.hh"
 
 using namespace bold;
@@ -9,6 +10,15 @@ using namespace Eigen;
 
 bool VisualCortex::canBlobBeGoal(Blob const& blob, Vector2d& pos)
 {
+  // Goal posts are upright and elongated. Reject blobs which spread evenly,
+  // or whose principal axis leans too far from vertical.
+  if (blob.eccentricity() < d_minGoalEccentricity->getValue())
+    return false;
+
+  double tilt = M_PI/2 - fabs(blob.orientation());
+  if (tilt > Math::degToRad(d_maxGoalTiltDegrees->getValue()))
+    return false;
+
   // Find a measure of the width of the goal post in agent space
 
   // Take center of topmost run (the first) (bottom in image)
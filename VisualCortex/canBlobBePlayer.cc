@@ -21,6 +21,10 @@ bool VisualCortex::canBlobBePlayer(Blob const& playerBlob, Vector2d& imagePos, V
       playerBlob.bounds().width() < d_minPlayerLengthPixels->getValue())
     return false;
 
+  // Reject thin streaks, such as those along line or field edges
+  if (playerBlob.eccentricity() > d_maxPlayerEccentricity->getValue())
+    return false;
+
   // TODO the transform created in findGroundPointForPixel should only be created once (canBlobBePlayer is called in a loop)
 
   auto midPointAgentSpace = d_spatialiser->findGroundPointForPixel(playerBlob.mean.cast<double>(), d_goalieMarkerHeight->getValue());
@@ -0,0 +1,28 @@
+#include "visualcortex.hh"
+
+#include "../CameraModel/cameramodel.hh"
+#include "../LineFinder/HoughLineFinder/houghlinefinder.hh"
+#include "../LineFinder/MaskWalkLineFinder/maskwalklinefinder.hh"
+#include "../LineFinder/RandomPairLineFinder/randompairlinefinder.hh"
+#include "../LineFinder/ScanningLineFinder/scanninglinefinder.hh"
+
+using namespace bold;
+using namespace std;
+
+shared_ptr<LineFinder> VisualCortex::createLineFinder(LineFinderType lineFinderType) const
+{
+  switch (lineFinderType)
+  {
+    case LineFinderType::Scanning:
+      return make_shared<ScanningLineFinder>(d_cameraModel);
+    case LineFinderType::MaskWalk:
+      return make_shared<MaskWalkLineFinder>();
+    case LineFinderType::RandomPair:
+      return make_shared<RandomPairLineFinder>(d_cameraModel->imageWidth(), d_cameraModel->imageHeight());
+    case LineFinderType::Hough:
+      return make_shared<HoughLineFinder>(d_cameraModel->imageWidth(), d_cameraModel->imageHeight());
+  }
+
+  log::error("VisualCortex::createLineFinder") << "Unknown line finder type: " << (int)lineFinderType;
+  throw runtime_error("Unknown line finder type");
+}
@@ -1,13 +1,15 @@
 #include "visualcortex.hh"
 
+#include "../BallValidationImage/ballvalidationimage.hh"
 #include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
 #include "../SequentialTimer/sequentialtimer.hh"
+#include "../util/memory.hh"
 
 using namespace bold;
 using namespace Eigen;
 using namespace std;
 
-Maybe<Vector2d> VisualCortex::detectBall(vector<Blob>& ballBlobs, SequentialTimer& t)
+Maybe<Vector2d> VisualCortex::detectBall(vector<Blob>& ballBlobs, Camera::Frame& frame, SequentialTimer& t, vector<Bounds2<ushort>>& observedBounds)
 {
   Maybe<Vector2d> ballPosition = Maybe<Vector2d>::empty();
 
@@ -21,7 +23,7 @@ Maybe<Vector2d> VisualCortex::detectBall(vector<Blob>& ballBlobs, SequentialTime
       if (larger.area == 0)
         continue;
 
-      if (larger.area < unsigned(d_minBallAreaPixels->getValue()))
+      if (!isBallBlobLargeEnough(larger))
       {
         // Blobs are sorted, largest first, so if this is too small, the rest will be too
         break;
@@ -45,15 +47,28 @@ Maybe<Vector2d> VisualCortex::detectBall(vector<Blob>& ballBlobs, SequentialTime
     t.timeEvent("Ball Blob Merging");
   }
 
+  // Label the pixels around candidates at full resolution, so their shape can be checked
+  unique_ptr<vector<BallValidationImage>> validation;
+  if (d_ballIntegralValidationEnabled->getValue())
+  {
+    validation = make_unique<vector<BallValidationImage>>(buildBallValidationImages(frame, ballBlobs));
+    t.timeEvent("Ball Validation Images");
+  }
+
   // The first is the biggest, topmost ball blob
   auto ballPositionCandidates = vector<pair<Vector2d, Vector3d>>();
+  // Bounds of each candidate's blob
+  vector<Bounds2<ushort>> candidateBounds;
 
   // Filter out invalid ball blobs
   Vector2d imagePos;
   Vector3d agentFramePos;
   for (Blob const& ballBlob : ballBlobs)
-    if (canBlobBeBall(ballBlob, imagePos, agentFramePos))
+    if (canBlobBeBall(ballBlob, validation.get(), imagePos, agentFramePos))
+    {
       ballPositionCandidates.push_back(make_pair(imagePos, agentFramePos));
+      candidateBounds.push_back(ballBlob.bounds());
+    }
       
   // Take the ball that is closest
   if (ballPositionCandidates.size() == 0)
@@ -65,6 +80,7 @@ Maybe<Vector2d> VisualCortex::detectBall(vector<Blob>& ballBlobs, SequentialTime
                                  return pos1.second.head<2>().norm() < pos2.second.head<2>().norm();
                                });
     ballPosition = Maybe<Vector2d>(nearest->first);
+    observedBounds.push_back(candidateBounds[distance(ballPositionCandidates.begin(), nearest)]);
   }
   t.timeEvent("Ball Blob Selection");
 
@@ -0,0 +1,103 @@
+#include "visualcortex.hh"
+
+#include "../CameraModel/cameramodel.hh"
+#include "../ImageLabeller/imagelabeller.hh"
+#include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
+#include "../SequentialTimer/sequentialtimer.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace bold;
+using namespace Eigen;
+using namespace std;
+
+unsigned VisualCortex::detectBlobsInRegionsOfInterest(Camera::Frame& frame, Matrix3d const& agentCameraRotation,
+                                                      map<shared_ptr<PixelLabel>,vector<Blob>>& blobsPerLabel,
+                                                      SequentialTimer& t)
+{
+  int width = frame.getWidth();
+  int height = frame.getHeight();
+  Vector2i imageMax(width - 1, height - 1);
+
+  // Blobs taken from regions, so that a blob lying within overlapping regions is only added once
+  vector<ImageBounds> addedBounds;
+
+  unsigned pixelCount = 0;
+
+  for (RegionOfInterest const& roi : d_regionsOfInterest)
+  {
+    // Predict where the region now appears, given how the camera has turned since the object was seen
+    auto centre = d_cameraModel->pixelForDirection(agentCameraRotation.transpose() * roi.agentDirection);
+    if (!centre.hasValue())
+      continue;
+
+    Vector2i centrePixel(int(round(centre->x())), int(round(centre->y())));
+    Vector2i min = (centrePixel - roi.halfSize).cwiseMax(Vector2i::Zero());
+    Vector2i max = (centrePixel + roi.halfSize).cwiseMin(imageMax);
+
+    // Skip regions that have moved out of the image, or are too thin to find runs in
+    if (max.x() - min.x() < 2 || max.y() - min.y() < 2)
+      continue;
+
+    Bounds2i region(min, max);
+
+    ImageLabelData labelData = frame.hasYUYV()
+      ? d_imageLabeller->labelRegionYUYV(frame.getYUYV(), width, height, region, move(d_roiLabels), move(d_roiRows))
+      : d_imageLabeller->labelRegion(frame.getImage(), region, move(d_roiLabels), move(d_roiRows));
+    pixelCount += (region.width() + 1) * (region.height() + 1);
+    t.timeEvent("Label");
+
+    d_roiBlobDetectPass->process(labelData, t);
+    labelData.recycle(d_roiLabels, d_roiRows);
+    auto const& regionBlobsPerLabel = d_roiBlobDetectPass->detectBlobs(t);
+
+    // Region rows hold image y values, but region x values start at the region's left edge
+    ImagePos offset(min.x(), 0);
+
+    auto isWithinRegion = [&](Blob const& blob)
+    {
+      return blob.ul.x() >= min.x() && blob.ul.y() >= min.y()
+          && blob.br.x() <= max.x() && blob.br.y() <= max.y();
+    };
+
+    // A blob touching one of the region's edges may continue beyond it, unless that edge is also the image's
+    auto isCutByRegion = [&](Blob const& blob)
+    {
+      return (blob.ul.x() == min.x() && min.x() > 0)
+          || (blob.ul.y() == min.y() && min.y() > 0)
+          || (blob.br.x() == max.x() && max.x() < imageMax.x())
+          || (blob.br.y() == max.y() && max.y() < imageMax.y());
+    };
+
+    for (auto const& pair : regionBlobsPerLabel)
+    {
+      auto& blobs = blobsPerLabel[pair.first];
+
+      // Full resolution blobs supersede the coarse ones found within the region
+      blobs.erase(remove_if(blobs.begin(), blobs.end(), isWithinRegion), blobs.end());
+
+      for (Blob blob : pair.second)
+      {
+        blob.translate(offset);
+
+        if (isCutByRegion(blob))
+          continue;
+
+        auto bounds = blob.bounds();
+        bool alreadyAdded = any_of(addedBounds.begin(), addedBounds.end(), [&](ImageBounds const& b)
+        {
+          return b.min() == bounds.min() && b.max() == bounds.max();
+        });
+        if (alreadyAdded)
+          continue;
+
+        addedBounds.push_back(bounds);
+        blobs.push_back(move(blob));
+      }
+    }
+    t.timeEvent("Blob Detect");
+  }
+
+  return pixelCount;
+}
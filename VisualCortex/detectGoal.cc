@@ -8,7 +8,7 @@ using namespace bold;
 using namespace Eigen;
 using namespace std;
 
-vector<Vector2d,aligned_allocator<Vector2d>> VisualCortex::detectGoal(vector<Blob>& goalBlobs, SequentialTimer& t)
+vector<Vector2d,aligned_allocator<Vector2d>> VisualCortex::detectGoal(vector<Blob>& goalBlobs, SequentialTimer& t, vector<Bounds2<ushort>>& observedBounds)
 {
   vector<Vector2d,aligned_allocator<Vector2d>> goalPositions;
 
@@ -46,6 +46,7 @@ vector<Vector2d,aligned_allocator<Vector2d>> VisualCortex::detectGoal(vector<Blo
       
       goalPositions.push_back(pos);
       acceptedGoalBlobs.push_back(goalBlob);
+      observedBounds.push_back(goalBlob.bounds());
     }
   }
   t.timeEvent("Goal Blob Selection");
@@ -0,0 +1,29 @@
+#include "visualcortex.hh"
+
+#include "../ImageSampleMap/imagesamplemap.hh"
+#include "../util/memory.hh"
+
+using namespace bold;
+using namespace Eigen;
+using namespace std;
+
+ImageSampleMap const& VisualCortex::getCoarseSampleMap(ushort width, ushort height)
+{
+  uchar granularity = uchar(d_roiCoarseGranularity->getValue());
+
+  bool rebuild = !d_coarseSampleMap
+    || d_coarseSampleMapGranularity != granularity
+    || d_coarseSampleMap->getWidth() != width
+    || d_coarseSampleMap->getHeight() != height;
+
+  if (rebuild)
+  {
+    // Uniform granularity, as the regions of interest provide the detail
+    d_coarseSampleMap = make_unique<ImageSampleMap>(
+      [granularity](ushort) { return Matrix<uchar,2,1>(granularity, granularity); },
+      width, height);
+    d_coarseSampleMapGranularity = granularity;
+  }
+
+  return *d_coarseSampleMap;
+}
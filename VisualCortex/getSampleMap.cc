@@ -0,0 +1,45 @@
+#include "visualcortex.hh"
+
+#include "../ImageSampleMap/imagesamplemap.hh"
+#include "../Math/math.hh"
+#include "../State/state.hh"
+#include "../StateObject/BodyState/bodystate.hh"
+#include "../util/memory.hh"
+
+#include <Eigen/Geometry>
+
+using namespace bold;
+using namespace Eigen;
+using namespace std;
+
+ImageSampleMap const& VisualCortex::getSampleMap(ushort width, ushort height)
+{
+  static auto imageGranularity = Config::getSetting<ImageGranularity>("vision.image-granularity");
+
+  // Only projected granularity depends upon the camera's pose
+  bool dependsOnPose = imageGranularity->getValue() == ImageGranularity::Projected;
+
+  Matrix3d cameraRotation = dependsOnPose
+    ? Matrix3d(State::get<BodyState>(StateTime::CameraImage)->getAgentCameraTransform().linear())
+    : Matrix3d::Identity();
+
+  bool rebuild = d_sampleMapStale.exchange(false)
+    || !d_sampleMap
+    || d_sampleMap->getWidth() != width
+    || d_sampleMap->getHeight() != height;
+
+  if (!rebuild && dependsOnPose)
+  {
+    // Angle of the rotation from the pose the map was built for to the current one
+    double angle = AngleAxisd(cameraRotation * d_sampleMapCameraRotation.transpose()).angle();
+    rebuild = angle > Math::degToRad(d_sampleMapToleranceDegrees->getValue());
+  }
+
+  if (rebuild)
+  {
+    d_sampleMap = make_unique<ImageSampleMap>(d_granularityFunction, width, height);
+    d_sampleMapCameraRotation = cameraRotation;
+  }
+
+  return *d_sampleMap;
+}
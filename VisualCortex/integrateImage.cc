@@ -8,7 +8,9 @@
 #include "../ImagePassHandler/FieldEdgePass/fieldedgepass.hh"
 #include "../ImagePassHandler/LineDotPass/linedotpass.hh"
 #include "../LineFinder/linefinder.hh"
+#include "../RowLabelCache/rowlabelcache.hh"
 #include "../State/state.hh"
+#include "../StateObject/BodyState/bodystate.hh"
 #include "../StateObject/CameraFrameState/cameraframestate.hh"
 
 using namespace cv;
@@ -16,15 +18,25 @@ using namespace bold;
 using namespace Eigen;
 using namespace std;
 
-void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCycleNumber)
+void VisualCortex::integrateImage(Camera::Frame& frame, SequentialTimer& t, ulong thinkCycleNumber)
 {
+  //
+  // Switch line finder, if the setting has changed
+  //
+  LineFinderType lineFinderType = d_requestedLineFinderType;
+  if (!d_lineFinder || lineFinderType != d_lineFinderType)
+  {
+    d_lineFinder = createLineFinder(lineFinderType);
+    d_lineFinderType = lineFinderType;
+  }
+
   //
   // Record frame, if required
   //
   static Clock::Timestamp lastRecordTime;
   if (d_saveNextYUVFrame || (d_isRecordingYUVFrames->getValue() && Clock::getSecondsSince(lastRecordTime) > 1.0))
   {
-    saveImage(image, nullptr);
+    saveImage(frame.getImage(), nullptr);
     lastRecordTime = Clock::getTimestamp();
     d_saveNextYUVFrame = false;
     t.timeEvent("Save YUV Frame");
@@ -33,7 +45,7 @@ void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCyc
   if (d_labelTeacher->requestedSnapShot())
   {
     log::info("Label Teacher") << "Setting train image";
-    d_labelTeacher->setYUVTrainImage(image);
+    d_labelTeacher->setYUVTrainImage(frame.getImage());
     t.timeEvent("Save YUV Training Image");
   }
 
@@ -41,18 +53,74 @@ void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCyc
   // PROCESS THE IMAGE
   //
 
-  // Build a map to control sub-sampling from the image
-  ImageSampleMap sampleMap(d_granularityFunction, (ushort)image.cols, (ushort)image.rows);
-  t.timeEvent("Build Sample Map");
+  // Regions of interest follow objects through camera movement, so need the camera's orientation
+  bool trackRegionsOfInterest = d_roiEnabled->getValue() && d_shouldDetectBlobs->getValue();
+  Matrix3d agentCameraRotation = trackRegionsOfInterest
+    ? Matrix3d(State::get<BodyState>(StateTime::CameraImage)->getAgentCameraTransform().linear())
+    : Matrix3d::Identity();
+  if (!trackRegionsOfInterest)
+    d_regionsOfInterest.clear();
+
+  // While objects are being tracked, label the image coarsely and only their regions at full resolution
+  bool useRegionsOfInterest = trackRegionsOfInterest && !d_regionsOfInterest.empty();
+
+  // Obtain a map to control sub-sampling from the image
+  ImageSampleMap const& sampleMap = useRegionsOfInterest
+    ? getCoarseSampleMap(frame.getWidth(), frame.getHeight())
+    : getSampleMap(frame.getWidth(), frame.getHeight());
+  t.timeEvent("Sample Map");
 
-  // Label pixels
+  long processedPixelCount = sampleMap.getPixelCount();
+
+  // Label into the frame's pooled storage, which only grows if the sample map needs more room
+  auto const& buffers = frame.getBuffers();
+  buffers.reserveLabels(sampleMap.getPixelCount(), sampleMap.getSampleRowCount());
+  d_blobDetectPass->reserve(sampleMap);
+
+  // Compare the camera's orientation with the previous frame's every frame, so
+  // that the comparison is current whenever temporal coherence is enabled
+  bool isStill = isCameraStill();
+
+  // While the camera is still, rows unchanged since they were last labelled keep their labels
+  RowLabelCache* rowCache = d_temporalCoherenceEnabled->getValue() && frame.hasYUYV() && isStill
+    ? d_rowLabelCache.get()
+    : nullptr;
+
+  // Label pixels, straight from the camera's buffer if the frame still holds it
   t.enter("Pixel Label");
-  ImageLabelData labelData = d_imageLabeller->label(image, sampleMap, d_shouldIgnoreAboveHorizon->getValue(), t);
+  ImageLabelData labelData = frame.hasYUYV()
+    ? d_imageLabeller->labelYUYV(frame.getYUYV(), frame.getWidth(), frame.getHeight(), sampleMap, d_shouldIgnoreAboveHorizon->getValue(), t, move(buffers->labels), move(buffers->rows), rowCache)
+    : d_imageLabeller->label(frame.getImage(), sampleMap, d_shouldIgnoreAboveHorizon->getValue(), t, move(buffers->labels), move(buffers->rows));
   t.exit();
 
+  // If no row changed, the previous frame's observations still stand, so skip the passes and detection.
+  // A frame is processed in full every so often, so that setting changes take effect.
+  // While regions of interest are in use, only the coarse rows are compared, which may miss changes
+  // within the regions labelled at full resolution, so such frames are never skipped.
+  if (rowCache && !useRegionsOfInterest && rowCache->getChangedRowCount() == 0 && d_skippedFrameCount < unsigned(d_maxSkippedFrames->getValue()))
+  {
+    auto previous = State::get<CameraFrameState>();
+    if (previous)
+    {
+      labelData.recycle(buffers->labels, buffers->rows);
+      d_skippedFrameCount++;
+
+      State::make<CameraFrameState>(previous->getBallObservation(), previous->getGoalObservations(), previous->getTeamMateObservations(),
+                                    previous->getObservedLineSegments(), previous->getOcclusionRays(),
+                                    previous->getTotalPixelCount(), previous->getProcessedPixelCount(), thinkCycleNumber);
+
+      t.timeEvent("Reusing Previous Frame");
+      return;
+    }
+  }
+  d_skippedFrameCount = 0;
+
   // Perform the image pass
   d_imagePassRunner->pass(labelData, t);
 
+  // Return label storage to the pool for the next frame
+  labelData.recycle(buffers->labels, buffers->rows);
+
   // Find lines
   vector<LineSegment2i> observedLineSegments;
   if (d_shouldDetectLines->getValue())
@@ -73,6 +141,15 @@ void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCyc
     auto blobsPerLabel = d_blobDetectPass->detectBlobs(t);
     t.exit();
 
+    if (useRegionsOfInterest)
+    {
+      t.enter("Regions Of Interest");
+      processedPixelCount += detectBlobsInRegionsOfInterest(frame, agentCameraRotation, blobsPerLabel, t);
+      t.exit();
+    }
+
+    vector<Bounds2<ushort>> observedBounds;
+
     //
     // UPDATE STATE
     //
@@ -80,14 +157,14 @@ void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCyc
     if (blobsPerLabel[d_pixelLabels[(uint8_t)LabelClass::BALL - 1]].size() > 0)
     {
       auto& ballBlobs = blobsPerLabel[d_pixelLabels[(uint8_t)LabelClass::BALL - 1]];
-      ballPosition = detectBall(ballBlobs, t);
+      ballPosition = detectBall(ballBlobs, frame, t, observedBounds);
     }
 
     // Do we have goal posts?
     if (blobsPerLabel[d_pixelLabels[(uint8_t)LabelClass::GOAL - 1]].size() > 0)
     {
       auto& goalBlobs = blobsPerLabel[d_pixelLabels[(uint8_t)LabelClass::GOAL - 1]];
-      goalPositions = detectGoal(goalBlobs, t);
+      goalPositions = detectGoal(goalBlobs, t, observedBounds);
     }
 
     auto teamColour = Config::getStaticValue<TeamColour>("team-colour");
@@ -100,6 +177,9 @@ void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCyc
       auto& playerBlobs = blobsPerLabel[ourColourLabel];
       teamMatePositions = detectPlayers(playerBlobs, t);
     }
+
+    if (trackRegionsOfInterest)
+      updateRegionsOfInterest(observedBounds, agentCameraRotation);
   }
 
   vector<OcclusionRay<ushort>> occlusionRays = d_fieldEdgePass->getOcclusionRays();
@@ -129,8 +209,7 @@ void VisualCortex::integrateImage(Mat& image, SequentialTimer& t, ulong thinkCyc
     occlusionRays = widenedRays;
   }
 
-  long processedPixelCount = sampleMap.getPixelCount();
-  long totalPixelCount = image.rows * image.cols;
+  long totalPixelCount = frame.getWidth() * frame.getHeight();
 
   State::make<CameraFrameState>(ballPosition, goalPositions, teamMatePositions,
                                 observedLineSegments, occlusionRays,
@@ -0,0 +1,32 @@
+#include "visualcortex.hh"
+
+#include "../Math/math.hh"
+#include "../State/state.hh"
+#include "../StateObject/BodyState/bodystate.hh"
+#include "../StateObject/WalkState/walkstate.hh"
+
+#include <Eigen/Geometry>
+
+using namespace bold;
+using namespace Eigen;
+using namespace std;
+
+bool VisualCortex::isCameraStill()
+{
+  auto body = State::get<BodyState>(StateTime::CameraImage);
+  if (!body)
+    return false;
+
+  Matrix3d cameraRotation = body->getAgentCameraTransform().linear();
+
+  // Angle of the rotation from the previous frame's camera pose to the current one
+  double angle = AngleAxisd(cameraRotation * d_previousCameraRotation.transpose()).angle();
+  d_previousCameraRotation = cameraRotation;
+
+  // The walk moves the agent frame through the world, which the camera's pose within it doesn't show
+  auto walk = State::get<WalkState>();
+  if (walk && walk->isRunning())
+    return false;
+
+  return angle <= Math::degToRad(d_stillToleranceDegrees->getValue());
+}
@@ -0,0 +1,35 @@
+#include "visualcortex.hh"
+
+#include "../Clock/clock.hh"
+#include "../ImageLabeller/imagelabeller.hh"
+#include "../LUTBuilder/lutbuilder.hh"
+#include "../LUTCache/lutcache.hh"
+
+using namespace bold;
+using namespace std;
+
+void VisualCortex::rebuildLut(unsigned labelIndex, Colour::hsvRange range)
+{
+  ASSERT(labelIndex < d_lutLabels.size());
+
+  auto t = Clock::getTimestamp();
+
+  auto const& label = d_lutLabels[labelIndex];
+  auto oldRange = static_pointer_cast<RangePixelLabel>(label)->getHSVRange();
+  label->setHSVRange(range);
+
+  // The published LUT may be in use by the think thread, so update a copy
+  auto lut = d_lut->clone();
+
+  unsigned relabelCount = LUTBuilder::updateLookUpTable(*lut, d_lutLabels, oldRange, range);
+
+  d_lut = lut;
+  d_imageLabeller->updateLut(d_lut);
+
+  // Skip storing LUTs that queued changes are about to supersede. The cache
+  // also waits for changes to stop before writing.
+  if (d_lutCache && d_lutRebuildQueue->size() == 0)
+    d_lutCache->store(LUTCache::getKey(d_lut->getName(), d_lutLabels), d_lut);
+
+  log::verbose("VisualCortex::rebuildLut") << "Relabelled " << relabelCount << " LUT entries for " << label->getName() << " in " << Clock::getMillisSince(t) << " ms";
+}
@@ -21,7 +21,7 @@ using namespace cv;
 using namespace Eigen;
 using namespace std;
 
-void VisualCortex::streamDebugImage(cv::Mat& cameraImage, SequentialTimer& t)
+void VisualCortex::streamDebugImage(Camera::Frame& frame, SequentialTimer& t)
 {
   // Only compose the image if at least one client is connected
   if (!d_dataStreamer->hasCameraClients())
@@ -37,6 +37,10 @@ void VisualCortex::streamDebugImage(cv::Mat& cameraImage, SequentialTimer& t)
 
   Mat debugImage;
 
+  // Held while debugImage shares memory with the camera frame, so that the
+  // frame's buffers are not reused before the image has been encoded
+  FramePool::Handle frameBuffers;
+
   ImageType imageType = d_imageType->getValue();
   map<uchar,Colour::bgr> palette;
   bool usePalette = false;
@@ -48,12 +52,14 @@ void VisualCortex::streamDebugImage(cv::Mat& cameraImage, SequentialTimer& t)
   {
     case ImageType::YCbCr:
     {
-      debugImage = cameraImage;
+      debugImage = frame.getImage();
+      frameBuffers = frame.getBuffers();
       break;
     }
     case ImageType::RGB:
     {
-      debugImage = cameraImage;
+      debugImage = frame.getImage();
+      frameBuffers = frame.getBuffers();
       PixelFilterChain chain;
       chain.pushFilter(&yCbCrToBgrInPlace);
       chain.applyFilters(debugImage);
@@ -71,7 +77,7 @@ void VisualCortex::streamDebugImage(cv::Mat& cameraImage, SequentialTimer& t)
     }
     case ImageType::None:
     {
-      debugImage = Mat(cameraImage.size(), CV_8UC1, Scalar(0));
+      debugImage = Mat(frame.getHeight(), frame.getWidth(), CV_8UC1, Scalar(0));
       palette[0] = backgroundColour->getValue();
       usePalette = true;
       break;
@@ -87,9 +93,10 @@ void VisualCortex::streamDebugImage(cv::Mat& cameraImage, SequentialTimer& t)
       else
       {
         auto trainImage = d_labelTeacher->getBGRTrainImage();
-        if (!(trainImage.rows == cameraImage.rows && trainImage.cols == cameraImage.cols))
+        if (!(trainImage.rows == frame.getHeight() && trainImage.cols == frame.getWidth()))
         {
-          debugImage = cameraImage;
+          debugImage = frame.getImage();
+          frameBuffers = frame.getBuffers();
           PixelFilterChain chain;
           chain.pushFilter(&Colour::yCbCrToBgrInPlace);
           chain.applyFilters(debugImage);
@@ -348,7 +355,7 @@ void VisualCortex::streamDebugImage(cv::Mat& cameraImage, SequentialTimer& t)
     ? ImageEncoding::PNG
     : ImageEncoding::JPEG;
 
-  d_dataStreamer->streamImage(debugImage, imageEncoding, palette);
+  d_dataStreamer->streamImage(debugImage, imageEncoding, palette, frameBuffers);
   t.timeEvent("Compose Debug Image");
 
   if (d_saveNextDebugFrame)
@@ -0,0 +1,59 @@
+#include "visualcortex.hh"
+
+#include "../CameraModel/cameramodel.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace bold;
+using namespace Eigen;
+using namespace std;
+
+void VisualCortex::updateRegionsOfInterest(vector<Bounds2<ushort>> const& observedBounds, Matrix3d const& agentCameraRotation)
+{
+  int margin = d_roiMarginPixels->getValue();
+
+  for (RegionOfInterest& roi : d_regionsOfInterest)
+    roi.age++;
+
+  for (Bounds2<ushort> const& bounds : observedBounds)
+  {
+    Vector2d centre = (bounds.min() + bounds.max()).cast<double>() / 2.0;
+    Vector2i halfSize = ((bounds.max() - bounds.min()).cast<int>() / 2).array() + margin + 1;
+
+    // Drop existing regions that now appear within the new one, as they track the same object
+    Vector2i centrePixel(int(round(centre.x())), int(round(centre.y())));
+    d_regionsOfInterest.erase(
+      remove_if(d_regionsOfInterest.begin(), d_regionsOfInterest.end(), [&](RegionOfInterest const& roi)
+      {
+        auto pixel = d_cameraModel->pixelForDirection(agentCameraRotation.transpose() * roi.agentDirection);
+        if (!pixel.hasValue())
+          return false;
+        Vector2i offset = (pixel->cast<int>() - centrePixel).cwiseAbs();
+        return offset.x() <= halfSize.x() && offset.y() <= halfSize.y();
+      }),
+      d_regionsOfInterest.end());
+
+    RegionOfInterest roi;
+    roi.agentDirection = agentCameraRotation * d_cameraModel->directionForPixel(centre);
+    roi.halfSize = halfSize;
+    roi.age = 0;
+    d_regionsOfInterest.push_back(roi);
+  }
+
+  // Forget regions whose objects have not been seen for a while
+  unsigned maxAge = unsigned(d_roiMaxAgeFrames->getValue());
+  d_regionsOfInterest.erase(
+    remove_if(d_regionsOfInterest.begin(), d_regionsOfInterest.end(),
+              [maxAge](RegionOfInterest const& roi) { return roi.age > maxAge; }),
+    d_regionsOfInterest.end());
+
+  // Keep the most recently observed regions
+  unsigned maxCount = unsigned(d_roiMaxCount->getValue());
+  if (d_regionsOfInterest.size() > maxCount)
+  {
+    stable_sort(d_regionsOfInterest.begin(), d_regionsOfInterest.end(),
+                [](RegionOfInterest const& a, RegionOfInterest const& b) { return a.age < b.age; });
+    d_regionsOfInterest.resize(maxCount);
+  }
+}
@@ -2,28 +2,37 @@
 
 #include <Eigen/Core>
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
 #include <opencv2/core/core.hpp>
 
+#include "../Camera/camera.hh"
+#include "../geometry/Bounds.hh"
+#include "../ImageLabelData/imagelabeldata.hh"
 #include "../LabelTeacher/labelteacher.hh"
 #include "../geometry/LineSegment/LineSegment2/LineSegment2i/linesegment2i.hh"
 #include "../PixelLabel/RangePixelLabel/rangepixellabel.hh"
 #include "../PixelLabel/HistogramPixelLabel/histogrampixellabel.hh"
 #include "../Setting/setting.hh"
+#include "../util/consumerqueuethread.hh"
 #include "../util/meta.hh"
 
 namespace bold
 {
+  class BallValidationImage;
   struct Blob;
-  class Camera;
   class CameraModel;
   class DataStreamer;
   class FieldMap;
   class HeadModule;
   class ImageLabeller;
+  class ImageSampleMap;
   class LineFinder;
+  class LookUpTable;
+  class LUTCache;
+  class RowLabelCache;
   class SequentialTimer;
   class Spatialiser;
 
@@ -62,6 +71,14 @@ namespace bold
     Periodic = 1
   };
 
+  enum class LineFinderType
+  {
+    Scanning = 0,
+    MaskWalk = 1,
+    RandomPair = 2,
+    Hough = 3
+  };
+
   /** Bold-humanoid's vision processing subsystem. */
   class VisualCortex
   {
@@ -74,14 +91,16 @@ namespace bold
                  std::shared_ptr<Spatialiser> spatialiser,
                  std::shared_ptr<HeadModule> headModule);
 
-    /** Process the provided image, extracting features. */
-    void integrateImage(cv::Mat& cameraImage, SequentialTimer& timer, ulong thinkCycleNumber);
+    ~VisualCortex();
+
+    /** Process the provided camera frame, extracting features. */
+    void integrateImage(Camera::Frame& frame, SequentialTimer& timer, ulong thinkCycleNumber);
 
     /** Saves the provided image to a file, along with information about the current agent's state in a JSON file. */
     void saveImage(cv::Mat const& image, std::map<uchar,Colour::bgr>* palette);
 
     /** Composes and enqueues a debugging image. */
-    void streamDebugImage(cv::Mat& cameraImage, SequentialTimer& timer);
+    void streamDebugImage(Camera::Frame& frame, SequentialTimer& timer);
 
     void setShouldDetectLines(bool val) { d_shouldDetectLines->setValue(val); }
     bool getShouldDetectLines() const { return d_shouldDetectLines->getValue(); }
@@ -133,14 +152,59 @@ namespace bold
 
   private:
 
-    Maybe<Eigen::Vector2d> detectBall(std::vector<Blob>& ballBlobs, SequentialTimer& t);
-    std::vector<Eigen::Vector2d,Eigen::aligned_allocator<Eigen::Vector2d>> detectGoal(std::vector<Blob>& goalBlobs, SequentialTimer& t);
+    /// An image region, around a recently observed object, that is labelled at full resolution in region of interest mode
+    struct RegionOfInterest
+    {
+      /// Direction to the region's centre, in the agent frame, so the region can follow camera movement
+      Eigen::Vector3d agentDirection;
+      Eigen::Vector2i halfSize;
+      /// Frames since the object was last observed
+      unsigned age;
+    };
+
+    Maybe<Eigen::Vector2d> detectBall(std::vector<Blob>& ballBlobs, Camera::Frame& frame, SequentialTimer& t, std::vector<Bounds2<ushort>>& observedBounds);
+    std::vector<Eigen::Vector2d,Eigen::aligned_allocator<Eigen::Vector2d>> detectGoal(std::vector<Blob>& goalBlobs, SequentialTimer& t, std::vector<Bounds2<ushort>>& observedBounds);
     std::vector<Eigen::Vector2d,Eigen::aligned_allocator<Eigen::Vector2d>> detectPlayers(std::vector<Blob>& playerBlobs, SequentialTimer& t);
 
-    bool canBlobBeBall(Blob const& ballBlob, Eigen::Vector2d& imagePos, Eigen::Vector3d& agentFramePos);
+    /** Whether a ball blob is large enough to be considered. Blobs merged into another have zero area, and never are. */
+    bool isBallBlobLargeEnough(Blob const& ballBlob) const;
+
+    /** Checks a ball blob. Where validation images are given, the blob's shape is checked against the one containing it, and it is rejected if none does. */
+    bool canBlobBeBall(Blob const& ballBlob, std::vector<BallValidationImage> const* validation, Eigen::Vector2d& imagePos, Eigen::Vector3d& agentFramePos);
+
+    /** Labels each ball blob large enough to be considered, and the ring around it, at full resolution. */
+    std::vector<BallValidationImage> buildBallValidationImages(Camera::Frame& frame, std::vector<Blob> const& ballBlobs);
     bool canBlobBeGoal(Blob const& goalBlob, Eigen::Vector2d& pos);
     bool canBlobBePlayer(Blob const& playerBlob, Eigen::Vector2d& imagePos, Eigen::Vector3d& agentFramePos);
 
+    /// The index of a label within d_rangePixelLabels, and its new HSV range
+    typedef std::pair<unsigned,Colour::hsvRange> LutRangeChange;
+
+    /** Applies a label's range change to the LUT and hands the result to the image labeller. Runs on the LUT rebuild thread. */
+    void rebuildLut(unsigned labelIndex, Colour::hsvRange range);
+
+    /** Returns a sample map for an image of the given size, reusing the previous frame's map where possible. */
+    ImageSampleMap const& getSampleMap(ushort width, ushort height);
+
+    /** Whether the robot is not walking and the camera has barely turned since the previous frame. Call once per frame. */
+    bool isCameraStill();
+
+    std::shared_ptr<LineFinder> createLineFinder(LineFinderType lineFinderType) const;
+
+    /** Returns a uniformly coarse sample map, used for the whole image in region of interest mode. */
+    ImageSampleMap const& getCoarseSampleMap(ushort width, ushort height);
+
+    /**
+     * Labels each region of interest at full resolution and merges the blobs found there into blobsPerLabel,
+     * replacing the coarse blobs they contain. Returns the number of pixels labelled.
+     */
+    unsigned detectBlobsInRegionsOfInterest(Camera::Frame& frame, Eigen::Matrix3d const& agentCameraRotation,
+                                            std::map<std::shared_ptr<PixelLabel>,std::vector<Blob>>& blobsPerLabel,
+                                            SequentialTimer& t);
+
+    /** Ages existing regions of interest and starts or refreshes regions around objects observed this frame. */
+    void updateRegionsOfInterest(std::vector<Bounds2<ushort>> const& observedBounds, Eigen::Matrix3d const& agentCameraRotation);
+
     std::shared_ptr<Camera> d_camera;
     std::shared_ptr<CameraModel> d_cameraModel;
     std::shared_ptr<DataStreamer> d_dataStreamer;
@@ -153,11 +217,57 @@ namespace bold
     
     std::shared_ptr<ImageLabeller> d_imageLabeller;
 
+    /// The most recently built LUT. Only touched by the LUT rebuild thread after construction.
+    std::shared_ptr<LookUpTable const> d_lut;
+    /// Copies of d_rangePixelLabels, owned by the LUT rebuild thread
+    std::vector<std::shared_ptr<PixelLabel>> d_lutLabels;
+    std::unique_ptr<ConsumerQueueThread<LutRangeChange>> d_lutRebuildQueue;
+    /// Null unless vision.lut-cache.enable is set
+    std::unique_ptr<LUTCache> d_lutCache;
+
     std::unique_ptr<LabelTeacher> d_labelTeacher;
 
     std::function<Eigen::Matrix<uchar,2,1>(int)> d_granularityFunction;
 
+    /// The sample map used for the most recent frame
+    std::unique_ptr<ImageSampleMap> d_sampleMap;
+    /// Camera orientation, in agent space, when d_sampleMap was built
+    Eigen::Matrix3d d_sampleMapCameraRotation;
+    /// Set when a setting that affects the sample map changes
+    std::atomic<bool> d_sampleMapStale;
+    Setting<double>* d_sampleMapToleranceDegrees;
+
+    /// Labels of image rows from previous frames, reused while the camera is still
+    std::unique_ptr<RowLabelCache> d_rowLabelCache;
+    /// Camera orientation, in agent space, for the previous frame
+    Eigen::Matrix3d d_previousCameraRotation;
+    /// Consecutive frames whose processing was skipped, as no rows changed
+    unsigned d_skippedFrameCount;
+    Setting<bool>* d_temporalCoherenceEnabled;
+    Setting<double>* d_stillToleranceDegrees;
+    Setting<int>* d_maxSkippedFrames;
+
+    /// Sample map for the coarse labelling of region of interest mode, and the granularity it was built with
+    std::unique_ptr<ImageSampleMap> d_coarseSampleMap;
+    uchar d_coarseSampleMapGranularity;
+
+    std::vector<RegionOfInterest> d_regionsOfInterest;
+    /// Detects blobs within a single region of interest, separately from the main pass
+    std::shared_ptr<BlobDetectPass> d_roiBlobDetectPass;
+    /// Label storage reused between regions of interest and ball validation
+    std::vector<uchar> d_roiLabels;
+    std::vector<RowLabels> d_roiRows;
+    Setting<bool>* d_roiEnabled;
+    Setting<int>* d_roiCoarseGranularity;
+    Setting<int>* d_roiMarginPixels;
+    Setting<int>* d_roiMaxAgeFrames;
+    Setting<int>* d_roiMaxCount;
+
+    /// Only replaced on the think thread, between frames
     std::shared_ptr<LineFinder> d_lineFinder;
+    LineFinderType d_lineFinderType;
+    /// Set when the line finder setting changes, on whichever thread changed it
+    std::atomic<LineFinderType> d_requestedLineFinderType;
 
     std::shared_ptr<ImagePassRunner> d_imagePassRunner;
 
@@ -175,13 +285,20 @@ namespace bold
 
     Setting<int>* d_minBallAreaPixels;
     Setting<Range<double>>* d_acceptedBallMeasuredSizeRatio;
+    Setting<bool>* d_ballIntegralValidationEnabled;
+    Setting<double>* d_minBallFillRatio;
+    Setting<int>* d_ballRingWidthPixels;
+    Setting<double>* d_minBallRingSurroundRatio;
 
     Setting<int>* d_minGoalDimensionPixels;
     Setting<int>* d_maxGoalFieldEdgeDistPixels;
     Setting<Range<double>>* d_acceptedGoalMeasuredWidthRatio;
+    Setting<double>* d_minGoalEccentricity;
+    Setting<double>* d_maxGoalTiltDegrees;
 
     Setting<int>* d_minPlayerAreaPixels;
     Setting<int>* d_minPlayerLengthPixels;
+    Setting<double>* d_maxPlayerEccentricity;
     Setting<double>* d_goalieMarkerHeight;
 
     Setting<double>* d_fieldHistogramThreshold;
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "../BallValidationImage/ballvalidationimage.hh"
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  // A 20x20 region at (100,50), with a 6x6 ball at (107,57) on field. Rows of
+  // the ring to the right of the ball are left unlabelled.
+  BallValidationImage makeImage(int unlabelledRingColumns = 0)
+  {
+    cv::Mat ball(20, 20, CV_8UC1);
+    cv::Mat surroundings(20, 20, CV_8UC1);
+
+    for (int y = 0; y < 20; y++)
+    {
+      for (int x = 0; x < 20; x++)
+      {
+        bool isBall = x >= 7 && x <= 12 && y >= 7 && y <= 12;
+        bool isUnlabelled = x > 12 && x <= 12 + unlabelledRingColumns;
+        ball.at<uchar>(y, x) = isBall ? 1 : 0;
+        surroundings.at<uchar>(y, x) = !isBall && !isUnlabelled ? 1 : 0;
+      }
+    }
+
+    return BallValidationImage(ball, surroundings, Bounds2i(100, 50, 119, 69));
+  }
+}
+
+TEST (BallValidationImageTests, contains)
+{
+  auto image = makeImage();
+
+  EXPECT_TRUE(image.contains(Bounds2i(100, 50, 119, 69)));
+  EXPECT_TRUE(image.contains(Bounds2i(107, 57, 112, 62)));
+  EXPECT_FALSE(image.contains(Bounds2i(99, 57, 112, 62)));
+  EXPECT_FALSE(image.contains(Bounds2i(107, 57, 120, 62)));
+  EXPECT_FALSE(image.contains(Bounds2i(0, 0, 1, 1)));
+}
+
+TEST (BallValidationImageTests, fillRatio)
+{
+  auto image = makeImage();
+
+  // Exactly the ball
+  EXPECT_TRUE(image.isBallShaped(Bounds2i(107, 57, 112, 62), 1.0, 2, 1.0));
+
+  // A box twice the ball's width is half filled
+  EXPECT_TRUE(image.isBallShaped(Bounds2i(104, 57, 115, 62), 0.5, 2, 0.0));
+  EXPECT_FALSE(image.isBallShaped(Bounds2i(104, 57, 115, 62), 0.6, 2, 0.0));
+}
+
+TEST (BallValidationImageTests, ringSurround)
+{
+  // Unlabelled columns fill the ring's right side: 2 of its 4 sides
+  auto image = makeImage(2);
+  Bounds2i ballBox(107, 57, 112, 62);
+
+  // The ring is 10x10 less the 6x6 box, of which 2x10 is unlabelled
+  EXPECT_TRUE(image.isBallShaped(ballBox, 1.0, 2, 44.0 / 64));
+  EXPECT_FALSE(image.isBallShaped(ballBox, 1.0, 2, 45.0 / 64));
+
+  // Without a ring, only the fill ratio applies
+  EXPECT_TRUE(image.isBallShaped(ballBox, 1.0, 0, 1.0));
+}
+
+TEST (BallValidationImageTests, ringClippedToRegion)
+{
+  auto image = makeImage();
+
+  // At the region's corner, the ring is clipped to the labelled field
+  // within the region, so no sum falls outside it
+  EXPECT_TRUE(image.isBallShaped(Bounds2i(100, 50, 102, 52), 0.0, 2, 1.0));
+}
+
+TEST (BallValidationImageTests, rejectsBoxOutsideRegion)
+{
+  auto image = makeImage();
+
+  EXPECT_FALSE(image.isBallShaped(Bounds2i(95, 57, 112, 62), 0.0, 0, 0.0));
+  EXPECT_FALSE(image.isBallShaped(Bounds2i(107, 57, 125, 75), 0.0, 0, 0.0));
+}
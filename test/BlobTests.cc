@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include "helpers.hh"
 #include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
+#include "../DisjointSet/disjointset.hh"
+#include "../PixelLabel/RangePixelLabel/rangepixellabel.hh"
+#include "../SequentialTimer/sequentialtimer.hh"
+
+#include <random>
 
 using namespace std;
 using namespace bold;
@@ -28,19 +33,104 @@ TEST (BlobTests, runSetToBlob)
   EXPECT_EQ ( ImageBounds(0,0, 9,8), blob.bounds() );
 }
 
+namespace
+{
+  // Computes the covariance of a run set's pixel positions, pixel by pixel
+  Matrix2f pixelCovariance(set<bold::Run> const& runSet)
+  {
+    vector<Vector2d> pixels;
+    for (bold::Run const& run : runSet)
+      for (int x = run.startX; x <= run.endX; x++)
+        pixels.emplace_back(x, run.y);
+
+    Vector2d mean = Vector2d::Zero();
+    for (auto const& pixel : pixels)
+      mean += pixel;
+    mean /= pixels.size();
+
+    Matrix2d covar = Matrix2d::Zero();
+    for (auto const& pixel : pixels)
+      covar += (pixel - mean) * (pixel - mean).transpose();
+    return (covar / pixels.size()).cast<float>();
+  }
+}
+
+TEST (BlobTests, runSetToBlobCovariance)
+{
+  set<bold::Run> runSet;
+  runSet.insert(bold::Run(10,14,20));
+  runSet.insert(bold::Run(12,17,21));
+  runSet.insert(bold::Run(15,22,22));
+  runSet.insert(bold::Run(19,23,23));
+
+  auto blob = BlobDetectPass::runSetToBlob(runSet);
+
+  EXPECT_TRUE ( blob.covar.isApprox(pixelCovariance(runSet), 1e-5) );
+  EXPECT_EQ ( blob.covar(0,1), blob.covar(1,0) );
+}
+
+TEST (BlobTests, orientationAndEccentricity)
+{
+  // A single row has no spread in y
+  set<bold::Run> row = { bold::Run(0,9,5) };
+  auto rowBlob = BlobDetectPass::runSetToBlob(row);
+  EXPECT_NEAR ( 0, rowBlob.orientation(), 1e-5 );
+  EXPECT_NEAR ( 1, rowBlob.eccentricity(), 1e-5 );
+
+  // A single column
+  set<bold::Run> column;
+  for (ushort y = 0; y < 10; y++)
+    column.insert(bold::Run(3,3,y));
+  auto columnBlob = BlobDetectPass::runSetToBlob(column);
+  EXPECT_NEAR ( M_PI/2, fabs(columnBlob.orientation()), 1e-5 );
+  EXPECT_NEAR ( 1, columnBlob.eccentricity(), 1e-5 );
+
+  // A square spreads equally in x and y
+  set<bold::Run> square;
+  for (ushort y = 0; y < 10; y++)
+    square.insert(bold::Run(0,9,y));
+  EXPECT_NEAR ( 0, BlobDetectPass::runSetToBlob(square).eccentricity(), 1e-3 );
+
+  // A staircase rising to the right lies along the diagonal
+  set<bold::Run> staircase;
+  for (ushort y = 0; y < 20; y++)
+    staircase.insert(bold::Run(y,y+2,y));
+  auto staircaseBlob = BlobDetectPass::runSetToBlob(staircase);
+  EXPECT_NEAR ( M_PI/4, staircaseBlob.orientation(), 0.01 );
+  EXPECT_GT ( staircaseBlob.eccentricity(), 0.95 );
+}
+
+TEST (BlobTests, mergeCovariance)
+{
+  set<bold::Run> runs1 = { bold::Run(0,4,0), bold::Run(1,6,1) };
+  set<bold::Run> runs2 = { bold::Run(8,12,3), bold::Run(9,9,4), bold::Run(9,10,5) };
+  set<bold::Run> allRuns = runs1;
+  allRuns.insert(runs2.begin(), runs2.end());
+
+  auto blob = BlobDetectPass::runSetToBlob(runs1);
+  auto other = BlobDetectPass::runSetToBlob(runs2);
+  blob.merge(other);
+
+  auto expected = BlobDetectPass::runSetToBlob(allRuns);
+
+  EXPECT_EQ ( expected.area, blob.area );
+  EXPECT_TRUE ( VectorsEqual(expected.mean, blob.mean) );
+  EXPECT_TRUE ( expected.covar.isApprox(blob.covar, 1e-4) );
+}
+
 TEST (BlobTests, compare)
 {
   Blob blob1(ImagePos(0,0), ImagePos(10,10),
              121,
-             Vector2f(5,5),// Matrix2f::Identity(),
+             Vector2f(5,5), Matrix2f::Identity(),
              set<bold::Run>());
   Blob blob2(ImagePos(0,0), ImagePos(6,6),
              49,
-             Vector2f(3,3), //Matrix2f::Identity(),
+             Vector2f(3,3), Matrix2f::Identity(),
              set<bold::Run>());
   Blob blob3(ImagePos(3,3), ImagePos(9,9),
              49,
-             Vector2f(6,6), //Matrix2f::Identity(),
+             Vector2f(6,6), Matrix2f::Identity(),
              set<bold::Run>());
 
   EXPECT_TRUE ( blob2 < blob1 ); // Smaller area
@@ -50,8 +140,8 @@ TEST (BlobTests, compare)
 
 TEST (BlobTests, merge)
 {
-  Blob b1(ImagePos(10,10), ImagePos(20,20), 10, Vector2f(15,15), set<bold::Run>());
-  Blob b2(ImagePos( 0, 0), ImagePos(10,10), 5 , Vector2f( 5, 5), set<bold::Run>());
+  Blob b1(ImagePos(10,10), ImagePos(20,20), 10, Vector2f(15,15), Matrix2f::Zero(), set<bold::Run>());
+  Blob b2(ImagePos( 0, 0), ImagePos(10,10), 5 , Vector2f( 5, 5), Matrix2f::Zero(), set<bold::Run>());
 
   b1.merge(b2);
 
@@ -60,3 +150,213 @@ TEST (BlobTests, merge)
   EXPECT_EQ(ImagePos( 0, 0), b1.ul);
   EXPECT_EQ(ImagePos(20,20), b1.br);
 }
+
+namespace
+{
+  // Builds label data from rows of characters, where '.' is unlabelled and
+  // any other character c has label (c - '0'). The first string is row zero.
+  ImageLabelData makeLabelData(vector<string> const& image)
+  {
+    ushort width = image[0].size();
+    vector<uchar> labels(width * image.size());
+    vector<RowLabels> rows;
+    for (ushort y = 0; y < image.size(); y++)
+    {
+      uchar* row = labels.data() + y * width;
+      for (ushort x = 0; x < width; x++)
+        row[x] = image[y][x] == '.' ? 0 : image[y][x] - '0';
+      rows.emplace_back(row, row + width, y, Matrix<uchar,2,1>(1, 1));
+    }
+    return ImageLabelData(move(labels), move(rows), width);
+  }
+
+  // Finds blobs by comparing every run with every run in the previous row
+  vector<Blob> detectBlobsExhaustively(vector<string> const& image, uchar label)
+  {
+    vector<vector<bold::Run>> runsPerRow(image.size());
+    for (ushort y = 0; y < image.size(); y++)
+    {
+      for (ushort x = 0; x < image[y].size(); x++)
+      {
+        if (image[y][x] != '0' + label)
+          continue;
+        ushort startX = x;
+        while (x + 1u < image[y].size() && image[y][x + 1] == '0' + label)
+          x++;
+        runsPerRow[y].emplace_back(startX, x, y);
+      }
+    }
+
+    DisjointSet<bold::Run> runSet;
+    for (ushort y = 0; y < image.size(); y++)
+    {
+      for (bold::Run const& run : runsPerRow[y])
+      {
+        runSet.insert(run);
+        if (y != 0)
+          for (bold::Run const& run2 : runsPerRow[y - 1])
+            if (run.overlaps(run2))
+              runSet.merge(run, run2);
+      }
+    }
+
+    vector<Blob> blobs;
+    for (auto const& runs : runSet.getSubSets())
+      blobs.push_back(BlobDetectPass::runSetToBlob(runs));
+    return blobs;
+  }
+}
+
+TEST (BlobTests, detectBlobs)
+{
+  auto goalLabel = make_shared<RangePixelLabel>("Goal", LabelClass::GOAL, Colour::hsvRange());
+  auto ballLabel = make_shared<RangePixelLabel>("Ball", LabelClass::BALL, Colour::hsvRange());
+
+  // Goal forms a U shape whose arms are only joined in the final rows, and
+  // an isolated run. Ball forms a diagonal, which is connected as runs
+  // overlap when they touch end to end.
+  vector<string> image = {
+    "1..1...22.",
+    "1..1..22..",
+    "1111.22...",
+    "......1...",
+    ".........."
+  };
+
+  BlobDetectPass pass(10, image.size(), { goalLabel, ballLabel });
+  pass.setCollectRuns(goalLabel, true);
+
+  SequentialTimer timer;
+  pass.process(makeLabelData(image), timer);
+  auto const& blobsPerLabel = pass.detectBlobs(timer);
+
+  auto const& goalBlobs = blobsPerLabel.at(goalLabel);
+  ASSERT_EQ ( 2, goalBlobs.size() );
+
+  EXPECT_EQ ( 8, goalBlobs[0].area );
+  EXPECT_EQ ( ImagePos(0,0), goalBlobs[0].ul );
+  EXPECT_EQ ( ImagePos(3,2), goalBlobs[0].br );
+  EXPECT_TRUE ( VectorsEqual(Vector2f(1.5, 1.25), goalBlobs[0].mean) );
+  EXPECT_EQ ( 5, goalBlobs[0].runs.size() );
+
+  EXPECT_EQ ( 1, goalBlobs[1].area );
+  EXPECT_EQ ( ImagePos(6,3), goalBlobs[1].ul );
+  EXPECT_EQ ( ImagePos(6,3), goalBlobs[1].br );
+  ASSERT_EQ ( 1, goalBlobs[1].runs.size() );
+  EXPECT_EQ ( 3, goalBlobs[1].runs.begin()->y );
+
+  auto const& ballBlobs = blobsPerLabel.at(ballLabel);
+  ASSERT_EQ ( 1, ballBlobs.size() );
+  EXPECT_EQ ( 6, ballBlobs[0].area );
+  EXPECT_EQ ( ImagePos(5,0), ballBlobs[0].ul );
+  EXPECT_EQ ( ImagePos(8,2), ballBlobs[0].br );
+
+  // Runs are only collected when requested
+  EXPECT_TRUE ( ballBlobs[0].runs.empty() );
+}
+
+TEST (BlobTests, detectBlobsAtImageEdges)
+{
+  auto goalLabel = make_shared<RangePixelLabel>("Goal", LabelClass::GOAL, Colour::hsvRange());
+
+  // Runs which reach the end of a row, including the final row, are kept
+  vector<string> image = {
+    "..11",
+    "1..1",
+    "1111"
+  };
+
+  BlobDetectPass pass(4, image.size(), { goalLabel });
+
+  SequentialTimer timer;
+  pass.process(makeLabelData(image), timer);
+  auto const& goalBlobs = pass.detectBlobs(timer).at(goalLabel);
+
+  ASSERT_EQ ( 1, goalBlobs.size() );
+  EXPECT_EQ ( 8, goalBlobs[0].area );
+  EXPECT_EQ ( ImagePos(0,0), goalBlobs[0].ul );
+  EXPECT_EQ ( ImagePos(3,2), goalBlobs[0].br );
+}
+
+TEST (BlobTests, detectBlobsInRegion)
+{
+  auto goalLabel = make_shared<RangePixelLabel>("Goal", LabelClass::GOAL, Colour::hsvRange());
+
+  // Label data narrower than the pass's image, as for a region of interest
+  vector<string> region = {
+    "..11",
+    "..11"
+  };
+
+  BlobDetectPass pass(320, 240, { goalLabel });
+  pass.setCollectRuns(goalLabel, true);
+
+  SequentialTimer timer;
+  pass.process(makeLabelData(region), timer);
+  auto goalBlobs = pass.detectBlobs(timer).at(goalLabel);
+
+  ASSERT_EQ ( 1, goalBlobs.size() );
+  EXPECT_EQ ( 4, goalBlobs[0].area );
+  EXPECT_EQ ( ImagePos(3,1), goalBlobs[0].br );
+
+  // Place the blob at the region's position in the image
+  Blob blob = goalBlobs[0];
+  blob.translate(ImagePos(100, 50));
+
+  EXPECT_EQ ( ImagePos(102,50), blob.ul );
+  EXPECT_EQ ( ImagePos(103,51), blob.br );
+  EXPECT_TRUE ( VectorsEqual(Vector2f(102.5, 50.5), blob.mean) );
+  EXPECT_TRUE ( MatricesEqual(goalBlobs[0].covar.cast<double>(), blob.covar.cast<double>()) );
+  ASSERT_EQ ( 2, blob.runs.size() );
+  EXPECT_EQ ( 50, blob.runs.begin()->y );
+  EXPECT_EQ ( 102, blob.runs.begin()->startX );
+  EXPECT_EQ ( 103, blob.runs.begin()->endX );
+}
+
+TEST (BlobTests, detectBlobsMatchesExhaustiveSearch)
+{
+  auto goalLabel = make_shared<RangePixelLabel>("Goal", LabelClass::GOAL, Colour::hsvRange());
+  auto ballLabel = make_shared<RangePixelLabel>("Ball", LabelClass::BALL, Colour::hsvRange());
+
+  ushort const width = 40;
+  ushort const height = 30;
+
+  BlobDetectPass pass(width, height, { goalLabel, ballLabel });
+  pass.setCollectRuns(goalLabel, true);
+  pass.setCollectRuns(ballLabel, true);
+
+  mt19937 rng(1234);
+  uniform_int_distribution<int> labelDist(0, 2);
+
+  for (int iteration = 0; iteration < 20; iteration++)
+  {
+    vector<string> image(height, string(width, '.'));
+    for (auto& row : image)
+      for (auto& c : row)
+        c = ".12"[labelDist(rng)];
+
+    SequentialTimer timer;
+    pass.process(makeLabelData(image), timer);
+    auto const& blobsPerLabel = pass.detectBlobs(timer);
+
+    for (auto const& pixelLabel : { goalLabel, ballLabel })
+    {
+      auto expected = detectBlobsExhaustively(image, (uchar)pixelLabel->getID());
+      auto const& actual = blobsPerLabel.at(pixelLabel);
+
+      ASSERT_EQ ( expected.size(), actual.size() );
+
+      for (unsigned i = 0; i < expected.size(); i++)
+      {
+        EXPECT_EQ ( expected[i].area, actual[i].area );
+        EXPECT_EQ ( expected[i].ul, actual[i].ul );
+        EXPECT_EQ ( expected[i].br, actual[i].br );
+        EXPECT_TRUE ( VectorsEqual(expected[i].mean, actual[i].mean, 0.001) );
+        EXPECT_TRUE ( expected[i].covar.isApprox(actual[i].covar, 1e-4) || (expected[i].covar - actual[i].covar).norm() < 1e-4 );
+        ASSERT_EQ ( expected[i].runs.size(), actual[i].runs.size() );
+        EXPECT_TRUE ( equal(expected[i].runs.begin(), expected[i].runs.end(), actual[i].runs.begin(),
+                            [](bold::Run const& a, bold::Run const& b) { return a.y == b.y && a.startX == b.startX && a.endX == b.endX; }) );
+      }
+    }
+  }
+}
@@ -6,6 +6,7 @@
 #include "../JointId/jointid.hh"
 #include "../Math/math.hh"
 #include "../StateObject/BodyState/bodystate.hh"
+#include "../util/bufferreader.hh"
 
 using namespace std;
 using namespace bold;
@@ -360,6 +361,34 @@ TEST (BodyStateTests, torsoHeight)
   EXPECT_EQ ( (33.5 + 93 + 93 + 122.2) / 1000.0, body.getTorsoHeight() );
 }
 
+TEST (BodyStateTests, writeBinary)
+{
+  array<double,23> angles;
+  angles.fill(0);
+
+  array<short,21> diffs;
+  for (short i = 0; i < 21; i++)
+    diffs[i] = -i;
+
+  auto body = BodyState(bodyModel, angles, diffs, 1234);
+
+  WebSocketBuffer buffer;
+  body.writeBinary(buffer);
+
+  // Header, motion cycle, 20 angles, 20 errors and the centre of mass
+  size_t payloadSize = 4 + 20 * 4 + 20 * 2 + 3 * 4;
+  ASSERT_EQ ( LWS_SEND_BUFFER_PRE_PADDING + 3 + payloadSize, buffer.GetSize() );
+
+  BufferReader reader(reinterpret_cast<char const*>(buffer.GetBuffer() + LWS_SEND_BUFFER_PRE_PADDING));
+  EXPECT_EQ ( 1, reader.readInt8u() );
+  EXPECT_EQ ( payloadSize, reader.readInt16u() );
+  EXPECT_EQ ( 1234, reader.readInt32u() );
+
+  reader.skip(20 * 4);
+  for (short i = 1; i <= 20; i++)
+    EXPECT_EQ ( -i, reader.readInt16() );
+}
+
 TEST (DISABLED_JointTest, initialState)
 {
   Joint joint(JointId::L_KNEE, "test-joint");
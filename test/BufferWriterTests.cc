@@ -48,3 +48,27 @@ TEST (BufferWriterTests, writeInt32)
 
   testEqual(buffer, {1, 2, 3, 4, 5, 6, 7, 8});
 }
+
+TEST (BufferWriterTests, writeFloat32)
+{
+  char buffer[4];
+  BufferWriter writer(buffer);
+
+  // 1.0f is 0x3F800000
+  writer.writeFloat32(1.0f);
+
+  testEqual(buffer, {0x00, 0x00, (char)0x80, 0x3F});
+  EXPECT_EQ(4, writer.pos());
+}
+
+TEST (BufferWriterTests, writeBytes)
+{
+  char buffer[5];
+  BufferWriter writer(buffer);
+
+  writer.writeInt8u(1);
+  writer.writeBytes("\x02\x03\x04\x05", 4);
+
+  testEqual(buffer, {1, 2, 3, 4, 5});
+  EXPECT_EQ(5, writer.pos());
+}
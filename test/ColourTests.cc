@@ -183,3 +183,28 @@ TEST (ColourTests, hsvRangeContaining )
   EXPECT_EQ ( Colour::hsvRange(128,192, 128,128, 128,128), range.containing(Colour::hsv(192, 128, 128)) );
 
 }
+
+TEST (ColourTests, yCbCr2hsv18)
+{
+  for (int y = 0; y < 256; y += 3)
+    for (int cb = 0; cb < 256; cb += 3)
+      for (int cr = 0; cr < 256; cr += 3)
+      {
+        Colour::YCbCr yCbCr(y, cb, cr);
+        Colour::hsv expected = Colour::bgr2hsv(Colour::YCbCr(y & 0xFC, cb & 0xFC, cr & 0xFC).toBgrInt());
+        ASSERT_EQ ( expected, Colour::yCbCr2hsv18(yCbCr) ) << "Failed for " << y << "," << cb << "," << cr;
+      }
+
+  EXPECT_EQ ( Colour::yCbCr2hsv18(Colour::YCbCr(128, 64, 192)), Colour::yCbCr2hsv18Table()[(32 << 12) | (16 << 6) | 48] );
+}
+
+TEST (ColourTests, yCbCr2hsv24)
+{
+  for (int y : { 0, 16, 127, 128, 235, 255 })
+    for (int cb = 0; cb < 256; ++cb)
+      for (int cr = 0; cr < 256; ++cr)
+      {
+        Colour::YCbCr yCbCr(y, cb, cr);
+        ASSERT_EQ ( Colour::bgr2hsv(yCbCr.toBgrInt()), Colour::yCbCr2hsv24(yCbCr) ) << "Failed for " << y << "," << cb << "," << cr;
+      }
+}
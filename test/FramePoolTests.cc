@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "../FramePool/framepool.hh"
+
+using namespace bold;
+using namespace std;
+
+TEST (FramePoolTests, reusesReleasedSlots)
+{
+  FramePool pool(2);
+
+  for (int i = 0; i < 10; i++)
+  {
+    auto handle = pool.acquire();
+    handle.getImage(320, 240);
+    handle.reserveLabels(320 * 240, 240);
+  }
+
+  EXPECT_EQ(2, pool.getSlotCount());
+
+  // One image and two label buffers for each slot, and nothing after that
+  EXPECT_EQ(6, pool.getAllocationCount());
+}
+
+TEST (FramePoolTests, heldSlotsAreNotReused)
+{
+  FramePool pool(2);
+
+  auto a = pool.acquire();
+  auto b = pool.acquire();
+  EXPECT_NE(&*a, &*b);
+
+  // A copy keeps the slot held after the original is released
+  auto copy = a;
+  a.reset();
+  EXPECT_FALSE((bool)a);
+
+  auto c = pool.acquire();
+  EXPECT_EQ(3, pool.getSlotCount());
+  EXPECT_EQ(1, pool.getAllocationCount());
+  EXPECT_NE(&*copy, &*c);
+  EXPECT_NE(&*b, &*c);
+
+  copy.reset();
+  auto d = pool.acquire();
+  EXPECT_EQ(3, pool.getSlotCount());
+}
+
+TEST (FramePoolTests, imageReallocatedOnlyWhenSizeChanges)
+{
+  FramePool pool(1);
+
+  {
+    auto handle = pool.acquire();
+    uchar* data = handle.getImage(320, 240).data;
+    EXPECT_EQ(data, handle.getImage(320, 240).data);
+    EXPECT_EQ(1, pool.getAllocationCount());
+  }
+
+  auto handle = pool.acquire();
+  auto& image = handle.getImage(160, 240);
+  EXPECT_EQ(160, image.cols);
+  EXPECT_EQ(240, image.rows);
+  EXPECT_EQ(2, pool.getAllocationCount());
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "helpers.hh"
+#include "../HoughLineAccumulator/houghlineaccumulator.hh"
+#include "../LineFinder/HoughLineFinder/houghlinefinder.hh"
+
+#include <algorithm>
+
+using namespace std;
+using namespace bold;
+using namespace Eigen;
+
+TEST (HoughLineFinderTests, fixedPointAccumulatorMatchesDouble)
+{
+  for (double radiusResolution : { 1.0, 2.0, 3.5 })
+  {
+    HoughLineAccumulator accumulator(320, 240, 180, radiusResolution);
+
+    for (Vector2i point : { Vector2i(0,0), Vector2i(319,0), Vector2i(0,239), Vector2i(319,239), Vector2i(123,45) })
+    {
+      accumulator.clear();
+      accumulator.add(point.x(), point.y());
+
+      cv::Mat mat = accumulator.getMat();
+      for (int t = 0; t < mat.rows; t++)
+      {
+        double theta = accumulator.getTheta(t);
+        double radius = point.x() * sin(theta) + point.y() * cos(theta);
+
+        // Exactly one bin in each row gets the vote, which is the nearest to the
+        // true radius, give or take rounding in the fixed point trig table
+        int votedBin = -1;
+        for (int r = 0; r < mat.cols; r++)
+        {
+          if (mat.at<ushort>(t, r) != 0)
+          {
+            EXPECT_EQ ( -1, votedBin );
+            votedBin = r;
+          }
+        }
+
+        ASSERT_NE ( -1, votedBin );
+        EXPECT_NEAR ( radius, accumulator.getRadius(votedBin), radiusResolution * 0.52 );
+      }
+    }
+  }
+}
+
+TEST (HoughLineFinderTests, findLineSegments)
+{
+  HoughLineFinder lineFinder(320, 240);
+
+  // A horizontal line, and a diagonal line with a large gap in it
+  vector<Vector2i> lineDots;
+  for (int x = 20; x < 300; x += 2)
+    lineDots.emplace_back(x, 200);
+  for (int i = 10; i < 80; i += 2)
+    lineDots.emplace_back(i, i);
+  for (int i = 140; i < 220; i += 2)
+    lineDots.emplace_back(i, i);
+
+  auto segments = lineFinder.findLineSegments(lineDots);
+
+  ASSERT_EQ ( 3, segments.size() );
+
+  // Order segments by their leftmost point, with each segment's points ordered left to right
+  for (auto& segment : segments)
+    if (segment.p1().x() > segment.p2().x())
+      segment = LineSegment2i(segment.p2(), segment.p1());
+  sort(segments.begin(), segments.end(), [](LineSegment2i const& a, LineSegment2i const& b) { return a.p1().x() < b.p1().x(); });
+
+  EXPECT_TRUE ( VectorsEqual(Vector2i(10,10),   segments[0].p1(), 1.5) );
+  EXPECT_TRUE ( VectorsEqual(Vector2i(78,78),   segments[0].p2(), 1.5) );
+  EXPECT_TRUE ( VectorsEqual(Vector2i(20,200),  segments[1].p1(), 1.5) );
+  EXPECT_TRUE ( VectorsEqual(Vector2i(298,200), segments[1].p2(), 1.5) );
+  EXPECT_TRUE ( VectorsEqual(Vector2i(140,140), segments[2].p1(), 1.5) );
+  EXPECT_TRUE ( VectorsEqual(Vector2i(218,218), segments[2].p2(), 1.5) );
+}
+
+TEST (HoughLineFinderTests, noLinesInSparseDots)
+{
+  HoughLineFinder lineFinder(320, 240);
+
+  vector<Vector2i> lineDots = { Vector2i(10,10), Vector2i(100,50), Vector2i(200,220), Vector2i(300,5) };
+
+  EXPECT_EQ ( 0, lineFinder.findLineSegments(lineDots).size() );
+}
@@ -0,0 +1,305 @@
+#include <gtest/gtest.h>
+
+#include "../ImageLabeller/imagelabeller.hh"
+#include "../ImageLabelData/imagelabeldata.hh"
+#include "../ImageSampleMap/imagesamplemap.hh"
+#include "../RowLabelCache/rowlabelcache.hh"
+#include "../SequentialTimer/sequentialtimer.hh"
+#include "../util/workerpool.hh"
+
+#include <random>
+
+using namespace bold;
+using namespace std;
+using namespace Eigen;
+
+namespace
+{
+  vector<uchar> randomBytes(size_t count, unsigned seed)
+  {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> dist(0, 255);
+    vector<uchar> bytes(count);
+    for (auto& b : bytes)
+      b = (uchar)dist(rng);
+    return bytes;
+  }
+
+  shared_ptr<LookUpTable const> makeLut(vector<uchar> const& bytes, uchar bitsPerChannel = 6)
+  {
+    auto lut = make_shared<LookUpTable>(LUTColourSpace::YCbCr, bitsPerChannel);
+    copy(bytes.begin(), bytes.end(), lut->data());
+    return lut;
+  }
+}
+
+TEST (ImageLabellerTests, labelRowMatchesScalar)
+{
+  auto lut = randomBytes(1 << 18, 1);
+  auto pixels = randomBytes(320 * 3 * 8, 2);
+
+  for (uchar dx = 1; dx <= 8; dx++)
+  {
+    for (unsigned pixelCount = 0; pixelCount <= 320u / dx; pixelCount++)
+    {
+      vector<uchar> expected(pixelCount + 1, 123);
+      vector<uchar> actual(pixelCount + 1, 123);
+
+      ImageLabeller::labelRowScalar(lut.data(), pixels.data(), expected.data(), pixelCount, dx);
+      ImageLabeller::labelRow(lut.data(), pixels.data(), actual.data(), pixelCount, dx);
+
+      ASSERT_EQ(expected, actual) << "Failed when dx=" << (int)dx << ", pixelCount=" << pixelCount;
+    }
+  }
+}
+
+TEST (ImageLabellerTests, labelRowMatchesScalarAtAllResolutions)
+{
+  auto lut = randomBytes(1 << 24, 9);
+  auto pixels = randomBytes(320 * 3, 10);
+
+  vector<uchar> expected(320);
+  vector<uchar> actual(320);
+
+  ImageLabeller::labelRowScalar<5>(lut.data(), pixels.data(), expected.data(), 320, 1);
+  ImageLabeller::labelRow<5>(lut.data(), pixels.data(), actual.data(), 320, 1);
+  EXPECT_EQ(expected, actual);
+
+  ImageLabeller::labelRowScalar<7>(lut.data(), pixels.data(), expected.data(), 320, 1);
+  ImageLabeller::labelRow<7>(lut.data(), pixels.data(), actual.data(), 320, 1);
+  EXPECT_EQ(expected, actual);
+
+  ImageLabeller::labelRowScalar<8>(lut.data(), pixels.data(), expected.data(), 320, 1);
+  ImageLabeller::labelRow<8>(lut.data(), pixels.data(), actual.data(), 320, 1);
+  EXPECT_EQ(expected, actual);
+
+  for (int x = 0; x < 320; x++)
+  {
+    uchar const* px = pixels.data() + 3 * x;
+    ASSERT_EQ(lut[(px[0] << 16) | (px[1] << 8) | px[2]], actual[x]);
+  }
+}
+
+TEST (ImageLabellerTests, label)
+{
+  auto lut = randomBytes(1 << 18, 3);
+  auto pixels = randomBytes(320 * 240 * 3, 4);
+
+  cv::Mat image(240, 320, CV_8UC3);
+  copy(pixels.begin(), pixels.end(), image.data);
+
+  ImageLabeller labeller(makeLut(lut), nullptr);
+
+  ImageSampleMap sampleMap([](ushort y) { uchar g = y / 50 + 1; return Matrix<uchar,2,1>(g, g); }, 320, 240);
+
+  SequentialTimer timer;
+  auto labelData = labeller.label(image, sampleMap, false, timer);
+
+  EXPECT_EQ(sampleMap.getSampleRowCount(), labelData.getLabelledRowCount());
+
+  for (auto const& row : labelData)
+  {
+    uchar const* px = image.ptr<uchar>(row.imageY);
+    int x = 0;
+    for (uchar const* label = row.begin(); label != row.end(); label++)
+    {
+      ASSERT_LT(x, 320);
+      uchar expected = lut[LookUpTable::index<6>(px[3*x], px[3*x + 1], px[3*x + 2])];
+      ASSERT_EQ(expected, *label) << "Failed when x=" << x << ", y=" << row.imageY;
+      x += row.granularity.x();
+    }
+    EXPECT_GE(x, 320);
+  }
+}
+
+TEST (ImageLabellerTests, labelYUYVMatchesYCbCr)
+{
+  auto yuyv = randomBytes(320 * 240 * 2, 6);
+
+  // Expand YUYV macropixels into YCbCr triplets, as Camera does
+  cv::Mat image(240, 320, CV_8UC3);
+  for (int i = 0; i < 320 * 240 / 2; i++)
+  {
+    uchar const* macropixel = yuyv.data() + 4 * i;
+    uchar* px = image.data + 6 * i;
+    px[0] = macropixel[0]; px[1] = macropixel[1]; px[2] = macropixel[3];
+    px[3] = macropixel[2]; px[4] = macropixel[1]; px[5] = macropixel[3];
+  }
+
+  ImageSampleMap sampleMap([](ushort y) { uchar g = y / 40 + 1; return Matrix<uchar,2,1>(g, g); }, 320, 240);
+
+  for (uchar bits : { 5, 6, 7, 8 })
+  {
+    ImageLabeller labeller(makeLut(randomBytes(1 << (3 * bits), bits), bits), nullptr);
+
+    SequentialTimer timer;
+    auto expected = labeller.label(image, sampleMap, false, timer);
+    auto actual = labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer);
+
+    ASSERT_EQ(expected.getLabelledRowCount(), actual.getLabelledRowCount());
+
+    auto expectedRow = expected.begin();
+    for (auto const& actualRow : actual)
+    {
+      EXPECT_EQ(expectedRow->imageY, actualRow.imageY);
+      ASSERT_TRUE(equal(actualRow.begin(), actualRow.end(), expectedRow->begin())) << "Failed when y=" << actualRow.imageY << ", bits=" << (int)bits;
+      expectedRow++;
+    }
+  }
+}
+
+TEST (ImageLabellerTests, labelRegionMatchesFullImage)
+{
+  auto yuyv = randomBytes(320 * 240 * 2, 7);
+
+  cv::Mat image(240, 320, CV_8UC3);
+  for (int i = 0; i < 320 * 240 / 2; i++)
+  {
+    uchar const* macropixel = yuyv.data() + 4 * i;
+    uchar* px = image.data + 6 * i;
+    px[0] = macropixel[0]; px[1] = macropixel[1]; px[2] = macropixel[3];
+    px[3] = macropixel[2]; px[4] = macropixel[1]; px[5] = macropixel[3];
+  }
+
+  ImageLabeller labeller(makeLut(randomBytes(1 << 18, 8)), nullptr);
+
+  SequentialTimer timer;
+  ImageSampleMap sampleMap([](ushort y) { return Matrix<uchar,2,1>(1, 1); }, 320, 240);
+  auto full = labeller.label(image, sampleMap, false, timer);
+
+  // Odd offsets and widths exercise partial YUYV macropixels
+  for (Bounds2i region : { Bounds2i(0, 0, 319, 239), Bounds2i(17, 33, 94, 60), Bounds2i(300, 230, 319, 239), Bounds2i(5, 5, 6, 6) })
+  {
+    for (bool fromYUYV : { false, true })
+    {
+      auto labelData = fromYUYV
+        ? labeller.labelRegionYUYV(yuyv.data(), 320, 240, region)
+        : labeller.labelRegion(image, region);
+
+      EXPECT_EQ(region.width() + 1, labelData.getImageWidth());
+      ASSERT_EQ(unsigned(region.height() + 1), labelData.getLabelledRowCount());
+
+      int y = region.min().y();
+      for (auto const& row : labelData)
+      {
+        EXPECT_EQ(y, row.imageY);
+        ASSERT_EQ(region.width() + 1, row.end() - row.begin());
+        ASSERT_TRUE(equal(row.begin(), row.end(), full.begin()[y].begin() + region.min().x())) << "Failed when y=" << y << ", YUYV=" << fromYUYV;
+        y++;
+      }
+    }
+  }
+}
+
+TEST (ImageLabellerTests, labelReusesRecycledStorage)
+{
+  auto lut = make_shared<LookUpTable>(LUTColourSpace::YCbCr, 6);
+
+  ImageLabeller labeller(lut, nullptr);
+
+  cv::Mat image(240, 320, CV_8UC3);
+
+  ImageSampleMap sampleMap([](ushort y) { return Matrix<uchar,2,1>(1, 1); }, 320, 240);
+
+  vector<uchar> labels;
+  vector<RowLabels> rows;
+  labels.reserve(sampleMap.getPixelCount());
+  rows.reserve(sampleMap.getSampleRowCount());
+  uchar const* labelStorage = labels.data();
+  RowLabels const* rowStorage = rows.data();
+
+  SequentialTimer timer;
+  for (int i = 0; i < 3; i++)
+  {
+    auto labelData = labeller.label(image, sampleMap, false, timer, move(labels), move(rows));
+
+    EXPECT_EQ(sampleMap.getSampleRowCount(), labelData.getLabelledRowCount());
+    EXPECT_EQ(labelStorage, labelData.begin()->begin());
+    EXPECT_EQ(rowStorage, labelData.begin());
+
+    labelData.recycle(labels, rows);
+
+    EXPECT_EQ(0, labelData.getLabelledRowCount());
+    EXPECT_EQ(labelStorage, labels.data());
+    EXPECT_EQ(rowStorage, rows.data());
+  }
+}
+
+TEST (ImageLabellerTests, parallelLabelMatchesSerial)
+{
+  auto lutBytes = randomBytes(1 << 18, 7);
+  auto pixels = randomBytes(320 * 240 * 3, 8);
+
+  cv::Mat image(240, 320, CV_8UC3);
+  copy(pixels.begin(), pixels.end(), image.data);
+
+  auto lut = makeLut(lutBytes);
+
+  ImageLabeller serialLabeller(lut, nullptr);
+  ImageLabeller parallelLabeller(lut, nullptr, make_shared<WorkerPool>("Test pool", 3));
+  parallelLabeller.setParallel(true);
+
+  ImageSampleMap sampleMap([](ushort y) { uchar g = max(1, min(4, (240 - y) / 40)); return Matrix<uchar,2,1>(g, g); }, 320, 240);
+
+  SequentialTimer timer;
+  for (int i = 0; i < 3; i++)
+  {
+    auto expected = serialLabeller.label(image, sampleMap, false, timer);
+    auto actual = parallelLabeller.label(image, sampleMap, false, timer);
+
+    ASSERT_EQ(expected.getLabelledRowCount(), actual.getLabelledRowCount());
+
+    auto expectedRow = expected.begin();
+    for (auto const& actualRow : actual)
+    {
+      EXPECT_EQ(expectedRow->imageY, actualRow.imageY);
+      EXPECT_EQ(expectedRow->granularity, actualRow.granularity);
+      ASSERT_TRUE(equal(actualRow.begin(), actualRow.end(), expectedRow->begin())) << "Failed when y=" << actualRow.imageY;
+      expectedRow++;
+    }
+  }
+}
+
+TEST (ImageLabellerTests, labelYUYVReusesUnchangedRows)
+{
+  auto yuyv = randomBytes(320 * 240 * 2, 7);
+
+  ImageSampleMap sampleMap([](ushort y) { uchar g = y / 40 + 1; return Matrix<uchar,2,1>(g, g); }, 320, 240);
+  ImageLabeller labeller(makeLut(randomBytes(1 << 18, 8)), nullptr);
+  RowLabelCache rowCache(240, 1.0);
+  SequentialTimer timer;
+
+  auto expectSameLabels = [](ImageLabelData const& expected, ImageLabelData const& actual)
+  {
+    ASSERT_EQ(expected.getLabelledRowCount(), actual.getLabelledRowCount());
+    auto expectedRow = expected.begin();
+    for (auto const& actualRow : actual)
+    {
+      ASSERT_TRUE(equal(actualRow.begin(), actualRow.end(), expectedRow->begin())) << "Failed when y=" << actualRow.imageY;
+      expectedRow++;
+    }
+  };
+
+  // Every row is labelled the first time
+  auto first = labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer, {}, {}, &rowCache);
+  EXPECT_EQ(first.getLabelledRowCount(), rowCache.getChangedRowCount());
+  expectSameLabels(labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer), first);
+
+  // Nothing changed
+  auto second = labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer, {}, {}, &rowCache);
+  EXPECT_EQ(0u, rowCache.getChangedRowCount());
+  expectSameLabels(first, second);
+
+  // Change a small patch of the first row
+  for (int x = 10; x < 16; x++)
+    yuyv[x * 2] += 100;
+  auto third = labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer, {}, {}, &rowCache);
+  EXPECT_EQ(1u, rowCache.getChangedRowCount());
+  expectSameLabels(labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer), third);
+
+  // A new LUT invalidates every row
+  labeller.updateLut(makeLut(randomBytes(1 << 18, 9)));
+  auto fourth = labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer, {}, {}, &rowCache);
+  EXPECT_EQ(fourth.getLabelledRowCount(), rowCache.getChangedRowCount());
+  expectSameLabels(labeller.labelYUYV(yuyv.data(), 320, 240, sampleMap, false, timer), fourth);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include "../ImageLabelData/imagelabeldata.hh"
+#include "../ImagePassHandler/imagepasshandler.hh"
+#include "../ImagePassRunner/imagepassrunner.hh"
+#include "../SequentialTimer/sequentialtimer.hh"
+#include "../State/state.hh"
+#include "../StateObject/ImagePassScheduleState/imagepassschedulestate.hh"
+#include "../util/workerpool.hh"
+
+#include <atomic>
+#include <thread>
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  class CountingPass : public ImagePassHandler
+  {
+  public:
+    CountingPass(string id) : ImagePassHandler(id), processCount(0) {}
+
+    void process(ImageLabelData const& labelData, SequentialTimer& timer) override
+    {
+      processCount++;
+      threadId = this_thread::get_id();
+      timer.timeEvent("Work");
+    }
+
+    void dependOn(vector<ImagePassHandler const*> dependencies) { setDependencies(dependencies); }
+
+    int processCount;
+    thread::id threadId;
+  };
+
+  class OrderedPass : public ImagePassHandler
+  {
+  public:
+    OrderedPass(string id, atomic<int>& counter) : ImagePassHandler(id), order(-1), d_counter(counter) {}
+
+    void process(ImageLabelData const& labelData, SequentialTimer& timer) override
+    {
+      // Give any concurrently running passes a chance to overtake this one
+      this_thread::sleep_for(chrono::milliseconds(5));
+      order = d_counter++;
+    }
+
+    void dependOn(vector<ImagePassHandler const*> dependencies) { setDependencies(dependencies); }
+
+    int order;
+
+  private:
+    atomic<int>& d_counter;
+  };
+}
+
+TEST (ImagePassRunnerTests, serialAndParallel)
+{
+  ImageLabelData labelData({}, {}, 0);
+
+  vector<shared_ptr<CountingPass>> passes = {
+    make_shared<CountingPass>("a"),
+    make_shared<CountingPass>("b"),
+    make_shared<CountingPass>("c")
+  };
+
+  ImagePassRunner runner(make_shared<WorkerPool>("Test pool", 2));
+  for (auto const& pass : passes)
+    runner.addHandler(pass);
+
+  for (bool parallel : { false, true })
+  {
+    runner.setParallel(parallel);
+
+    SequentialTimer timer;
+    runner.pass(labelData, timer);
+    auto timings = *timer.flush();
+
+    for (auto const& pass : passes)
+    {
+      EXPECT_EQ(parallel ? 2 : 1, pass->processCount);
+
+      string prefix = parallel ? "Parallel/" + pass->id() : pass->id();
+      EXPECT_EQ(1, count_if(timings.begin(), timings.end(), [&](EventTiming const& t) { return t.second == prefix; }));
+      EXPECT_EQ(1, count_if(timings.begin(), timings.end(), [&](EventTiming const& t) { return t.second == prefix + "/Work"; }));
+    }
+  }
+}
+
+TEST (ImagePassRunnerTests, dependenciesRunFirst)
+{
+  ImageLabelData labelData({}, {}, 0);
+
+  atomic<int> counter(0);
+  auto a = make_shared<OrderedPass>("a", counter);
+  auto b = make_shared<OrderedPass>("b", counter);
+  auto c = make_shared<OrderedPass>("c", counter);
+  auto d = make_shared<OrderedPass>("d", counter);
+
+  // c depends upon b, which depends upon a. d depends on a pass the runner doesn't hold.
+  auto missing = make_shared<CountingPass>("missing");
+  b->dependOn({ a.get() });
+  c->dependOn({ b.get() });
+  d->dependOn({ missing.get() });
+
+  ImagePassRunner runner(make_shared<WorkerPool>("Test pool", 2));
+  for (auto const& pass : { c, d, b, a })
+    runner.addHandler(pass);
+
+  auto schedule = runner.getSchedule();
+  ASSERT_EQ(3, schedule.size());
+  EXPECT_EQ(vector<string>({ "d", "a" }), schedule[0]);
+  EXPECT_EQ(vector<string>({ "b" }), schedule[1]);
+  EXPECT_EQ(vector<string>({ "c" }), schedule[2]);
+
+  auto scheduleState = State::get<ImagePassScheduleState>();
+  ASSERT_TRUE(scheduleState != nullptr);
+  ASSERT_EQ(3, scheduleState->getStages().size());
+  EXPECT_EQ(vector<string>({ "b" }), scheduleState->getStages()[2][0].dependencies);
+  EXPECT_EQ(0, scheduleState->getStages()[0][0].dependencies.size());
+
+  for (bool parallel : { false, true })
+  {
+    runner.setParallel(parallel);
+    counter = 0;
+
+    SequentialTimer timer;
+    runner.pass(labelData, timer);
+
+    EXPECT_EQ(4, counter);
+    EXPECT_LT(a->order, b->order);
+    EXPECT_LT(b->order, c->order);
+    EXPECT_EQ(0, missing->processCount);
+  }
+}
+
+TEST (ImagePassRunnerTests, replaceHandler)
+{
+  ImageLabelData labelData({}, {}, 0);
+
+  auto a = make_shared<CountingPass>("a");
+  auto b = make_shared<CountingPass>("b");
+  auto user = make_shared<CountingPass>("user");
+  user->dependOn({ a.get() });
+
+  ImagePassRunner runner(make_shared<WorkerPool>("Test pool", 2));
+  runner.addHandler(a);
+  runner.addHandler(user);
+
+  // Reconfiguring happens before the schedule is rebuilt, so the new dependency orders the stages
+  bool configured = false;
+  runner.replaceHandler(a, b, [&]
+  {
+    configured = true;
+    user->dependOn({ b.get() });
+  });
+
+  EXPECT_TRUE(configured);
+
+  auto schedule = runner.getSchedule();
+  ASSERT_EQ(2, schedule.size());
+  EXPECT_EQ(vector<string>({ "b" }), schedule[0]);
+  EXPECT_EQ(vector<string>({ "user" }), schedule[1]);
+
+  SequentialTimer timer;
+  runner.pass(labelData, timer);
+  EXPECT_EQ(0, a->processCount);
+  EXPECT_EQ(1, b->processCount);
+  EXPECT_EQ(1, user->processCount);
+
+  // Replacing a handler the runner does not hold just adds the new one
+  auto c = make_shared<CountingPass>("c");
+  runner.replaceHandler(a, c);
+  EXPECT_EQ(3, runner.getSchedule()[0].size() + runner.getSchedule()[1].size());
+}
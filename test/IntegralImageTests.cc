@@ -45,3 +45,33 @@ TEST (IntegralImageTests, create)
   EXPECT_EQ ( 4*2, integral.getSummedArea(Vector2i(0, 0), Vector2i(3, 1)) );
   EXPECT_EQ ( 2*4, integral.getSummedArea(Vector2i(0, 0), Vector2i(1, 3)) );
 }
+
+TEST (IntegralImageTests, createNonUniform)
+{
+  int rows = 6;
+  int cols = 7;
+  cv::Mat image(cv::Size(cols, rows), CV_8UC1);
+
+  for (int y = 0; y < rows; y++)
+  {
+    for (int x = 0; x < cols; x++)
+      image.at<uchar>(y, x) = uchar(x + 10 * y);
+  }
+
+  IntegralImage integral = IntegralImage::create(image);
+
+  for (int y = 0; y < rows; y++)
+  {
+    for (int x = 0; x < cols; x++)
+    {
+      int expected = 0;
+      for (int j = 0; j <= y; j++)
+        for (int i = 0; i <= x; i++)
+          expected += i + 10 * j;
+      ASSERT_EQ(expected, integral.at(x, y)) << "Failed when x=" << x << ", y=" << y;
+    }
+  }
+
+  // A single pixel away from the origin
+  EXPECT_EQ ( 3 + 10 * 4, integral.getSummedArea(Vector2i(3, 4), Vector2i(3, 4)) );
+}
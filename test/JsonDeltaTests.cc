@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include "../JsonDelta/jsondelta.hh"
+
+using namespace bold;
+using namespace std;
+
+TEST (JsonDeltaTests, unchanged)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":1,"b":[1,2]})", R"({"a":1,"b":[1,2]})", delta));
+  EXPECT_EQ("{}", delta);
+}
+
+TEST (JsonDeltaTests, changedMembers)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":1,"b":[1,2],"c":"x"})", R"({"a":2,"b":[1,2],"c":"y"})", delta));
+  EXPECT_EQ(R"({"a":2,"c":"y"})", delta);
+}
+
+TEST (JsonDeltaTests, arraysReplacedWhole)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":[1,2,3]})", R"({"a":[1,2,4]})", delta));
+  EXPECT_EQ(R"({"a":[1,2,4]})", delta);
+}
+
+TEST (JsonDeltaTests, nestedObjects)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":{"x":1,"y":{"z":[1]}},"b":null})",
+                                 R"({"a":{"x":1,"y":{"z":[2]}},"b":null})", delta));
+  EXPECT_EQ(R"({"a":{"y":{"z":[2]}}})", delta);
+}
+
+TEST (JsonDeltaTests, addedMembers)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":1})", R"({"a":1,"b":{"c":true}})", delta));
+  EXPECT_EQ(R"({"b":{"c":true}})", delta);
+}
+
+TEST (JsonDeltaTests, typeChanges)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":null,"b":{"c":1}})", R"({"a":{"c":1},"b":null})", delta));
+  EXPECT_EQ(R"({"a":{"c":1},"b":null})", delta);
+}
+
+TEST (JsonDeltaTests, reorderedMembers)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":1,"b":2})", R"({"b":3,"a":1})", delta));
+  EXPECT_EQ(R"({"b":3})", delta);
+}
+
+TEST (JsonDeltaTests, stringsContainingDelimiters)
+{
+  string delta;
+  EXPECT_TRUE(JsonDelta::compute(R"({"a":"},\"[","b":1})", R"({"a":"},\"[","b":2})", delta));
+  EXPECT_EQ(R"({"b":2})", delta);
+}
+
+TEST (JsonDeltaTests, removedMembersNeedFullCopy)
+{
+  string delta;
+  EXPECT_FALSE(JsonDelta::compute(R"({"a":1,"b":2})", R"({"a":1})", delta));
+  EXPECT_FALSE(JsonDelta::compute(R"({"a":{"x":1,"y":2}})", R"({"a":{"x":1}})", delta));
+}
+
+TEST (JsonDeltaTests, nonObjectsNeedFullCopy)
+{
+  string delta;
+  EXPECT_FALSE(JsonDelta::compute("[1,2]", "[1,3]", delta));
+  EXPECT_FALSE(JsonDelta::compute(R"({"a":1})", "null", delta));
+  EXPECT_FALSE(JsonDelta::compute(R"({"a":1)", R"({"a":2})", delta));
+}
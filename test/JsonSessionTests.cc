@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "../DataStreamer/datastreamer.hh"
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  shared_ptr<WebSocketBuffer> makeBuffer()
+  {
+    WebSocketBuffer buffer;
+    buffer.Put('x');
+    return JsonSession::share(move(buffer));
+  }
+}
+
+TEST (JsonSessionTests, canReplace)
+{
+  auto text = JsonSession::Message{makeBuffer(), false, false};
+  auto newerText = JsonSession::Message{makeBuffer(), false, false};
+  auto binary = JsonSession::Message{makeBuffer(), true, false};
+  auto newerBinary = JsonSession::Message{makeBuffer(), true, false};
+
+  EXPECT_TRUE(JsonSession::canReplace(text, false, newerText));
+  EXPECT_TRUE(JsonSession::canReplace(binary, false, newerBinary));
+
+  // Not once sending has begun
+  EXPECT_FALSE(JsonSession::canReplace(text, true, newerText));
+
+  // Not across encodings, as text may be the schema for the binary that follows
+  EXPECT_FALSE(JsonSession::canReplace(text, false, binary));
+  EXPECT_FALSE(JsonSession::canReplace(binary, false, text));
+}
+
+TEST (JsonSessionTests, canReplaceKeyframe)
+{
+  auto keyframe = JsonSession::Message{makeBuffer(), false, true};
+  auto newerKeyframe = JsonSession::Message{makeBuffer(), false, true};
+  auto delta = JsonSession::Message{makeBuffer(), false, false};
+
+  // Deltas that follow a keyframe depend upon it
+  EXPECT_FALSE(JsonSession::canReplace(keyframe, false, delta));
+  EXPECT_FALSE(JsonSession::canReplace(keyframe, false, newerKeyframe));
+
+  // The same keyframe sent again takes its place
+  EXPECT_TRUE(JsonSession::canReplace(keyframe, false, keyframe));
+  EXPECT_FALSE(JsonSession::canReplace(keyframe, true, keyframe));
+
+  // A keyframe may replace a delta
+  EXPECT_TRUE(JsonSession::canReplace(delta, false, keyframe));
+}
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include "../KeyframeTracker/keyframetracker.hh"
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  const double Timeout = 2.0;
+
+  Clock::Timestamp seconds(double s)
+  {
+    return static_cast<Clock::Timestamp>(s * 1e6);
+  }
+
+  KeyframeTracker::Keyframe keyframe(long long unsigned id)
+  {
+    return {id, make_shared<string const>("{\"id\":" + to_string(id) + "}")};
+  }
+}
+
+TEST (KeyframeTrackerTests, keyframeDueUntilAcknowledged)
+{
+  KeyframeTracker tracker;
+
+  EXPECT_TRUE(tracker.isKeyframeDue(10, seconds(0), Timeout));
+  EXPECT_EQ(nullptr, tracker.getAcknowledgedKeyframe());
+  EXPECT_EQ(nullptr, tracker.getAwaitedKeyframe(seconds(0), Timeout));
+
+  tracker.keyframeSent(keyframe(1), seconds(0));
+
+  EXPECT_TRUE(tracker.isKeyframeDue(10, seconds(0.1), Timeout));
+  ASSERT_NE(nullptr, tracker.getAwaitedKeyframe(seconds(0.1), Timeout));
+  EXPECT_EQ(1, tracker.getAwaitedKeyframe(seconds(0.1), Timeout)->id);
+
+  EXPECT_TRUE(tracker.acknowledge(1));
+
+  EXPECT_FALSE(tracker.isKeyframeDue(10, seconds(0.2), Timeout));
+  ASSERT_NE(nullptr, tracker.getAcknowledgedKeyframe());
+  EXPECT_EQ(1, tracker.getAcknowledgedKeyframe()->id);
+  EXPECT_EQ(nullptr, tracker.getAwaitedKeyframe(seconds(0.2), Timeout));
+}
+
+TEST (KeyframeTrackerTests, lateAcknowledgement)
+{
+  KeyframeTracker tracker;
+
+  // A slow client acknowledges its first keyframe many updates after it was
+  // sent. Until then, the same keyframe is awaited, rather than each update
+  // replacing it with a new one that the acknowledgement would not name.
+  tracker.keyframeSent(keyframe(1), seconds(0));
+
+  for (long long unsigned update = 2; update < 50; update++)
+  {
+    auto now = seconds(update * 0.033);
+    auto awaited = tracker.getAwaitedKeyframe(now, Timeout);
+    ASSERT_NE(nullptr, awaited);
+    EXPECT_EQ(1, awaited->id);
+    tracker.keyframeSent(*awaited, now);
+  }
+
+  EXPECT_TRUE(tracker.acknowledge(1));
+  EXPECT_FALSE(tracker.isKeyframeDue(10, seconds(1.7), Timeout));
+  EXPECT_EQ(1, tracker.getAcknowledgedKeyframe()->id);
+}
+
+TEST (KeyframeTrackerTests, acknowledgementAfterTimeout)
+{
+  KeyframeTracker tracker;
+
+  tracker.keyframeSent(keyframe(1), seconds(0));
+
+  // Once timed out, a new keyframe is sent
+  EXPECT_EQ(nullptr, tracker.getAwaitedKeyframe(seconds(2.5), Timeout));
+  tracker.keyframeSent(keyframe(60), seconds(2.5));
+
+  // The first keyframe's acknowledgement arrives late, and is still accepted
+  EXPECT_TRUE(tracker.acknowledge(1));
+  EXPECT_EQ(1, tracker.getAcknowledgedKeyframe()->id);
+  EXPECT_FALSE(tracker.isKeyframeDue(10, seconds(2.6), Timeout));
+
+  // The newer keyframe remains awaited, and may be acknowledged later
+  ASSERT_NE(nullptr, tracker.getAwaitedKeyframe(seconds(2.6), Timeout));
+  EXPECT_EQ(60, tracker.getAwaitedKeyframe(seconds(2.6), Timeout)->id);
+  EXPECT_TRUE(tracker.acknowledge(60));
+  EXPECT_EQ(60, tracker.getAcknowledgedKeyframe()->id);
+
+  // Older keyframes can no longer be acknowledged
+  EXPECT_FALSE(tracker.acknowledge(1));
+  EXPECT_FALSE(tracker.acknowledge(99));
+  EXPECT_EQ(60, tracker.getAcknowledgedKeyframe()->id);
+}
+
+TEST (KeyframeTrackerTests, periodicKeyframeWaitsForAcknowledgement)
+{
+  KeyframeTracker tracker;
+
+  tracker.keyframeSent(keyframe(1), seconds(0));
+  tracker.acknowledge(1);
+
+  for (int i = 0; i < 3; i++)
+  {
+    EXPECT_FALSE(tracker.isKeyframeDue(3, seconds(0.1), Timeout));
+    tracker.deltaSent();
+  }
+
+  EXPECT_TRUE(tracker.isKeyframeDue(3, seconds(0.2), Timeout));
+  tracker.keyframeSent(keyframe(5), seconds(0.2));
+
+  // Deltas against the acknowledged keyframe continue while the new one is awaited
+  EXPECT_FALSE(tracker.isKeyframeDue(3, seconds(0.3), Timeout));
+  EXPECT_EQ(1, tracker.getAcknowledgedKeyframe()->id);
+  for (int i = 0; i < 5; i++)
+    tracker.deltaSent();
+  EXPECT_FALSE(tracker.isKeyframeDue(3, seconds(0.4), Timeout));
+
+  // Unless it is not acknowledged in time
+  EXPECT_TRUE(tracker.isKeyframeDue(3, seconds(2.3), Timeout));
+}
+
+TEST (KeyframeTrackerTests, reset)
+{
+  KeyframeTracker tracker;
+
+  tracker.keyframeSent(keyframe(1), seconds(0));
+  tracker.acknowledge(1);
+  tracker.keyframeSent(keyframe(2), seconds(0));
+
+  tracker.reset();
+
+  EXPECT_TRUE(tracker.isKeyframeDue(10, seconds(0), Timeout));
+  EXPECT_EQ(nullptr, tracker.getAcknowledgedKeyframe());
+  EXPECT_EQ(nullptr, tracker.getAwaitedKeyframe(seconds(0), Timeout));
+  EXPECT_FALSE(tracker.acknowledge(2));
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "../LUTBuilder/lutbuilder.hh"
+#include "../PixelLabel/RangePixelLabel/rangepixellabel.hh"
+#include "../util/workerpool.hh"
+
+#include <cstring>
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  vector<shared_ptr<PixelLabel>> makeLabels()
+  {
+    return {
+      make_shared<RangePixelLabel>("Goal",  LabelClass::GOAL,  Colour::hsvRange(30, 60, 158, 236, 124, 222)),
+      make_shared<RangePixelLabel>("Ball",  LabelClass::BALL,  Colour::hsvRange(248, 30, 72, 255, 12, 255)),
+      make_shared<RangePixelLabel>("Field", LabelClass::FIELD, Colour::hsvRange(72, 118, 166, 236, 52, 192)),
+      make_shared<RangePixelLabel>("Line",  LabelClass::LINE,  Colour::hsvRange(0, 255, 0, 167, 161, 255))
+    };
+  }
+}
+
+TEST (LUTBuilderTests, buildInParallel)
+{
+  auto labels = makeLabels();
+
+  WorkerPool workerPool("Test pool", 3);
+
+  for (uchar bits : { 5, 6 })
+  {
+    auto expected = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, bits, labels);
+    auto actual = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, bits, labels, &workerPool);
+
+    ASSERT_EQ(expected->getSize(), actual->getSize());
+    EXPECT_EQ(0, memcmp(expected->data(), actual->data(), expected->getSize()));
+  }
+}
+
+TEST (LUTBuilderTests, buildAtEachResolution)
+{
+  auto labels = makeLabels();
+
+  WorkerPool workerPool("Test pool", 3);
+
+  for (uchar bits : { 5, 6, 7, 8 })
+  {
+    auto lut = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, bits, labels, &workerPool);
+
+    EXPECT_EQ(LUTColourSpace::YCbCr, lut->getColourSpace());
+    EXPECT_EQ(bits, lut->getBitsPerChannel());
+    EXPECT_EQ(size_t(1) << (3 * bits), lut->getSize());
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(lut->data()) % 64);
+
+    // Each cell labels the colour at the bottom of its quantisation step
+    for (int y = 0; y < 256; y += 37)
+      for (int cb = 0; cb < 256; cb += 29)
+        for (int cr = 0; cr < 256; cr += 31)
+        {
+          uchar mask = 0xFF << (8 - bits);
+          auto bgr = Colour::YCbCr(y & mask, cb & mask, cr & mask).toBgrInt();
+          ASSERT_EQ(LUTBuilder::labelPixel(labels, bgr), lut->lookUp(y, cb, cr)) << "Failed for bits=" << (int)bits;
+        }
+  }
+
+  auto bgr = LUTBuilder::buildLookUpTable(LUTColourSpace::BGR, 6, labels);
+  EXPECT_EQ(LUTBuilder::labelPixel(labels, Colour::bgr(40, 200, 120)), bgr->lookUp(40, 200, 120));
+  EXPECT_EQ("bgr18", bgr->getName());
+}
+
+TEST (LUTBuilderTests, updateMatchesFullBuild)
+{
+  auto labels = makeLabels();
+  auto ball = static_pointer_cast<RangePixelLabel>(labels[1]);
+
+  WorkerPool workerPool("Test pool", 3);
+
+  auto updated = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, 6, labels);
+
+  vector<Colour::hsvRange> ranges = {
+    Colour::hsvRange(240, 40, 40, 255, 12, 255),  // grow
+    Colour::hsvRange(0, 20, 100, 200, 50, 200),    // shrink
+    Colour::hsvRange(60, 100, 150, 255, 100, 255), // overlap field and goal
+    Colour::hsvRange(60, 100, 150, 255, 100, 255)  // unchanged
+  };
+
+  for (unsigned i = 0; i < ranges.size(); i++)
+  {
+    auto const& range = ranges[i];
+    auto oldRange = ball->getHSVRange();
+    ball->setHSVRange(range);
+
+    unsigned relabelCount = LUTBuilder::updateLookUpTable(*updated, labels, oldRange, range, &workerPool);
+
+    if (oldRange == range)
+      EXPECT_EQ(0, relabelCount);
+    else
+      EXPECT_LT(relabelCount, 1u<<18);
+
+    auto expected = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, 6, labels);
+    ASSERT_EQ(0, memcmp(expected->data(), updated->data(), 1<<18)) << "Failed for range " << i;
+  }
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include "../LUTCache/lutcache.hh"
+#include "../PixelLabel/RangePixelLabel/rangepixellabel.hh"
+#include "../PixelLabel/HistogramPixelLabel/histogrampixellabel.hh"
+
+#include <cstring>
+#include <unistd.h>
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  string makeTempDirectory()
+  {
+    char path[] = "/tmp/lutcachetestXXXXXX";
+    EXPECT_NE(nullptr, mkdtemp(path));
+    return path;
+  }
+}
+
+TEST (LUTCacheTests, getKey)
+{
+  auto goal = make_shared<RangePixelLabel>("Goal", LabelClass::GOAL, Colour::hsvRange(30, 60, 158, 236, 124, 222));
+  auto ball = make_shared<RangePixelLabel>("Ball", LabelClass::BALL, Colour::hsvRange(248, 30, 72, 255, 12, 255));
+
+  vector<shared_ptr<PixelLabel>> labels = { goal, ball };
+
+  auto key = LUTCache::getKey("ycbcr18", labels);
+
+  EXPECT_EQ(key, LUTCache::getKey("ycbcr18", labels));
+  EXPECT_EQ(0, key.find("ycbcr18-"));
+
+  // Type, order and ranges all matter
+  EXPECT_NE(key, LUTCache::getKey("bgr18", labels));
+  EXPECT_NE(key, LUTCache::getKey("ycbcr18", vector<shared_ptr<PixelLabel>>{ ball, goal }));
+
+  ball->setHSVRange(Colour::hsvRange(248, 30, 72, 255, 13, 255));
+  EXPECT_NE(key, LUTCache::getKey("ycbcr18", labels));
+
+  // Histogram contents matter
+  auto histogram = make_shared<HistogramPixelLabel<4>>("Field", LabelClass::FIELD);
+  labels.push_back(histogram);
+  auto histogramKey = LUTCache::getKey("ycbcr18", labels);
+  histogram->addSample(Colour::hsv(80, 200, 100));
+  EXPECT_NE(histogramKey, LUTCache::getKey("ycbcr18", labels));
+}
+
+TEST (LUTCacheTests, writeAndLoad)
+{
+  auto directory = makeTempDirectory();
+  LUTCache cache(directory, 2);
+
+  EXPECT_EQ(nullptr, cache.load("missing", LUTColourSpace::YCbCr, 6));
+
+  vector<uchar> lut(1<<18);
+  for (unsigned i = 0; i < lut.size(); i++)
+    lut[i] = i % 7;
+
+  ASSERT_TRUE(cache.write("ycbcr18-a", lut.data(), lut.size()));
+
+  auto loaded = cache.load("ycbcr18-a", LUTColourSpace::YCbCr, 6);
+  ASSERT_NE(nullptr, loaded);
+  EXPECT_EQ(LUTColourSpace::YCbCr, loaded->getColourSpace());
+  EXPECT_EQ(6, loaded->getBitsPerChannel());
+  EXPECT_EQ(0, memcmp(lut.data(), loaded->data(), lut.size()));
+
+  // A size mismatch is treated as a miss
+  EXPECT_EQ(nullptr, cache.load("ycbcr18-a", LUTColourSpace::YCbCr, 8));
+
+  // Only the newest two entries are kept
+  usleep(50000);
+  ASSERT_TRUE(cache.write("ycbcr18-b", lut.data(), lut.size()));
+  usleep(50000);
+  ASSERT_TRUE(cache.write("ycbcr18-c", lut.data(), lut.size()));
+
+  EXPECT_EQ(nullptr, cache.load("ycbcr18-a", LUTColourSpace::YCbCr, 6));
+  EXPECT_NE(nullptr, cache.load("ycbcr18-b", LUTColourSpace::YCbCr, 6));
+  EXPECT_NE(nullptr, cache.load("ycbcr18-c", LUTColourSpace::YCbCr, 6));
+
+  // Mapped LUTs stay valid after their file is removed
+  for (auto name : { "b", "c" })
+    unlink((directory + "/ycbcr18-" + name + ".lut").c_str());
+  rmdir(directory.c_str());
+
+  EXPECT_EQ(0, memcmp(lut.data(), loaded->data(), lut.size()));
+}
+
+TEST (LUTCacheTests, storeWaitsForQuiet)
+{
+  auto directory = makeTempDirectory();
+
+  auto lut = make_shared<LookUpTable>(LUTColourSpace::YCbCr, 6);
+
+  {
+    LUTCache cache(directory, 8, 0.2);
+
+    // Each store supersedes the one before it, if that has not yet been written
+    cache.store("ycbcr18-a", lut);
+    cache.store("ycbcr18-b", lut);
+    usleep(50000);
+    cache.store("ycbcr18-c", lut);
+
+    usleep(100000);
+    EXPECT_NE(0, access((directory + "/ycbcr18-c.lut").c_str(), F_OK)) << "Written before the store delay";
+
+    usleep(300000);
+    EXPECT_EQ(0, access((directory + "/ycbcr18-c.lut").c_str(), F_OK));
+    EXPECT_NE(0, access((directory + "/ycbcr18-a.lut").c_str(), F_OK));
+    EXPECT_NE(0, access((directory + "/ycbcr18-b.lut").c_str(), F_OK));
+
+    // A store still waiting when the cache is destroyed is written straight away
+    cache.store("ycbcr18-d", lut);
+  }
+
+  EXPECT_EQ(0, access((directory + "/ycbcr18-d.lut").c_str(), F_OK));
+
+  for (auto name : { "c", "d" })
+    unlink((directory + "/ycbcr18-" + name + ".lut").c_str());
+  rmdir(directory.c_str());
+}
+
+TEST (LUTCacheTests, loadKeepsEntryFromPruning)
+{
+  auto directory = makeTempDirectory();
+  LUTCache cache(directory, 2);
+
+  vector<uchar> lut(1<<18);
+
+  ASSERT_TRUE(cache.write("ycbcr18-a", lut.data(), lut.size()));
+  usleep(50000);
+  ASSERT_TRUE(cache.write("ycbcr18-b", lut.data(), lut.size()));
+  usleep(50000);
+
+  // Loading the oldest entry makes it the most recently used
+  ASSERT_NE(nullptr, cache.load("ycbcr18-a", LUTColourSpace::YCbCr, 6));
+  usleep(50000);
+  ASSERT_TRUE(cache.write("ycbcr18-c", lut.data(), lut.size()));
+
+  EXPECT_NE(nullptr, cache.load("ycbcr18-a", LUTColourSpace::YCbCr, 6));
+  EXPECT_EQ(nullptr, cache.load("ycbcr18-b", LUTColourSpace::YCbCr, 6));
+  EXPECT_NE(nullptr, cache.load("ycbcr18-c", LUTColourSpace::YCbCr, 6));
+
+  for (auto name : { "a", "c" })
+    unlink((directory + "/ycbcr18-" + name + ".lut").c_str());
+  rmdir(directory.c_str());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "../RowLabelCache/rowlabelcache.hh"
+
+#include <random>
+
+using namespace bold;
+using namespace std;
+
+namespace
+{
+  // Labels each sample with its column, so copied labels are recognisable
+  auto labelByColumn = [](uchar const* row, unsigned x, uchar* out, unsigned pixelCount, uchar dx)
+  {
+    for (unsigned i = 0; i < pixelCount; i++, x += dx)
+      out[i] = uchar(x);
+  };
+}
+
+TEST (RowLabelCacheTests, toleratesNoise)
+{
+  vector<uchar> row(64 * 2, 128);
+  vector<uchar> labels(64);
+
+  RowLabelCache cache(1, 2.0);
+  auto lut = make_shared<LookUpTable>(LUTColourSpace::YCbCr, 6);
+
+  cache.beginFrame(lut);
+  cache.label(row.data(), 0, 0, labels.data(), 64, 1, labelByColumn);
+  EXPECT_EQ(1u, cache.getChangedRowCount());
+
+  // Small noise across the row leaves it unchanged
+  mt19937 rng(1);
+  uniform_int_distribution<int> noise(-1, 1);
+  for (auto& b : row)
+    b += noise(rng);
+
+  fill(labels.begin(), labels.end(), 0);
+  cache.beginFrame(lut);
+  cache.label(row.data(), 0, 0, labels.data(), 64, 1, [](uchar const*, unsigned, uchar*, unsigned, uchar) { FAIL(); });
+  EXPECT_EQ(0u, cache.getChangedRowCount());
+  EXPECT_EQ(63, labels[63]);
+
+  // A bright object a few pixels wide is a change
+  for (int x = 40; x < 44; x++)
+    row[x * 2] = 250;
+
+  cache.beginFrame(lut);
+  cache.label(row.data(), 0, 0, labels.data(), 64, 1, labelByColumn);
+  EXPECT_EQ(1u, cache.getChangedRowCount());
+}
+
+TEST (RowLabelCacheTests, relabelsDifferentSpan)
+{
+  vector<uchar> row(64 * 2, 128);
+  vector<uchar> labels(64);
+
+  RowLabelCache cache(1, 2.0);
+  auto lut = make_shared<LookUpTable>(LUTColourSpace::YCbCr, 6);
+
+  cache.beginFrame(lut);
+  cache.label(row.data(), 0, 0, labels.data(), 64, 1, labelByColumn);
+
+  // The same pixels sampled with a different granularity must be labelled afresh
+  cache.beginFrame(lut);
+  cache.label(row.data(), 0, 0, labels.data(), 32, 2, labelByColumn);
+  EXPECT_EQ(1u, cache.getChangedRowCount());
+  EXPECT_EQ(62, labels[31]);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "helpers.hh"
+#include "../CameraModel/cameramodel.hh"
+#include "../Config/config.hh"
+#include "../IncrementalRegression/incrementalregression.hh"
+#include "../LineFinder/ScanningLineFinder/scanninglinefinder.hh"
+#include "../util/memory.hh"
+
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <random>
+
+using namespace std;
+using namespace bold;
+using namespace Eigen;
+
+namespace
+{
+  // Compares each dot against every regression, rather than only those in
+  // neighbouring bands, as a reference for ScanningLineFinder
+  vector<LineSegment2i> findLineSegmentsExhaustively(vector<Vector2i> dots, double maxHeadDist, double worstFitAllowed, double minLength, double minCoverage)
+  {
+    sort(dots.begin(), dots.end(), [](Vector2i const& a, Vector2i const& b) { return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y()); });
+    dots.erase(unique(dots.begin(), dots.end()), dots.end());
+
+    vector<IncrementalRegression,aligned_allocator<IncrementalRegression>> regressions;
+    for (Vector2i const& dot : dots)
+    {
+      Vector2f point = dot.cast<float>();
+      auto bestFittingRegression = regressions.end();
+      float bestFit = worstFitAllowed + 1;
+
+      for (auto iter = begin(regressions); iter != end(regressions); ++iter)
+      {
+        if (!((iter->head() - point).norm() <= maxHeadDist))
+          continue;
+        auto fit = iter->fit(point);
+        if (fit > worstFitAllowed || fit > bestFit)
+          continue;
+        bestFit = fit;
+        bestFittingRegression = iter;
+      }
+
+      if (bestFittingRegression != regressions.end())
+      {
+        bestFittingRegression->addPoint(point);
+        bestFittingRegression->solve();
+      }
+      else
+      {
+        IncrementalRegression newRegression;
+        newRegression.setSqError(100.0);
+        newRegression.addPoint(point);
+        regressions.push_back(newRegression);
+      }
+    }
+
+    vector<LineSegment2i> lineSegments;
+    for (auto& regression : regressions)
+    {
+      if (regression.getNPoints() < 2 || regression.isVertical())
+        continue;
+      auto lineSegment = regression.getLineSegment();
+      float length = lineSegment.length();
+      if (length < minLength || float(regression.getNPoints()) / length < minCoverage)
+        continue;
+      lineSegments.emplace_back(lineSegment.cast<int>());
+    }
+    return lineSegments;
+  }
+
+  // Noisy dots along a few random lines, plus some scattered at random
+  vector<Vector2i> makeRandomDots(mt19937& rng, int width, int height)
+  {
+    uniform_real_distribution<double> xDist(0, width - 1);
+    uniform_real_distribution<double> yDist(0, height - 1);
+    normal_distribution<double> noise(0, 1.0);
+
+    vector<Vector2i> dots;
+    auto add = [&](double x, double y)
+    {
+      int ix = int(round(x));
+      int iy = int(round(y));
+      if (ix >= 0 && ix < width && iy >= 0 && iy < height)
+        dots.emplace_back(ix, iy);
+    };
+
+    for (int line = 0; line < 6; line++)
+    {
+      Vector2d from(xDist(rng), yDist(rng));
+      Vector2d to(xDist(rng), yDist(rng));
+      int steps = int((to - from).norm() / 2);
+      for (int i = 0; i <= steps; i++)
+      {
+        Vector2d p = from + (to - from) * (steps == 0 ? 0.0 : double(i) / steps);
+        add(p.x() + noise(rng), p.y() + noise(rng));
+      }
+    }
+
+    for (int i = 0; i < 100; i++)
+      add(xDist(rng), yDist(rng));
+
+    shuffle(dots.begin(), dots.end(), rng);
+    return dots;
+  }
+}
+
+TEST (ScanningLineFinderTests, matchesExhaustiveSearch)
+{
+  int width = 320;
+  int height = 240;
+
+  auto cameraModel = allocate_aligned_shared<CameraModel>(width, height, 45, 60);
+  ScanningLineFinder lineFinder(cameraModel);
+
+  double maxHeadDist = Config::getValue<double>("vision.line-detection.scanning.max-head-dist");
+  double maxRMSFactor = Config::getValue<double>("vision.line-detection.scanning.max-rms-factor");
+  double minLength = Config::getValue<double>("vision.line-detection.scanning.min-length");
+  double minCoverage = Config::getValue<double>("vision.line-detection.scanning.min-coverage");
+
+  for (unsigned seed = 1; seed <= 50; seed++)
+  {
+    mt19937 rng(seed);
+    auto dots = makeRandomDots(rng, width, height);
+
+    auto expected = findLineSegmentsExhaustively(dots, maxHeadDist, maxRMSFactor, minLength, minCoverage);
+    auto actual = lineFinder.findLineSegments(dots);
+
+    ASSERT_EQ ( expected.size(), actual.size() ) << "Failed with seed " << seed;
+    for (unsigned i = 0; i < expected.size(); i++)
+      EXPECT_EQ ( expected[i], actual[i] ) << "Failed with seed " << seed << " at line " << i;
+  }
+}
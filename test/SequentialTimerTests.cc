@@ -176,3 +176,29 @@ TEST(SequentialTimerTests, nesting3)
   EXPECT_EQ("b/c", items[1].second); EXPECT_BETWEEN( 50,  70, items[1].first);
   EXPECT_EQ("b",   items[2].second); EXPECT_BETWEEN(150, 190, items[2].first);
 }
+
+TEST(SequentialTimerTests, append)
+{
+  SequentialTimer worker;
+  worker.enter("c");
+  worker.timeEvent("d");
+  worker.exit();
+
+  SequentialTimer t;
+  t.enter("a");
+  {
+    t.enter("b");
+    t.append(*worker.flush());
+    t.exit();
+  }
+  t.exit();
+
+  auto items = *t.flush();
+
+  ASSERT_EQ(4, items.size());
+
+  EXPECT_EQ("a/b/c/d", items[0].second);
+  EXPECT_EQ("a/b/c",   items[1].second);
+  EXPECT_EQ("a/b",     items[2].second);
+  EXPECT_EQ("a",       items[3].second);
+}
@@ -402,3 +402,39 @@ TEST (SpatialiserTests, findHorizonForColumnWideCam)
   EXPECT_EQ ( 5, spatialiser.findHorizonForColumn(5, cameraAgentTr) );
   EXPECT_EQ ( 10, spatialiser.findHorizonForColumn(10, cameraAgentTr) );
 }
+
+TEST (SpatialiserTests, findPixelDistanceForGroundStepMatchesProjection)
+{
+  Spatialiser spatialiser = createTestSpatialiser(60, 60);
+
+  double const step = 0.01;
+
+  // Look forward and down at the ground, from varying heights and angles
+  for (double height : { 0.3, 0.5 })
+  {
+    for (double tilt : { -M_PI/2, -M_PI/3, -M_PI/6 })
+    {
+      Affine3d agentCameraTr = Translation3d(0,0,height) * AngleAxisd(tilt, Vector3d::UnitX()) * AngleAxisd(0.1, Vector3d::UnitZ());
+      spatialiser.updateZeroGroundPixelTransform(agentCameraTr);
+
+      for (int y = 0; y < imageHeight; y++)
+      {
+        Vector2d pixel(imageWidth / 2.0, y);
+        auto distance = spatialiser.findPixelDistanceForGroundStep(y, step);
+
+        auto groundPoint = spatialiser.findGroundPointForPixel(pixel);
+        if (!groundPoint.hasValue())
+        {
+          EXPECT_FALSE ( distance.hasValue() );
+          continue;
+        }
+
+        auto offsetPixel = spatialiser.findPixelForAgentPoint(*groundPoint + Vector3d(step, 0, 0), agentCameraTr.inverse());
+        ASSERT_EQ ( offsetPixel.hasValue(), distance.hasValue() );
+
+        if (offsetPixel.hasValue())
+          EXPECT_NEAR ( (*offsetPixel - pixel).norm(), *distance, 1e-6 ) << "Failed when y=" << y << ", tilt=" << tilt;
+      }
+    }
+  }
+}
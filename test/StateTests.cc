@@ -64,3 +64,23 @@ TEST (StateTests, setAndGet)
   EXPECT_EQ(2, state->getTimings()->size());
   EXPECT_EQ(12.34, state->getAverageFps());
 }
+
+TEST (StateTests, stateIfUpdatedSinceCoalesces)
+{
+  auto tracker = State::getTracker<MotionTimingState>();
+  auto updateCount = tracker->updateCount();
+
+  EXPECT_EQ(nullptr, tracker->stateIfUpdatedSince(updateCount));
+
+  auto eventTimings = make_shared<vector<EventTiming>>();
+  State::make<MotionTimingState>(eventTimings, 3, 1.0);
+  State::make<MotionTimingState>(eventTimings, 4, 2.0);
+
+  // Only the latest of the two versions is returned
+  auto state = dynamic_pointer_cast<MotionTimingState const>(tracker->stateIfUpdatedSince(updateCount));
+  ASSERT_NE(nullptr, state);
+  EXPECT_EQ(2.0, state->getAverageFps());
+  EXPECT_EQ(tracker->updateCount(), updateCount);
+
+  EXPECT_EQ(nullptr, tracker->stateIfUpdatedSince(updateCount));
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <vector>
+
+#include "../util/workerpool.hh"
+
+using namespace bold;
+using namespace std;
+
+TEST (WorkerPoolTests, runsEachTaskOnce)
+{
+  WorkerPool pool("Test pool", 3);
+
+  EXPECT_EQ(4, pool.getConcurrency());
+
+  // Run many batches to exercise reuse of the threads
+  for (unsigned batch = 0; batch < 200; batch++)
+  {
+    unsigned taskCount = batch % 17;
+    vector<atomic<int>> counts(taskCount);
+    for (auto& count : counts)
+      count = 0;
+
+    pool.run(taskCount, [&counts](unsigned i) { counts[i]++; });
+
+    for (unsigned i = 0; i < taskCount; i++)
+      ASSERT_EQ(1, counts[i]) << "Failed when batch=" << batch << ", i=" << i;
+  }
+}
+
+TEST (WorkerPoolTests, usesMultipleThreads)
+{
+  WorkerPool pool("Test pool", 2);
+
+  mutex threadIdsMutex;
+  set<thread::id> threadIds;
+  atomic<int> started(0);
+
+  pool.run(3, [&](unsigned i)
+  {
+    {
+      lock_guard<mutex> lock(threadIdsMutex);
+      threadIds.insert(this_thread::get_id());
+    }
+
+    // Wait for all three tasks to start, which requires three threads
+    started++;
+    while (started < 3)
+      this_thread::yield();
+  });
+
+  EXPECT_EQ(3, threadIds.size());
+  EXPECT_EQ(1, threadIds.count(this_thread::get_id()));
+}
+
+TEST (WorkerPoolTests, withoutThreads)
+{
+  WorkerPool pool("Test pool", 0);
+
+  EXPECT_EQ(1, pool.getConcurrency());
+
+  vector<thread::id> threadIds;
+  pool.run(5, [&threadIds](unsigned i) { threadIds.push_back(this_thread::get_id()); });
+
+  ASSERT_EQ(5, threadIds.size());
+  for (auto id : threadIds)
+    EXPECT_EQ(this_thread::get_id(), id);
+}
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <random>
+
+#include "../Clock/clock.hh"
+#include "../ImageLabelData/imagelabeldata.hh"
+#include "../ImagePassHandler/BlobDetectPass/blobdetectpass.hh"
+#include "../PixelLabel/RangePixelLabel/rangepixellabel.hh"
+#include "../SequentialTimer/sequentialtimer.hh"
+
+using namespace std;
+using namespace bold;
+using namespace Eigen;
+
+//
+// Measures blob detection on a busy 320x240 label image, scattered with
+// ellipses of two labels, and the share of that time spent accumulating
+// the second order moments from which covariance and orientation come.
+//
+
+int main(int argc, char **argv)
+{
+  int loopCount = 1000;
+  ushort const width = 320;
+  ushort const height = 240;
+
+  auto goalLabel = make_shared<RangePixelLabel>("Goal", LabelClass::GOAL, Colour::hsvRange());
+  auto ballLabel = make_shared<RangePixelLabel>("Ball", LabelClass::BALL, Colour::hsvRange());
+
+  // Scatter randomly sized and rotated ellipses
+  mt19937 rng(42);
+  uniform_real_distribution<double> unit(0, 1);
+  vector<uchar> image(width * height, 0);
+  for (int i = 0; i < 150; i++)
+  {
+    uchar label = unit(rng) < 0.5 ? (uchar)LabelClass::GOAL : (uchar)LabelClass::BALL;
+    double cx = unit(rng) * width, cy = unit(rng) * height;
+    double a = 2 + unit(rng) * 20, b = 2 + unit(rng) * 8;
+    double theta = unit(rng) * M_PI;
+    double c = cos(theta), s = sin(theta);
+    for (int y = max(0, int(cy - a)); y < min(int(height), int(cy + a + 1)); y++)
+    {
+      for (int x = max(0, int(cx - a)); x < min(int(width), int(cx + a + 1)); x++)
+      {
+        double u = ((x - cx) * c + (y - cy) * s) / a;
+        double v = (-(x - cx) * s + (y - cy) * c) / b;
+        if (u * u + v * v <= 1)
+          image[y * width + x] = label;
+      }
+    }
+  }
+
+  auto makeLabelData = [&]()
+  {
+    vector<uchar> labels(image);
+    vector<RowLabels> rows;
+    for (ushort y = 0; y < height; y++)
+      rows.emplace_back(labels.data() + y * width, labels.data() + (y + 1) * width, y, Matrix<uchar,2,1>(1, 1));
+    return ImageLabelData(move(labels), move(rows), width);
+  };
+
+  BlobDetectPass pass(width, height, { goalLabel, ballLabel });
+  SequentialTimer timer;
+
+  auto labelData = makeLabelData();
+  pass.process(labelData, timer);
+
+  auto t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+    pass.detectBlobs(timer);
+  double detectMillis = Clock::getMillisSince(t) / loopCount;
+
+  // Gather the runs, to time their second order sums in isolation
+  pass.setCollectRuns(goalLabel, true);
+  pass.setCollectRuns(ballLabel, true);
+  vector<Run> runs;
+  unsigned blobCount = 0;
+  for (auto const& pair : pass.detectBlobs(timer))
+  {
+    blobCount += pair.second.size();
+    for (Blob const& blob : pair.second)
+      runs.insert(runs.end(), blob.runs.begin(), blob.runs.end());
+  }
+
+  double sums[3] = { 0, 0, 0 };
+  t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+  {
+    for (Run const& run : runs)
+    {
+      sums[0] += run.sumXX();
+      sums[1] += run.sumX() * run.y;
+      sums[2] += (double)run.length() * run.y * run.y;
+    }
+  }
+  double momentMillis = Clock::getMillisSince(t) / loopCount;
+
+  // Time deriving shape measures from every blob
+  float shape = 0;
+  auto const& blobsPerLabel = pass.getDetectedBlobs();
+  t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+    for (auto const& pair : blobsPerLabel)
+      for (Blob const& blob : pair.second)
+        shape += blob.orientation() + blob.eccentricity();
+  double shapeMillis = Clock::getMillisSince(t) / loopCount;
+
+  cout << runs.size() << " runs in " << blobCount << " blobs" << endl
+       << "  detectBlobs:           " << detectMillis << " ms" << endl
+       << "  second order sums:     " << momentMillis << " ms (" << (100 * momentMillis / detectMillis) << "% of detectBlobs)" << endl
+       << "  orientation and eccentricity of all blobs: " << shapeMillis << " ms" << endl
+       << "  (checksum " << (sums[0] + sums[1] + sums[2] + shape) << ")" << endl;
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <random>
+
+#include "../BodyModel/DarwinBodyModel/darwinbodymodel.hh"
+#include "../Clock/clock.hh"
+#include "../Config/config.hh"
+#include "../StateObject/BodyState/bodystate.hh"
+#include "../StateObject/HardwareState/hardwarestate.hh"
+#include "../StateObject/TimingState/timingstate.hh"
+
+using namespace rapidjson;
+using namespace std;
+using namespace bold;
+
+//
+// Compares the size and encode time of the JSON and binary encodings of
+// state objects streamed at high rates.
+//
+
+void bench(string const& name, StateObject const& state, int loopCount)
+{
+  size_t jsonBytes = 0;
+  auto t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+  {
+    WebSocketBuffer buffer;
+    Writer<WebSocketBuffer> writer(buffer);
+    state.writeJson(writer);
+    jsonBytes = buffer.GetSize() - LWS_SEND_BUFFER_PRE_PADDING;
+  }
+  double jsonMicros = Clock::getMillisSince(t) * 1000 / loopCount;
+
+  size_t binaryBytes = 0;
+  t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+  {
+    WebSocketBuffer buffer;
+    state.writeBinary(buffer);
+    binaryBytes = buffer.GetSize() - LWS_SEND_BUFFER_PRE_PADDING;
+  }
+  double binaryMicros = Clock::getMillisSince(t) * 1000 / loopCount;
+
+  cout << name << endl
+       << "  json:   " << jsonBytes << " bytes " << jsonMicros << " us" << endl
+       << "  binary: " << binaryBytes << " bytes " << binaryMicros << " us" << endl
+       << "  ratio:  " << (double(jsonBytes) / binaryBytes) << "x smaller " << (jsonMicros / binaryMicros) << "x faster" << endl;
+}
+
+int main(int argc, char **argv)
+{
+  Config::initialise("configuration-metadata.json", "configuration-team.json");
+
+  int loopCount = 20000;
+
+  mt19937 rng(42);
+  uniform_real_distribution<double> dist(-1, 1);
+
+  // Hardware state with plausible, varied readings
+  auto cm730 = unique_ptr<CM730Snapshot>(new CM730Snapshot());
+  cm730->acc = Eigen::Vector3d(dist(rng), dist(rng), 1 + dist(rng));
+  cm730->gyro = Eigen::Vector3d(dist(rng), dist(rng), dist(rng)) * 100;
+  cm730->eyeColor = Eigen::Vector3d(0.1, 0.2, 0.3);
+  cm730->foreheadColor = Eigen::Vector3d(0.4, 0.5, 0.6);
+  cm730->isLed2On = true;
+  cm730->isLed3On = false;
+  cm730->isLed4On = true;
+  cm730->voltage = 12.3f;
+
+  vector<unique_ptr<MX28Snapshot const>> mx28s;
+  for (uchar id = (uchar)JointId::MIN; id <= (uchar)JointId::MAX; id++)
+  {
+    auto mx28 = unique_ptr<MX28Snapshot>(new MX28Snapshot(id));
+    mx28->presentPosition = dist(rng);
+    mx28->presentPositionValue = 2048 + (ushort)(dist(rng) * 1000);
+    mx28->presentSpeedRPM = dist(rng) * 50;
+    mx28->presentLoad = dist(rng);
+    mx28->presentVoltage = 12.1;
+    mx28->presentTemp = 40;
+    mx28s.push_back(move(mx28));
+  }
+
+  HardwareState hardwareState(move(cm730), move(mx28s), 123456, 654321, 1234);
+
+  auto bodyState = BodyState::zero(make_shared<DarwinBodyModel const>(), 1234);
+
+  auto eventTimings = make_shared<vector<EventTiming>>();
+  for (string event : { "Read Hardware", "Update Body", "Apply Motion", "Write Hardware", "Update Balance", "Update Walk" })
+    eventTimings->emplace_back((dist(rng) + 1) * 2, event);
+  MotionTimingState timingState(eventTimings, 1234, 125.0);
+
+  bench("HardwareState", hardwareState, loopCount);
+  bench("BodyState", *bodyState, loopCount);
+  bench("MotionTimingState", timingState, loopCount);
+
+  return 0;
+}
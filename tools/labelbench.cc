@@ -0,0 +1,84 @@
+#include <iostream>
+#include <random>
+
+#include <opencv2/core/core.hpp>
+
+#include "../Clock/clock.hh"
+#include "../ImageLabeller/imagelabeller.hh"
+
+using namespace cv;
+using namespace std;
+using namespace bold;
+
+//
+// Compares the vectorised pixel labelling kernel against the scalar
+// implementation, at several x-granularities, over a random 320x240 image.
+//
+
+int main(int argc, char **argv)
+{
+  int loopCount = 1000;
+  int const width = 320;
+  int const height = 240;
+
+  mt19937 rng(42);
+  uniform_int_distribution<int> dist(0, 255);
+
+  vector<uchar> lut(1 << 18);
+  for (auto& l : lut)
+    l = (uchar)dist(rng);
+
+  Mat image(height, width, CV_8UC3);
+  for (int i = 0; i < width * height * 3; i++)
+    image.data[i] = (uchar)dist(rng);
+
+  vector<uchar> scalarLabels(width * height);
+  vector<uchar> vectorLabels(width * height);
+
+#ifdef VECTORISE_LABELLING
+  cout << "Built with VECTORISE_LABELLING" << endl;
+#else
+  cout << "Built without VECTORISE_LABELLING (both paths are scalar)" << endl;
+#endif
+
+  for (uchar dx = 1; dx <= 4; dx++)
+  {
+    unsigned pixelCount = (width + dx - 1) / dx;
+
+    auto labelImage = [&](vector<uchar>& labels, bool vectorised)
+    {
+      uchar* out = labels.data();
+      for (int y = 0; y < height; y += dx)
+      {
+        if (vectorised)
+          ImageLabeller::labelRow(lut.data(), image.ptr<uchar>(y), out, pixelCount, dx);
+        else
+          ImageLabeller::labelRowScalar(lut.data(), image.ptr<uchar>(y), out, pixelCount, dx);
+        out += pixelCount;
+      }
+    };
+
+    auto t = Clock::getTimestamp();
+    for (int i = 0; i < loopCount; i++)
+      labelImage(scalarLabels, false);
+    double scalarMillis = Clock::getMillisSince(t) / loopCount;
+
+    t = Clock::getTimestamp();
+    for (int i = 0; i < loopCount; i++)
+      labelImage(vectorLabels, true);
+    double vectorMillis = Clock::getMillisSince(t) / loopCount;
+
+    bool identical = scalarLabels == vectorLabels;
+
+    cout << "dx=" << (int)dx
+         << " scalar: " << scalarMillis << " ms"
+         << " vectorised: " << vectorMillis << " ms"
+         << " speedup: " << (scalarMillis / vectorMillis) << "x"
+         << (identical ? " (identical)" : " (OUTPUT DIFFERS)") << endl;
+
+    if (!identical)
+      return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "../CameraModel/cameramodel.hh"
+#include "../Clock/clock.hh"
+#include "../Config/config.hh"
+#include "../IncrementalRegression/incrementalregression.hh"
+#include "../LineFinder/ScanningLineFinder/scanninglinefinder.hh"
+#include "../util/memory.hh"
+
+#include <Eigen/StdVector>
+
+using namespace std;
+using namespace bold;
+using namespace Eigen;
+
+//
+// Times ScanningLineFinder over line dot sets recorded by passtest (which
+// writes line-dots.txt), and over a synthetic field with a dense centre
+// circle. Each set is also run through the previous exhaustive search, to
+// check results are unchanged and show the difference in time. Exits with
+// a nonzero status if any results differ.
+//
+
+namespace
+{
+  // The previous search, which compares each dot against every regression
+  vector<LineSegment2i> findLineSegmentsExhaustively(vector<Vector2i> dots, double maxHeadDist, double worstFitAllowed, double minLength, double minCoverage)
+  {
+    sort(dots.begin(), dots.end(), [](Vector2i const& a, Vector2i const& b) { return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y()); });
+    dots.erase(unique(dots.begin(), dots.end()), dots.end());
+
+    vector<IncrementalRegression,aligned_allocator<IncrementalRegression>> regressions;
+    for (Vector2i const& dot : dots)
+    {
+      Vector2f point = dot.cast<float>();
+      auto bestFittingRegression = regressions.end();
+      float bestFit = worstFitAllowed + 1;
+
+      for (auto iter = begin(regressions); iter != end(regressions); ++iter)
+      {
+        if (!((iter->head() - point).norm() <= maxHeadDist))
+          continue;
+        auto fit = iter->fit(point);
+        if (fit > worstFitAllowed || fit > bestFit)
+          continue;
+        bestFit = fit;
+        bestFittingRegression = iter;
+      }
+
+      if (bestFittingRegression != regressions.end())
+      {
+        bestFittingRegression->addPoint(point);
+        bestFittingRegression->solve();
+      }
+      else
+      {
+        IncrementalRegression newRegression;
+        newRegression.setSqError(100.0);
+        newRegression.addPoint(point);
+        regressions.push_back(newRegression);
+      }
+    }
+
+    vector<LineSegment2i> lineSegments;
+    for (auto& regression : regressions)
+    {
+      if (regression.getNPoints() < 2 || regression.isVertical())
+        continue;
+      auto lineSegment = regression.getLineSegment();
+      float length = lineSegment.length();
+      if (length < minLength || float(regression.getNPoints()) / length < minCoverage)
+        continue;
+      lineSegments.emplace_back(lineSegment.cast<int>());
+    }
+    return lineSegments;
+  }
+
+  vector<Vector2i> readDots(string const& fileName)
+  {
+    vector<Vector2i> dots;
+    ifstream in(fileName);
+    int x, y;
+    while (in >> x >> y)
+      dots.emplace_back(x, y);
+    return dots;
+  }
+
+  // Touchlines, a halfway line and a centre circle, seen from above, with noise
+  vector<Vector2i> makeFieldDots(ushort width, ushort height)
+  {
+    mt19937 rng(42);
+    normal_distribution<double> noise(0, 0.7);
+    vector<Vector2i> dots;
+    auto add = [&](double x, double y)
+    {
+      int ix = int(round(x + noise(rng)));
+      int iy = int(round(y + noise(rng)));
+      if (ix >= 0 && ix < width && iy >= 0 && iy < height)
+        dots.emplace_back(ix, iy);
+    };
+
+    for (int x = 0; x < width; x += 2)
+    {
+      add(x, height * 0.1);
+      add(x, height * 0.9);
+    }
+    for (int y = 0; y < height; y += 2)
+      add(width / 2.0, y);
+    for (double radius : { height * 0.3, height * 0.3 + 3 })
+      for (double a = 0; a < 2 * M_PI; a += 0.5 / radius)
+        add(width / 2.0 + radius * cos(a), height / 2.0 + radius * sin(a));
+    return dots;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Config::initialise("configuration-metadata.json", "configuration.json");
+
+  int loopCount = 200;
+
+  auto cameraModel = allocate_aligned_shared<CameraModel>();
+  ScanningLineFinder lineFinder(cameraModel);
+
+  double maxHeadDist = Config::getValue<double>("vision.line-detection.scanning.max-head-dist");
+  double maxRMSFactor = Config::getValue<double>("vision.line-detection.scanning.max-rms-factor");
+  double minLength = Config::getValue<double>("vision.line-detection.scanning.min-length");
+  double minCoverage = Config::getValue<double>("vision.line-detection.scanning.min-coverage");
+
+  vector<pair<string,vector<Vector2i>>> dotSets;
+  dotSets.emplace_back("synthetic field", makeFieldDots(cameraModel->imageWidth(), cameraModel->imageHeight()));
+  for (int i = 1; i < argc; i++)
+    dotSets.emplace_back(argv[i], readDots(argv[i]));
+
+  bool resultsDiffer = false;
+
+  for (auto& dotSet : dotSets)
+  {
+    auto& dots = dotSet.second;
+
+    auto t = Clock::getTimestamp();
+    vector<LineSegment2i> lines;
+    for (int i = 0; i < loopCount; i++)
+      lines = lineFinder.findLineSegments(dots);
+    double millis = Clock::getMillisSince(t) / loopCount;
+
+    t = Clock::getTimestamp();
+    vector<LineSegment2i> expectedLines;
+    for (int i = 0; i < loopCount; i++)
+      expectedLines = findLineSegmentsExhaustively(dots, maxHeadDist, maxRMSFactor, minLength, minCoverage);
+    double exhaustiveMillis = Clock::getMillisSince(t) / loopCount;
+
+    cout << dotSet.first << ": " << dots.size() << " dots, " << lines.size() << " lines" << endl
+         << "  ScanningLineFinder: " << millis << " ms" << endl
+         << "  exhaustive search:  " << exhaustiveMillis << " ms" << endl;
+
+    if (lines != expectedLines)
+    {
+      cout << "  RESULTS DIFFER from the exhaustive search" << endl;
+      resultsDiffer = true;
+    }
+  }
+
+  return resultsDiffer ? 1 : 0;
+}
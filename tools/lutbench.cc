@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cstring>
+
+#include "../Clock/clock.hh"
+#include "../Colour/colour.hh"
+#include "../LUTBuilder/lutbuilder.hh"
+#include "../PixelLabel/RangePixelLabel/rangepixellabel.hh"
+#include "../util/workerpool.hh"
+
+using namespace std;
+using namespace bold;
+
+//
+// Compares building an 18-bit YCbCr pixel label LUT by converting every cell
+// from YCbCr to HSV, against looking cells up in the precomputed HSV table.
+//
+
+int main(int argc, char **argv)
+{
+  int loopCount = 20;
+
+  vector<shared_ptr<PixelLabel>> labels = {
+    make_shared<RangePixelLabel>("Goal",    LabelClass::GOAL,    Colour::hsvRange(30, 60, 158, 236, 124, 222)),
+    make_shared<RangePixelLabel>("Ball",    LabelClass::BALL,    Colour::hsvRange(248, 30, 72, 255, 12, 255)),
+    make_shared<RangePixelLabel>("Field",   LabelClass::FIELD,   Colour::hsvRange(72, 118, 166, 236, 52, 192)),
+    make_shared<RangePixelLabel>("Line",    LabelClass::LINE,    Colour::hsvRange(0, 255, 0, 167, 161, 255)),
+    make_shared<RangePixelLabel>("Cyan",    LabelClass::CYAN,    Colour::hsvRange(125, 155, 100, 255, 40, 100)),
+    make_shared<RangePixelLabel>("Magenta", LabelClass::MAGENTA, Colour::hsvRange(235, 0, 100, 150, 40, 100)),
+    make_shared<RangePixelLabel>("Border",  LabelClass::BORDER,  Colour::hsvRange(0, 255, 0, 255, 0, 30))
+  };
+
+  // Before: convert each cell from YCbCr via BGR to HSV
+  vector<uchar> before(1 << 18);
+  auto t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+  {
+    uchar* p = before.data();
+    for (int y = 0; y < 64; ++y)
+      for (int cb = 0; cb < 64; ++cb)
+        for (int cr = 0; cr < 64; ++cr)
+          *(p++) = LUTBuilder::labelPixel(labels, Colour::YCbCr(y<<2, cb<<2, cr<<2).toBgrInt());
+  }
+  double beforeMillis = Clock::getMillisSince(t) / loopCount;
+
+  // The HSV table is computed once per process
+  t = Clock::getTimestamp();
+  Colour::yCbCr2hsv18Table();
+  double tableMillis = Clock::getMillisSince(t);
+
+  // After: look cells up in the HSV table
+  shared_ptr<LookUpTable> after;
+  t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+    after = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, 6, labels);
+  double afterMillis = Clock::getMillisSince(t) / loopCount;
+
+  // After, spread across four threads
+  WorkerPool workerPool("LUT bench", 3);
+  auto parallel = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, 6, labels, &workerPool);
+  t = Clock::getTimestamp();
+  for (int i = 0; i < loopCount; i++)
+    parallel = LUTBuilder::buildLookUpTable(LUTColourSpace::YCbCr, 6, labels, &workerPool);
+  double parallelMillis = Clock::getMillisSince(t) / loopCount;
+
+  bool identical = memcmp(before.data(), after->data(), 1 << 18) == 0
+                && memcmp(before.data(), parallel->data(), 1 << 18) == 0;
+
+  cout << "HSV table (once): " << tableMillis << " ms" << endl
+       << "Converting each cell: " << beforeMillis << " ms" << endl
+       << "HSV table lookup: " << afterMillis << " ms"
+       << " speedup: " << (beforeMillis / afterMillis) << "x" << endl
+       << "HSV table lookup, 4 threads: " << parallelMillis << " ms"
+       << " speedup: " << (beforeMillis / parallelMillis) << "x" << endl
+       << (identical ? "LUTs identical" : "LUTS DIFFER") << endl;
+
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <random>
+
+#include <opencv2/core/core.hpp>
+
+#include "../Clock/clock.hh"
+#include "../ImageLabelData/imagelabeldata.hh"
+#include "../ImageLabeller/imagelabeller.hh"
+#include "../ImageSampleMap/imagesamplemap.hh"
+#include "../SequentialTimer/sequentialtimer.hh"
+#include "../util/workerpool.hh"
+
+using namespace cv;
+using namespace std;
+using namespace bold;
+using namespace Eigen;
+
+//
+// Measures row-band parallel labelling of a random 320x240 image with 1, 2
+// and 4 threads, for several sample map granularities.
+//
+
+int main(int argc, char **argv)
+{
+  int loopCount = 1000;
+  int const width = 320;
+  int const height = 240;
+
+  mt19937 rng(42);
+  uniform_int_distribution<int> dist(0, 255);
+
+  auto lut = make_shared<LookUpTable>(LUTColourSpace::YCbCr, 6);
+  for (size_t i = 0; i < lut->getSize(); i++)
+    lut->data()[i] = (uchar)dist(rng);
+
+  Mat image(height, width, CV_8UC3);
+  for (int i = 0; i < width * height * 3; i++)
+    image.data[i] = (uchar)dist(rng);
+
+  vector<pair<string,function<Matrix<uchar,2,1>(ushort)>>> granularities = {
+    { "All",      [](ushort y) { return Matrix<uchar,2,1>(1, 1); } },
+    { "Half",     [](ushort y) { return Matrix<uchar,2,1>(2, 2); } },
+    { "Gradient", [height](ushort y) { uchar g = max(1, min(4, (height - y) / 40)); return Matrix<uchar,2,1>(g, g); } }
+  };
+
+  auto flatten = [](ImageLabelData const& labelData)
+  {
+    vector<uchar> labels;
+    for (auto const& row : labelData)
+      labels.insert(labels.end(), row.begin(), row.end());
+    return labels;
+  };
+
+  for (auto const& granularity : granularities)
+  {
+    ImageSampleMap sampleMap(granularity.second, width, height);
+
+    double serialMillis = 0;
+    vector<uchar> serialLabels;
+
+    for (unsigned threadCount : { 1u, 2u, 4u })
+    {
+      ImageLabeller labeller(lut, nullptr, make_shared<WorkerPool>("Label bench", threadCount - 1));
+      labeller.setParallel(true);
+
+      SequentialTimer timer;
+
+      // Warm up, which also starts the pool's threads
+      auto labelData = labeller.label(image, sampleMap, false, timer);
+
+      auto t = Clock::getTimestamp();
+      for (int i = 0; i < loopCount; i++)
+      {
+        vector<uchar> labels;
+        vector<RowLabels> rows;
+        labelData.recycle(labels, rows);
+        labelData = labeller.label(image, sampleMap, false, timer, move(labels), move(rows));
+      }
+      double millis = Clock::getMillisSince(t) / loopCount;
+
+      auto labels = flatten(labelData);
+      if (threadCount == 1)
+      {
+        serialMillis = millis;
+        serialLabels = labels;
+      }
+
+      bool identical = labels == serialLabels;
+
+      cout << granularity.first
+           << " threads=" << threadCount
+           << " " << millis << " ms"
+           << " speedup: " << (serialMillis / millis) << "x"
+           << (identical ? " (identical)" : " (OUTPUT DIFFERS)") << endl;
+
+      if (!identical)
+        return 1;
+    }
+  }
+
+  return 0;
+}
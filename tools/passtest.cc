@@ -1,3 +1,4 @@
+#include <fstream>
 #include <iostream>
 #include <time.h>
 #include <sys/time.h>
@@ -29,6 +30,7 @@
 #include "../PixelLabel/HistogramPixelLabel/histogrampixellabel.hh"
 #include "../SequentialTimer/sequentialtimer.hh"
 #include "../State/state.hh"
+#include "../StateObject/ImagePassScheduleState/imagepassschedulestate.hh"
 #include "../StateObject/LabelCountState/labelcountstate.hh"
 #include "../util/meta.hh"
 
@@ -148,14 +150,16 @@ int main(int argc, char **argv)
 
   vector<shared_ptr<PixelLabel>> labels = { goalLabel, ballLabel, fieldLabel, lineLabel, cyanLabel, magentaLabel };
 
+  State::registerStateType<ImagePassScheduleState>("ImagePassSchedule");
   State::registerStateType<LabelCountState>("LabelCount");
 
   // Resources for labelling
   // TODO: this will crash
-  auto imageLabeller = new ImageLabeller(LUTBuilder::buildLookUpTableBGR18(labels), 0);
+  auto imageLabeller = new ImageLabeller(LUTBuilder::buildLookUpTable(LUTColourSpace::BGR, 6, labels), 0);
 
   const vector<shared_ptr<PixelLabel>> blobPixelLabels = { ballLabel, goalLabel, cyanLabel, magentaLabel };
   auto blobDetectPass = make_shared<BlobDetectPass>(imageWidth, imageHeight, blobPixelLabels);
+  blobDetectPass->setCollectRuns(goalLabel, true);
 
   // Resources for finding line dots
   auto lineDotPass = make_shared<LineDotPass>(imageWidth, fieldLabel, lineLabel);
@@ -299,6 +303,11 @@ int main(int argc, char **argv)
       lineDotImageColour.at<Colour::bgr>(lineDot.y(), lineDot.x()) = red;
     }
     imwrite("line-dots.png", lineDotImageColour);
+
+    // Record the dots, for replaying through linefinderbench
+    ofstream lineDotsFile("line-dots.txt");
+    for (Vector2i const& lineDot : lineDotPass->lineDots)
+      lineDotsFile << lineDot.x() << " " << lineDot.y() << "\n";
 //     imwrite("line-dots-gray.bmp", lineDotImageGray);
   }
 
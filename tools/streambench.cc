@@ -0,0 +1,75 @@
+#include <iostream>
+#include <queue>
+
+#include "../Clock/clock.hh"
+#include "../DataStreamer/datastreamer.hh"
+#include "../StateObject/TimingState/timingstate.hh"
+
+using namespace rapidjson;
+using namespace std;
+using namespace bold;
+
+//
+// Compares encoding a state object once per connected session against
+// encoding it once and sharing the buffer between sessions, for several
+// numbers of simulated sessions.
+//
+
+int main(int argc, char **argv)
+{
+  int loopCount = 20000;
+
+  // A state object of similar encoded size to those streamed each motion cycle
+  auto eventTimings = make_shared<vector<EventTiming>>();
+  for (int i = 0; i < 40; i++)
+    eventTimings->emplace_back(0.01 * i, "Event " + to_string(i));
+  MotionTimingState state(eventTimings, 1234, 125.0);
+
+  for (unsigned sessionCount : { 1u, 4u, 16u })
+  {
+    // Each session's queue is drained after every update, as if sent
+    vector<queue<WebSocketBuffer>> copiedQueues(sessionCount);
+    vector<queue<shared_ptr<WebSocketBuffer>>> sharedQueues(sessionCount);
+
+    size_t copiedBytes = 0;
+    auto t = Clock::getTimestamp();
+    for (int i = 0; i < loopCount; i++)
+    {
+      for (auto& queue : copiedQueues)
+      {
+        WebSocketBuffer buffer;
+        Writer<WebSocketBuffer> writer(buffer);
+        state.writeJson(writer);
+        buffer.Push(LWS_SEND_BUFFER_POST_PADDING);
+        copiedBytes += buffer.GetSize();
+        queue.emplace(move(buffer));
+      }
+      for (auto& queue : copiedQueues)
+        queue.pop();
+    }
+    double copiedMicros = Clock::getMillisSince(t) * 1000 / loopCount;
+
+    size_t sharedBytes = 0;
+    t = Clock::getTimestamp();
+    for (int i = 0; i < loopCount; i++)
+    {
+      WebSocketBuffer buffer;
+      Writer<WebSocketBuffer> writer(buffer);
+      state.writeJson(writer);
+      auto shared = JsonSession::share(move(buffer));
+      sharedBytes += shared->GetSize();
+      for (auto& queue : sharedQueues)
+        queue.push(shared);
+      for (auto& queue : sharedQueues)
+        queue.pop();
+    }
+    double sharedMicros = Clock::getMillisSince(t) * 1000 / loopCount;
+
+    cout << sessionCount << " session" << (sessionCount == 1 ? " " : "s")
+         << " per-session: " << copiedMicros << " us " << (copiedBytes / loopCount) << " bytes"
+         << " shared: " << sharedMicros << " us " << (sharedBytes / loopCount) << " bytes"
+         << " speedup: " << (copiedMicros / sharedMicros) << "x" << endl;
+  }
+
+  return 0;
+}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 
 // TODO endianness as a type param? eg: BufferWriter<LittleEndian>
 
-// TODO write N bytes
 // TODO write string of N bytes (encoding?)
 // TODO test length and remaining
 
+// Values are written in host byte order. Wire formats built on this class are little endian.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "BufferWriter assumes a little endian host");
+
 namespace bold
 {
   class BufferWriter
@@ -52,6 +55,20 @@ namespace bold
       d_ptr += sizeof(uint32_t);
     }
 
+    void writeFloat32(float val)
+    {
+      static_assert(sizeof(float) == sizeof(uint32_t), "float must be 32 bits");
+      uint32_t bits;
+      std::memcpy(&bits, &val, sizeof(bits));
+      writeInt32u(bits);
+    }
+
+    void writeBytes(char const* bytes, size_t count)
+    {
+      std::memcpy(d_ptr, bytes, count);
+      d_ptr += count;
+    }
+
     size_t pos()
     {
       return d_ptr - d_start;
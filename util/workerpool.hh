@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+
+#include "assert.hh"
+
+namespace bold
+{
+  /** A fixed set of persistent threads which execute batches of indexed tasks.
+   *
+   * Threads are created once, the first time a batch is run, and wait
+   * between batches. The thread calling run also executes tasks, so a pool
+   * with N threads runs up to N + 1 tasks at once.
+   *
+   * run must only be called from one thread at a time.
+   */
+  class WorkerPool
+  {
+  public:
+    WorkerPool(std::string threadName, unsigned threadCount)
+    : d_threadName(threadName),
+      d_threadCount(threadCount),
+      d_task(nullptr),
+      d_taskCount(0),
+      d_nextTask(0),
+      d_pendingThreadCount(0),
+      d_generation(0),
+      d_stop(false)
+    {}
+
+    ~WorkerPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_stop = true;
+      }
+      d_startCondition.notify_all();
+
+      for (auto& thread : d_threads)
+        thread.join();
+    }
+
+    /** The number of threads which may execute tasks, including the caller of run. */
+    unsigned getConcurrency() const { return d_threadCount + 1; }
+
+    /** Calls task(i) for each i in [0, taskCount), spreading calls across the
+     * pool's threads and the calling thread. Returns once all calls have completed.
+     */
+    void run(unsigned taskCount, std::function<void(unsigned)> const& task)
+    {
+      if (taskCount == 0)
+        return;
+
+      if (d_threads.size() != d_threadCount)
+      {
+        for (unsigned i = 0; i < d_threadCount; i++)
+          d_threads.emplace_back(&WorkerPool::work, this);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        ASSERT(d_task == nullptr && "WorkerPool::run is not reentrant");
+        d_task = &task;
+        d_taskCount = taskCount;
+        d_nextTask = 0;
+        d_pendingThreadCount = static_cast<unsigned>(d_threads.size());
+        d_generation++;
+      }
+      d_startCondition.notify_all();
+
+      executeTasks();
+
+      std::unique_lock<std::mutex> lock(d_mutex);
+      d_doneCondition.wait(lock, [this] { return d_pendingThreadCount == 0; });
+      d_task = nullptr;
+    }
+
+  private:
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    void work()
+    {
+      pthread_setname_np(pthread_self(), d_threadName.c_str());
+
+      unsigned long generation = 0;
+
+      while (true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(d_mutex);
+          d_startCondition.wait(lock, [this,generation] { return d_stop || d_generation != generation; });
+
+          if (d_stop)
+            return;
+
+          generation = d_generation;
+        }
+
+        executeTasks();
+
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (--d_pendingThreadCount == 0)
+          d_doneCondition.notify_one();
+      }
+    }
+
+    void executeTasks()
+    {
+      unsigned index;
+      while ((index = d_nextTask++) < d_taskCount)
+        (*d_task)(index);
+    }
+
+    std::string d_threadName;
+    unsigned d_threadCount;
+    std::vector<std::thread> d_threads;
+    std::mutex d_mutex;
+    std::condition_variable d_startCondition;
+    std::condition_variable d_doneCondition;
+    std::function<void(unsigned)> const* d_task;
+    unsigned d_taskCount;
+    std::atomic<unsigned> d_nextTask;
+    unsigned d_pendingThreadCount;
+    unsigned long d_generation;
+    bool d_stop;
+  };
+}
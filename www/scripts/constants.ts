@@ -442,6 +442,7 @@ export var protocols = {
     drawingState: 'Drawing',
     gameState: 'Game',
     hardwareState: 'Hardware',
+    imagePassScheduleState: 'ImagePassSchedule',
     labelCountState: 'LabelCount',
     labelTeacherState: 'LabelTeacher',
     ledState: 'LED',
@@ -473,6 +474,7 @@ export var allStateProtocols = [
     protocols.drawingState,
     protocols.gameState,
     protocols.hardwareState,
+    protocols.imagePassScheduleState,
     protocols.labelCountState,
     protocols.labelTeacherState,
     protocols.ledState,
@@ -491,6 +493,22 @@ export var allStateProtocols = [
     protocols.worldFrameState
 ];
 
+/** High rate state protocols for which the client asks for binary messages rather than JSON. */
+export var binaryStateProtocols = [
+    protocols.bodyState,
+    protocols.hardwareState,
+    protocols.motionTimingState,
+    protocols.thinkTimingState
+];
+
+/** State protocols of large objects that change little between updates, for which the client asks for deltas. */
+export var deltaStateProtocols = [
+    protocols.optionTreeState,
+    protocols.particleState,
+    protocols.stationaryMapState,
+    protocols.worldFrameState
+];
+
 var getQueryStringParameterByName = name =>
 {
     name = name.replace(/[\[]/, "\\\[").replace(/[\]]/, "\\\]");
@@ -5,6 +5,8 @@
 /// <reference path="../libs/jquery.d.ts" />
 
 import constants = require('constants');
+import BinaryStateDecoder = require('util/BinaryStateDecoder');
+import DeltaStateDecoder = require('util/DeltaStateDecoder');
 
 declare class MozWebSocket
 {
@@ -33,6 +35,10 @@ class Protocol
     public clients: IClient[] = [];
     public socket: WebSocket;
     private indicator: HTMLDivElement;
+    private isBinary: boolean;
+    private binaryDecoder: BinaryStateDecoder;
+    private isDelta: boolean;
+    private deltaDecoder: DeltaStateDecoder;
 
     constructor(public protocolName: string)
     {
@@ -45,6 +51,9 @@ class Protocol
 
         elementContainer.appendChild(this.indicator);
 
+        this.isBinary = constants.binaryStateProtocols.indexOf(protocolName) !== -1;
+        this.isDelta = constants.deltaStateProtocols.indexOf(protocolName) !== -1;
+
         protocols.push(this);
     }
 
@@ -73,10 +82,30 @@ class Protocol
             ? <WebSocket>new MozWebSocket(constants.webSocketUrl, this.protocolName)
             : new WebSocket(constants.webSocketUrl, this.protocolName);
 
+        // Each connection begins in JSON, until the client asks otherwise
+        if (this.isBinary)
+        {
+            this.socket.binaryType = 'arraybuffer';
+            this.binaryDecoder = new BinaryStateDecoder(
+                this.protocolName === constants.protocols.motionTimingState || this.protocolName === constants.protocols.thinkTimingState
+                    ? BinaryStateDecoder.adaptTiming
+                    : undefined);
+        }
+
+        if (this.isDelta)
+        {
+            var socket = this.socket;
+            this.deltaDecoder = new DeltaStateDecoder(id => socket.send(JSON.stringify({ack: id})));
+        }
+
         // Wire up the indicator
         this.indicator.className = 'connection-indicator connecting';
         this.socket.onopen = () => {
             this.indicator.className = 'connection-indicator connected';
+            if (this.isBinary)
+                this.socket.send(JSON.stringify({encoding: 'binary'}));
+            if (this.isDelta)
+                this.socket.send(JSON.stringify({delta: true}));
             raiseConnectionChanged();
         };
         this.socket.onclose = () => {
@@ -137,11 +166,23 @@ class Protocol
         return this.socket && this.socket.readyState == WebSocket.OPEN;
     }
 
+    private parse(data: any): any
+    {
+        if (this.binaryDecoder)
+            return this.binaryDecoder.decode(data);
+
+        if (this.deltaDecoder)
+            return this.deltaDecoder.decode(JSON.parse(data));
+
+        return JSON.parse(data);
+    }
+
     private proxyEventToClients(eventName: string): (arg:any)=>void
     {
         return msg =>
         {
             var parsed: any;
+            var isParsed = false;
             for (var i = 0; i < this.clients.length; i++) {
                 var client = this.clients[i];
                 var callback = client[eventName];
@@ -150,10 +191,13 @@ class Protocol
                 console.assert(typeof(callback) === 'function');
                 try {
                     if (client.parseJson) {
-                        if (!parsed && msg.data) {
-                            parsed = JSON.parse(msg.data);
+                        if (!isParsed && msg.data) {
+                            parsed = this.parse(msg.data);
+                            isParsed = true;
                         }
-                        callback(parsed);
+                        // Messages such as schemas hold no state for clients
+                        if (parsed !== undefined)
+                            callback(parsed);
                     } else {
                         // TODO use arguments instead of 'msg'?
                         callback(msg);
@@ -172,6 +172,14 @@ export interface Hardware
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+export interface ImagePassSchedule
+{
+    /** Handlers in each stage depend only upon handlers in earlier stages. */
+    stages: {id:string; dependencies:string[]}[][];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 export interface LabelCount
 {
     labels: {name:string; id:number; count:number}[];
@@ -561,6 +569,11 @@ export interface Timing
     timings: {[key:string]:number};
 }
 
+export interface ThinkTiming extends Timing
+{
+    framePoolAllocations: number;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 export interface WorldFrame
@@ -0,0 +1,146 @@
+/**
+ * Decodes state objects sent in their compact binary encoding.
+ *
+ * After the client sends {"encoding":"binary"}, the server sends a schema as
+ * text, then each state object as a binary message: a uint8 encoding version
+ * and uint16 payload size, then packed little endian fields in schema order.
+ * States without a binary encoding continue to arrive as JSON.
+ */
+
+interface ISchemaField
+{
+    name: string;
+    /** u8, u16, i16, u32, f32, bool or str8. Absent for groups. */
+    type?: string;
+    /** The number of values, or for groups, repetitions. Defaults to one. */
+    count?: number;
+    /** For groups whose repetitions are counted in the message, the type of that count. */
+    'count-type'?: string;
+    /** For groups, the fields repeated within each. */
+    fields?: ISchemaField[];
+}
+
+interface ISchema
+{
+    version: number;
+    fields: ISchemaField[];
+}
+
+var headerSize = 3;
+
+class BinaryStateDecoder
+{
+    private schema: ISchema;
+    private view: DataView;
+    private pos: number;
+
+    /**
+     * @param adapt converts a decoded state to the shape of the same state's JSON, where they differ
+     */
+    constructor(private adapt?: (state: any)=>any)
+    {}
+
+    /** Returns the state held in a message's data, or undefined if the message holds no state. */
+    public decode(data: any): any
+    {
+        if (typeof(data) === 'string')
+        {
+            var message = JSON.parse(data);
+            if (message.schema)
+            {
+                this.schema = message.schema;
+                return undefined;
+            }
+            return message;
+        }
+
+        if (!this.schema)
+            throw new Error("Binary message received before its schema");
+
+        this.view = new DataView(data);
+        this.pos = 0;
+
+        var version = this.readValue('u8');
+        var payloadSize = this.readValue('u16');
+
+        if (version !== this.schema.version)
+            throw new Error("Binary message has version " + version + " but schema has version " + this.schema.version);
+
+        var state = this.readFields(this.schema.fields);
+
+        console.assert(this.pos === headerSize + payloadSize, "Binary message payload size mismatch");
+
+        return this.adapt ? this.adapt(state) : state;
+    }
+
+    private readFields(fields: ISchemaField[]): any
+    {
+        var obj = {};
+
+        for (var i = 0; i < fields.length; i++)
+        {
+            var field = fields[i];
+
+            if (field.fields)
+            {
+                var count = field['count-type'] ? this.readValue(field['count-type']) : field.count;
+                var items = [];
+                for (var j = 0; j < count; j++)
+                    items.push(this.readFields(field.fields));
+                obj[field.name] = items;
+            }
+            else if (typeof(field.count) === 'number' && field.count !== 1)
+            {
+                var values = [];
+                for (var k = 0; k < field.count; k++)
+                    values.push(this.readValue(field.type));
+                obj[field.name] = values;
+            }
+            else
+            {
+                obj[field.name] = this.readValue(field.type);
+            }
+        }
+
+        return obj;
+    }
+
+    private readValue(type: string): any
+    {
+        var view = this.view,
+            pos = this.pos;
+
+        switch (type)
+        {
+            case 'u8':   this.pos += 1; return view.getUint8(pos);
+            case 'bool': this.pos += 1; return view.getUint8(pos) !== 0;
+            case 'u16':  this.pos += 2; return view.getUint16(pos, true);
+            case 'i16':  this.pos += 2; return view.getInt16(pos, true);
+            case 'u32':  this.pos += 4; return view.getUint32(pos, true);
+            case 'f32':  this.pos += 4; return view.getFloat32(pos, true);
+            case 'str8':
+            {
+                var length = view.getUint8(pos);
+                var str = '';
+                for (var i = 0; i < length; i++)
+                    str += String.fromCharCode(view.getUint8(pos + 1 + i));
+                this.pos += 1 + length;
+                return str;
+            }
+            default:
+                throw new Error("Unsupported binary field type: " + type);
+        }
+    }
+
+    /** Adapts timing states, whose binary encoding lists timings in a group rather than an object keyed by event. */
+    public static adaptTiming(state: any): any
+    {
+        var timings = {};
+        for (var i = 0; i < state.timings.length; i++)
+            timings[state.timings[i].event] = state.timings[i].ms;
+        state.timings = timings;
+        return state;
+    }
+}
+
+export = BinaryStateDecoder;
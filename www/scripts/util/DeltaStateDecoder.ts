@@ -0,0 +1,88 @@
+/**
+ * Reconstructs state objects sent as deltas against keyframes.
+ *
+ * After the client sends {"delta":true}, the server sends states as either
+ * {"keyframe":id,"state":{...}}, which the client acknowledges with
+ * {"ack":id}, or {"base":id,"delta":{...}}, holding those members that differ
+ * from an acknowledged keyframe.
+ */
+
+/** Keyframes the server may still send deltas against. Matches the number it keeps awaiting acknowledgement. */
+var maxKeyframeCount = 8;
+
+class DeltaStateDecoder
+{
+    private keyframeById: {[id: number]: any} = {};
+    private keyframeIds: number[] = [];
+
+    /**
+     * @param acknowledge sends {"ack":id} to the server
+     */
+    constructor(private acknowledge: (id: number)=>void)
+    {}
+
+    /** Returns the state held in a parsed message, or undefined if it cannot be reconstructed. */
+    public decode(message: any): any
+    {
+        if (typeof(message.keyframe) === 'number')
+        {
+            var id: number = message.keyframe;
+
+            // The server sends a keyframe again while awaiting its acknowledgement
+            if (!this.keyframeById.hasOwnProperty(String(id)))
+            {
+                this.keyframeById[id] = message.state;
+                this.keyframeIds.push(id);
+                if (this.keyframeIds.length > maxKeyframeCount)
+                    delete this.keyframeById[this.keyframeIds.shift()];
+                this.acknowledge(id);
+            }
+
+            return message.state;
+        }
+
+        if (typeof(message.base) === 'number')
+        {
+            var base = this.keyframeById[message.base];
+            if (base === undefined)
+            {
+                console.warn("Delta received against unknown keyframe", message.base);
+                return undefined;
+            }
+            return DeltaStateDecoder.merge(base, message.delta);
+        }
+
+        return message;
+    }
+
+    /**
+     * Applies a delta to a base object without modifying it. Where both values
+     * are objects, the delta is applied recursively; otherwise the delta's value
+     * replaces the base's.
+     */
+    public static merge(base: any, delta: any): any
+    {
+        if (!DeltaStateDecoder.isObject(base) || !DeltaStateDecoder.isObject(delta))
+            return delta;
+
+        var merged = {};
+        for (var key in base)
+        {
+            if (base.hasOwnProperty(key))
+                merged[key] = base[key];
+        }
+        for (var key in delta)
+        {
+            if (delta.hasOwnProperty(key))
+                merged[key] = DeltaStateDecoder.merge(base[key], delta[key]);
+        }
+        return merged;
+    }
+
+    private static isObject(value: any): boolean
+    {
+        return value !== null && typeof(value) === 'object' && !Array.isArray(value);
+    }
+}
+
+export = DeltaStateDecoder;
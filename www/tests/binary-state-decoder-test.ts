@@ -0,0 +1,67 @@
+/// <reference path="../libs/jasmine.d.ts" />
+
+import BinaryStateDecoder = require('scripts/app/util/BinaryStateDecoder');
+
+var schema = {
+    version: 1,
+    fields: [
+        { name: 'cycle', type: 'u32' },
+        { name: 'errors', type: 'i16', count: 2 },
+        { name: 'led', type: 'bool' },
+        { name: 'timings', 'count-type': 'u16', fields: [
+            { name: 'event', type: 'str8' },
+            { name: 'ms', type: 'f32' }
+        ]}
+    ]
+};
+
+function encode(): ArrayBuffer
+{
+    var buffer = new ArrayBuffer(3 + 4 + 4 + 1 + 2 + 1 + 2 + 4),
+        view = new DataView(buffer);
+
+    view.setUint8(0, 1);
+    view.setUint16(1, buffer.byteLength - 3, true);
+    view.setUint32(3, 1234, true);
+    view.setInt16(7, -5, true);
+    view.setInt16(9, 7, true);
+    view.setUint8(11, 1);
+    view.setUint16(12, 1, true);
+    view.setUint8(14, 2);
+    view.setUint8(15, 'a'.charCodeAt(0));
+    view.setUint8(16, 'b'.charCodeAt(0));
+    view.setFloat32(17, 2.5, true);
+
+    return buffer;
+}
+
+describe("BinaryStateDecoder", () =>
+{
+    it("consumes the schema, then decodes fields in schema order", () =>
+    {
+        var decoder = new BinaryStateDecoder();
+
+        expect(decoder.decode(JSON.stringify({schema: schema}))).toBeUndefined();
+
+        expect(decoder.decode(encode())).toEqual({
+            cycle: 1234,
+            errors: [-5, 7],
+            led: true,
+            timings: [{event: 'ab', ms: 2.5}]
+        });
+    });
+
+    it("adapts timings to an object keyed by event", () =>
+    {
+        var decoder = new BinaryStateDecoder(BinaryStateDecoder.adaptTiming);
+
+        decoder.decode(JSON.stringify({schema: schema}));
+
+        expect(decoder.decode(encode()).timings).toEqual({ab: 2.5});
+    });
+
+    it("passes JSON states through", () =>
+    {
+        expect(new BinaryStateDecoder().decode('{"cycle":1}')).toEqual({cycle: 1});
+    });
+});
@@ -0,0 +1,47 @@
+/// <reference path="../libs/jasmine.d.ts" />
+
+import DeltaStateDecoder = require('scripts/app/util/DeltaStateDecoder');
+
+describe("DeltaStateDecoder.merge", () =>
+{
+    it("merges objects recursively and replaces other values", () =>
+    {
+        var base = {a: 1, o: {x: 1, y: [1, 2]}, z: null};
+
+        expect(DeltaStateDecoder.merge(base, {o: {y: [3]}, z: {q: 1}}))
+            .toEqual({a: 1, o: {x: 1, y: [3]}, z: {q: 1}});
+
+        // The base is unchanged
+        expect(base).toEqual({a: 1, o: {x: 1, y: [1, 2]}, z: null});
+    });
+});
+
+describe("DeltaStateDecoder", () =>
+{
+    it("acknowledges each keyframe once, and applies deltas against it", () =>
+    {
+        var acks: number[] = [];
+        var decoder = new DeltaStateDecoder(id => acks.push(id));
+
+        expect(decoder.decode({keyframe: 5, state: {a: 1, b: 2}})).toEqual({a: 1, b: 2});
+        expect(decoder.decode({keyframe: 5, state: {a: 1, b: 2}})).toEqual({a: 1, b: 2});
+        expect(acks).toEqual([5]);
+
+        expect(decoder.decode({base: 5, delta: {b: 3}})).toEqual({a: 1, b: 3});
+        expect(decoder.decode({base: 5, delta: {a: 4}})).toEqual({a: 4, b: 2});
+    });
+
+    it("skips deltas against unknown keyframes", () =>
+    {
+        var decoder = new DeltaStateDecoder(id => {});
+
+        expect(decoder.decode({base: 1, delta: {a: 1}})).toBeUndefined();
+    });
+
+    it("passes complete states through", () =>
+    {
+        var decoder = new DeltaStateDecoder(id => {});
+
+        expect(decoder.decode({a: 1})).toEqual({a: 1});
+    });
+});